@@ -13,6 +13,7 @@
 #include <boost/fusion/include/for_each.hpp>
 #include <fstream>
 #include "util/common.hpp"
+#include "util/io_profiler.hpp"
 #include <boost/mpl/range_c.hpp>
 #include "util/for_each_ref_host.hpp"
 #include "csv_multiarray.hpp"
@@ -247,6 +248,8 @@ public:
 	 */
 	bool write(std::string file, v_pos & v , v_prp & prp, size_t offset=0)
 	{
+		io_prof_scope p_encode("csv_encode");
+
 		// Header for csv (colums name)
 		std::string csv_header;
 		// Data point
@@ -259,20 +262,7 @@ public:
 		point_data = get_csv_data(v,prp,offset);
 
 		// write the file
-		std::ofstream ofs(file);
-
-		// Check if the file is open
-		if (ofs.is_open() == false)
-		{std::cerr << "Error " << __FILE__ << ":" << __LINE__ << " cannot create the CSV file: " << file << std::endl;}
-
-		ofs << csv_header << point_data;
-
-		// Close the file
-
-		ofs.close();
-
-		// Completed succefully
-		return true;
+		return io_prof_write_file(file,p_encode,"csv_flush",{csv_header,point_data});
 	}
 };
 
@@ -0,0 +1,856 @@
+/*
+ * GraphMLReader.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef OPENFPM_IO_SRC_GRAPHMLREADER_GRAPHMLREADER_HPP_
+#define OPENFPM_IO_SRC_GRAPHMLREADER_GRAPHMLREADER_HPP_
+
+#include "Graph/map_graph.hpp"
+#include "GraphMLWriter/GraphMLWriter.hpp"
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <thread>
+#include <charconv>
+#include <algorithm>
+#include <unordered_map>
+#include <type_traits>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include "util/common.hpp"
+
+/*! \brief Convert a string into a property value
+ *
+ * Unsupported property types (for example arrays) are left untouched
+ *
+ * \tparam T type of the property
+ * \tparam is_num true if T is a number
+ *
+ */
+template<typename T, bool is_num = std::is_arithmetic<T>::value>
+struct graph_reader_value
+{
+	/*! \brief Parse the value
+	 *
+	 * \param v property
+	 * \param s string
+	 *
+	 */
+	static inline void parse(T & v, std::string_view s)
+	{}
+};
+
+//! Numbers are parsed with from_chars
+template<typename T>
+struct graph_reader_value<T,true>
+{
+	/*! \brief Parse the value
+	 *
+	 * \param v property
+	 * \param s string
+	 *
+	 */
+	static inline void parse(T & v, std::string_view s)
+	{
+		const char * b = s.data();
+		const char * e = s.data() + s.size();
+
+		while (b != e && (*b == ' ' || *b == '\t' || *b == '+'))	{b++;}
+
+		std::from_chars(b,e,v);
+	}
+};
+
+//! Boolean (true/false or a number)
+template<>
+struct graph_reader_value<bool,true>
+{
+	/*! \brief Parse the value
+	 *
+	 * \param v property
+	 * \param s string
+	 *
+	 */
+	static inline void parse(bool & v, std::string_view s)
+	{
+		if (s == "true" || s == "True" || s == "TRUE")
+		{v = true;}
+		else if (s == "false" || s == "False" || s == "FALSE")
+		{v = false;}
+		else
+		{
+			long int i = 0;
+			std::from_chars(s.data(),s.data() + s.size(),i);
+			v = (i != 0);
+		}
+	}
+};
+
+//! String (XML entities are replaced)
+template<>
+struct graph_reader_value<std::string,false>
+{
+	/*! \brief Parse the value
+	 *
+	 * \param v property
+	 * \param s string
+	 *
+	 */
+	static inline void parse(std::string & v, std::string_view s)
+	{
+		v.clear();
+
+		for (size_t i = 0 ; i < s.size() ; i++)
+		{
+			if (s[i] == '&')
+			{
+				if (s.compare(i,4,"&lt;") == 0)	{v += '<'; i += 3; continue;}
+				if (s.compare(i,4,"&gt;") == 0)	{v += '>'; i += 3; continue;}
+				if (s.compare(i,5,"&amp;") == 0)	{v += '&'; i += 4; continue;}
+				if (s.compare(i,6,"&quot;") == 0)	{v += '"'; i += 5; continue;}
+				if (s.compare(i,6,"&apos;") == 0)	{v += '\''; i += 5; continue;}
+			}
+
+			v += s[i];
+		}
+	}
+};
+
+/*! \brief this class is a functor for "for_each" algorithm
+ *
+ * It set the property prp (runtime index) of a vertex/edge parsing a string
+ *
+ * \tparam T vertex or edge type
+ * \tparam Obj vertex/edge object (for example encapc<...>)
+ *
+ */
+template<typename T, typename Obj>
+struct graph_reader_set_prop
+{
+	//! vertex/edge
+	Obj & obj;
+
+	//! property to set
+	int prp;
+
+	//! value
+	std::string_view val;
+
+	/*! \brief Constructor
+	 *
+	 * \param obj vertex/edge
+	 * \param prp property to set
+	 * \param val value
+	 *
+	 */
+	graph_reader_set_prop(Obj & obj, int prp, std::string_view val)
+	:obj(obj),prp(prp),val(val)
+	{}
+
+	//! It set the property if it is prp
+	template<typename Tv> void operator()(Tv& t) const
+	{
+		typedef typename boost::mpl::at<typename T::type,boost::mpl::int_<Tv::value>>::type ptype;
+
+		if (Tv::value == prp)
+		{graph_reader_value<ptype>::parse(obj.template get<Tv::value>(),val);}
+	}
+};
+
+/*! \brief Return the property of T with name name (-1 if it does not exist)
+ *
+ * Properties names are the attributes names or attrN if T does not define them (like the writers)
+ *
+ * \tparam T vertex or edge type
+ *
+ * \param name name
+ *
+ * \return the property id
+ *
+ */
+template<typename T> int graph_reader_prop_id(std::string_view name)
+{
+	std::string names[T::max_prop];
+
+	create_prop<T>(names);
+
+	for (size_t i = 0 ; i < T::max_prop ; i++)
+	{
+		if (names[i] == name)
+		{return i;}
+	}
+
+	return -1;
+}
+
+/*! \brief Set the property prp of a vertex/edge parsing a string
+ *
+ * \tparam T vertex or edge type
+ *
+ * \param obj vertex/edge
+ * \param prp property
+ * \param val value
+ *
+ */
+template<typename T, typename Obj> inline void graph_reader_set(Obj && obj, int prp, std::string_view val)
+{
+	if (prp < 0)
+	{return;}
+
+	graph_reader_set_prop<T,typename std::remove_reference<Obj>::type> sp(obj,prp,val);
+	boost::mpl::for_each_ref< boost::mpl::range_c<int,0,T::max_prop> >(sp);
+}
+
+/*! \brief Run f(t) on n_thr threads
+ *
+ * \param n_thr number of threads
+ * \param f function
+ *
+ */
+template<typename F> void graph_reader_parallel(size_t n_thr, F f)
+{
+	std::vector<std::thread> th;
+
+	for (size_t t = 1 ; t < n_thr ; t++)
+	{th.emplace_back(f,t);}
+
+	f(0);
+
+	for (size_t t = 0 ; t < th.size() ; t++)
+	{th[t].join();}
+}
+
+/*! \brief It read a graph from a GraphML file or from an edge list (CSV) file
+ *
+ * The file is memory mapped, split between the threads at record boundaries and parsed
+ * with from_chars. Vertex and edge properties are matched to the properties of the
+ * vertex/edge type by attribute name. The graph is filled in the file order, so the output
+ * of GraphMLWriter is read back with the same vertex and edge ids
+ *
+ * \tparam Graph graph type (Graph_CSR)
+ *
+ */
+template<typename Graph>
+class GraphMLReader
+{
+	//! a GraphML node or edge
+	struct gml_record
+	{
+		//! node id or edge source
+		std::string_view id;
+
+		//! edge target
+		std::string_view trg;
+
+		//! body of the element (where the data are)
+		std::string_view body;
+	};
+
+	//! number of threads
+	size_t n_thr;
+
+	//! file data
+	std::string_view buf;
+
+	/*! \brief Find the next start tag <name (followed by a space, > or /)
+	 *
+	 * \param pos from where to search
+	 * \param name tag name
+	 *
+	 * \return the position of < or npos
+	 *
+	 */
+	size_t find_tag(size_t pos, std::string_view name) const
+	{
+		while ((pos = buf.find(name,pos)) != std::string_view::npos)
+		{
+			size_t e = pos + name.size();
+
+			if (e < buf.size() && (buf[e] == ' ' || buf[e] == '>' || buf[e] == '/' || buf[e] == '\n' || buf[e] == '\t'))
+			{return pos;}
+
+			pos = e;
+		}
+
+		return std::string_view::npos;
+	}
+
+	/*! \brief Get the value of an attribute in a tag
+	 *
+	 * \param tag the tag
+	 * \param name attribute with leading space and =" (example: " id=\"")
+	 *
+	 * \return the value
+	 *
+	 */
+	static std::string_view get_attr(std::string_view tag, std::string_view name)
+	{
+		size_t p = tag.find(name);
+
+		if (p == std::string_view::npos)
+		{return std::string_view();}
+
+		p += name.size();
+		size_t e = tag.find('"',p);
+
+		return tag.substr(p,e - p);
+	}
+
+	/*! \brief Parse a non negative integer id, the whole string must be the number
+	 *
+	 * \param f string
+	 * \param id parsed id
+	 *
+	 * \return true if f is a valid id
+	 *
+	 */
+	static bool parse_id(std::string_view f, size_t & id)
+	{
+		auto res = std::from_chars(f.data(),f.data()+f.size(),id);
+
+		return f.size() != 0 && res.ec == std::errc() && res.ptr == f.data()+f.size();
+	}
+
+	/*! \brief Split the buffer between the threads at the start of a node or an edge
+	 *
+	 * \param start first byte to split
+	 * \param bnd boundaries (n_thr + 1)
+	 *
+	 */
+	void split_graphml(size_t start, std::vector<size_t> & bnd) const
+	{
+		bnd.resize(n_thr+1);
+		bnd[0] = start;
+		bnd[n_thr] = buf.size();
+
+		for (size_t t = 1 ; t < n_thr ; t++)
+		{
+			size_t p = std::max(start + (buf.size() - start) / n_thr * t,bnd[t-1]);
+
+			size_t pn = find_tag(p,"<node");
+			size_t pe = find_tag(p,"<edge");
+
+			bnd[t] = std::min(std::min(pn,pe),buf.size());
+		}
+	}
+
+	/*! \brief Split the buffer between the threads at the start of a line
+	 *
+	 * \param start first byte to split
+	 * \param bnd boundaries (n_thr + 1)
+	 *
+	 */
+	void split_lines(size_t start, std::vector<size_t> & bnd) const
+	{
+		bnd.resize(n_thr+1);
+		bnd[0] = start;
+		bnd[n_thr] = buf.size();
+
+		for (size_t t = 1 ; t < n_thr ; t++)
+		{
+			size_t p = std::max(start + (buf.size() - start) / n_thr * t,bnd[t-1]);
+
+			p = buf.find('\n',p);
+			bnd[t] = (p == std::string_view::npos)?buf.size():p+1;
+		}
+	}
+
+	/*! \brief Collect the nodes and the edges that start in [b,e)
+	 *
+	 * The next <node and <edge are cached, only the one that has been consumed is searched
+	 * again, so the range is scanned once
+	 *
+	 * \param b start
+	 * \param e stop
+	 * \param nodes nodes found
+	 * \param edges edges found
+	 *
+	 */
+	void scan_graphml(size_t b, size_t e, std::vector<gml_record> & nodes, std::vector<gml_record> & edges) const
+	{
+		size_t pos = b;
+
+		size_t pn = find_tag(pos,"<node");
+		size_t pe = find_tag(pos,"<edge");
+
+		while (pos < e)
+		{
+			if (pn < pos)
+			{pn = find_tag(pos,"<node");}
+
+			if (pe < pos)
+			{pe = find_tag(pos,"<edge");}
+
+			size_t p = std::min(pn,pe);
+
+			if (p >= e)
+			{break;}
+
+			bool is_node = (p == pn);
+
+			size_t te = buf.find('>',p);
+			if (te == std::string_view::npos)
+			{break;}
+
+			std::string_view tag = buf.substr(p,te - p);
+			gml_record r;
+
+			if (buf[te-1] == '/')
+			{
+				// empty element
+				pos = te + 1;
+			}
+			else
+			{
+				size_t ce = buf.find((is_node)?"</node>":"</edge>",te);
+				if (ce == std::string_view::npos)
+				{ce = buf.size();}
+
+				r.body = buf.substr(te+1,ce - te - 1);
+				pos = ce;
+			}
+
+			if (is_node)
+			{
+				r.id = get_attr(tag," id=\"");
+				nodes.push_back(r);
+			}
+			else
+			{
+				r.id = get_attr(tag," source=\"");
+				r.trg = get_attr(tag," target=\"");
+				edges.push_back(r);
+			}
+		}
+	}
+
+	/*! \brief Parse the keys of the GraphML file
+	 *
+	 * \param end where the keys end
+	 * \param v_key filled with key id -> vertex property
+	 * \param e_key filled with key id -> edge property
+	 *
+	 */
+	void read_keys(size_t end, std::unordered_map<std::string_view,int> & v_key, std::unordered_map<std::string_view,int> & e_key) const
+	{
+		size_t pos = 0;
+
+		while ((pos = find_tag(pos,"<key")) < end)
+		{
+			size_t te = buf.find('>',pos);
+			std::string_view tag = buf.substr(pos,te - pos);
+
+			std::string_view id = get_attr(tag," id=\"");
+			std::string_view fr = get_attr(tag," for=\"");
+			std::string_view name = get_attr(tag," attr.name=\"");
+
+			if (fr == "node")
+			{v_key[id] = graph_reader_prop_id<typename Graph::V_type>(name);}
+			else if (fr == "edge")
+			{e_key[id] = graph_reader_prop_id<typename Graph::E_type>(name);}
+			else if (fr == "all")
+			{
+				v_key[id] = graph_reader_prop_id<typename Graph::V_type>(name);
+				e_key[id] = graph_reader_prop_id<typename Graph::E_type>(name);
+			}
+
+			pos = te;
+		}
+	}
+
+	/*! \brief Parse the data of a node or an edge
+	 *
+	 * \tparam T vertex or edge type
+	 *
+	 * \param obj vertex/edge
+	 * \param body body of the element
+	 * \param keys key id -> property
+	 *
+	 */
+	template<typename T, typename Obj> static void read_data(Obj && obj, std::string_view body, const std::unordered_map<std::string_view,int> & keys)
+	{
+		size_t pos = 0;
+
+		while ((pos = body.find("<data",pos)) != std::string_view::npos)
+		{
+			size_t te = body.find('>',pos);
+			if (te == std::string_view::npos)
+			{break;}
+
+			auto k = keys.find(get_attr(body.substr(pos,te - pos)," key=\""));
+
+			if (body[te-1] == '/')
+			{
+				pos = te;
+				continue;
+			}
+
+			size_t ce = body.find("</data>",te);
+			if (ce == std::string_view::npos)
+			{break;}
+
+			if (k != keys.end())
+			{graph_reader_set<T>(obj,k->second,body.substr(te+1,ce - te - 1));}
+
+			pos = ce;
+		}
+	}
+
+	/*! \brief Map the file
+	 *
+	 * \param mf mapped file
+	 * \param file file to map
+	 *
+	 * \return true if the file has been mapped
+	 *
+	 */
+	bool map(boost::iostreams::mapped_file_source & mf, const std::string & file)
+	{
+		try
+		{
+			mf.open(file);
+		}
+		catch (std::exception & e)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error cannot open the file: " << file << "\n";
+			return false;
+		}
+
+		buf = (mf.size() == 0)?std::string_view():std::string_view(mf.data(),mf.size());
+
+		return true;
+	}
+
+public:
+
+	/*! \brief Constructor
+	 *
+	 * \param n_thr number of threads [default = all the hardware threads]
+	 *
+	 */
+	GraphMLReader(size_t n_thr = std::thread::hardware_concurrency())
+	:n_thr(std::max(n_thr,(size_t)1))
+	{}
+
+	/*! \brief Read a GraphML file and add its nodes and edges to g
+	 *
+	 * Node ids can be any string, edges are added in the file order. If an edge refer to a
+	 * node that does not exist the edge is reported and g is not modified
+	 *
+	 * \param file GraphML file
+	 * \param g graph to fill
+	 *
+	 * \return true if the file has been read
+	 *
+	 */
+	bool read(const std::string & file, Graph & g)
+	{
+		boost::iostreams::mapped_file_source mf;
+
+		if (map(mf,file) == false)
+		{return false;}
+
+		size_t start = std::min(find_tag(0,"<node"),find_tag(0,"<edge"));
+		start = std::min(start,buf.size());
+
+		std::unordered_map<std::string_view,int> v_key;
+		std::unordered_map<std::string_view,int> e_key;
+
+		read_keys(start,v_key,e_key);
+
+		// Find the nodes and the edges
+
+		std::vector<size_t> bnd;
+		split_graphml(start,bnd);
+
+		std::vector<std::vector<gml_record>> nodes(n_thr);
+		std::vector<std::vector<gml_record>> edges(n_thr);
+
+		graph_reader_parallel(n_thr,[&](size_t t)
+		{
+			scan_graphml(bnd[t],bnd[t+1],nodes[t],edges[t]);
+		});
+
+		std::vector<size_t> v_off(n_thr+1,0);
+		std::vector<size_t> e_off(n_thr+1,0);
+
+		for (size_t t = 0 ; t < n_thr ; t++)
+		{
+			v_off[t+1] = v_off[t] + nodes[t].size();
+			e_off[t+1] = e_off[t] + edges[t].size();
+		}
+
+		// node id -> vertex, in case the ids are n0 n1 n2 ... the map is not needed
+
+		size_t v_base = g.getNVertex();
+		bool dense = true;
+
+		for (size_t t = 0 ; t < n_thr && dense == true ; t++)
+		{
+			for (size_t i = 0 ; i < nodes[t].size() ; i++)
+			{
+				std::string_view id = nodes[t][i].id;
+				size_t n = 0;
+
+				if (id.size() < 2 || id[0] != 'n' || parse_id(id.substr(1),n) == false || n != v_off[t] + i)
+				{dense = false; break;}
+			}
+		}
+
+		std::unordered_map<std::string_view,size_t> id_map;
+
+		if (dense == false)
+		{
+			id_map.reserve(v_off[n_thr]);
+
+			for (size_t t = 0 ; t < n_thr ; t++)
+			{
+				for (size_t i = 0 ; i < nodes[t].size() ; i++)
+				{id_map[nodes[t][i].id] = v_off[t] + i;}
+			}
+		}
+
+		auto vid = [&](std::string_view id) -> size_t
+		{
+			size_t n = (size_t)-1;
+
+			if (dense == true)
+			{
+				if (id.size() < 2 || id[0] != 'n' || parse_id(id.substr(1),n) == false)
+				{n = (size_t)-1;}
+			}
+			else
+			{
+				auto f = id_map.find(id);
+				if (f != id_map.end())
+				{n = f->second;}
+			}
+
+			return n;
+		};
+
+		// Resolve the edges in parallel, all of them are checked before g is modified
+
+		std::vector<std::pair<size_t,size_t>> st(e_off[n_thr]);
+
+		graph_reader_parallel(n_thr,[&](size_t t)
+		{
+			for (size_t i = 0 ; i < edges[t].size() ; i++)
+			{st[e_off[t] + i] = std::pair<size_t,size_t>(vid(edges[t][i].id),vid(edges[t][i].trg));}
+		});
+
+		for (size_t i = 0 ; i < st.size() ; i++)
+		{
+			if (st[i].first >= v_off[n_thr] || st[i].second >= v_off[n_thr])
+			{
+				std::cerr << __FILE__ << ":" << __LINE__ << " Error the edge " << i << " refer to a node that does not exist\n";
+				return false;
+			}
+		}
+
+		// Add the vertices and set the properties in parallel
+
+		for (size_t i = 0 ; i < v_off[n_thr] ; i++)
+		{g.addVertex();}
+
+		graph_reader_parallel(n_thr,[&](size_t t)
+		{
+			for (size_t i = 0 ; i < nodes[t].size() ; i++)
+			{read_data<typename Graph::V_type>(g.vertex(v_base + v_off[t] + i),nodes[t][i].body,v_key);}
+		});
+
+		// Add the edges in order
+
+		size_t e_base = g.getNEdge();
+
+		for (size_t i = 0 ; i < st.size() ; i++)
+		{g.addEdge(v_base + st[i].first,v_base + st[i].second);}
+
+		graph_reader_parallel(n_thr,[&](size_t t)
+		{
+			for (size_t i = 0 ; i < edges[t].size() ; i++)
+			{read_data<typename Graph::E_type>(g.edge(e_base + e_off[t] + i),edges[t][i].body,e_key);}
+		});
+
+		return true;
+	}
+
+	/*! \brief Read an edge list and add its edges to g
+	 *
+	 * Every line is "source target [properties ...]" separated by comma (CSV) or by spaces,
+	 * lines starting with # or % are comments. If the first line is a header (the first field
+	 * is not a number) the columns after source and target are matched to the edge properties
+	 * by name, otherwise they fill the edge properties in order. The vertices are 0 ... max id.
+	 * If a source or a target is not a non negative integer the line is reported and g is not
+	 * modified
+	 *
+	 * \param file edge list file
+	 * \param g graph to fill
+	 *
+	 * \return true if the file has been read
+	 *
+	 */
+	bool read_edge_list(const std::string & file, Graph & g)
+	{
+		boost::iostreams::mapped_file_source mf;
+
+		if (map(mf,file) == false)
+		{return false;}
+
+		// skip comments
+
+		size_t start = 0;
+
+		while (start < buf.size() && (buf[start] == '#' || buf[start] == '%' || buf[start] == '\n' || buf[start] == '\r'))
+		{
+			size_t nl = buf.find('\n',start);
+			start = (nl == std::string_view::npos)?buf.size():nl+1;
+		}
+
+		size_t nl = std::min(buf.find('\n',start),buf.size());
+		std::string_view first = buf.substr(start,nl - start);
+
+		char sep = (first.find(',') != std::string_view::npos)?',':' ';
+
+		auto next_field = [sep](std::string_view line, size_t & pos) -> std::string_view
+		{
+			while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t' || line[pos] == '\r'))	{pos++;}
+
+			size_t b = pos;
+
+			while (pos < line.size() && line[pos] != sep && line[pos] != '\r' && (sep == ',' || line[pos] != '\t'))	{pos++;}
+
+			std::string_view f = line.substr(b,pos - b);
+
+			while (f.size() != 0 && (f.back() == ' ' || f.back() == '\t'))	{f.remove_suffix(1);}
+
+			if (pos < line.size())	{pos++;}
+
+			return f;
+		};
+
+		// columns -> edge properties
+
+		std::vector<int> col;
+		size_t pos = 0;
+		std::string_view f0 = next_field(first,pos);
+
+		if (f0.size() != 0 && (f0[0] < '0' || f0[0] > '9'))
+		{
+			next_field(first,pos);
+
+			while (pos < first.size())
+			{col.push_back(graph_reader_prop_id<typename Graph::E_type>(next_field(first,pos)));}
+
+			start = (nl == buf.size())?nl:nl+1;
+		}
+		else
+		{
+			for (size_t i = 0 ; i < Graph::E_type::max_prop ; i++)
+			{col.push_back(i);}
+		}
+
+		// parse the lines in parallel
+
+		std::vector<size_t> bnd;
+		split_lines(start,bnd);
+
+		std::vector<std::vector<std::pair<size_t,size_t>>> st(n_thr);
+		std::vector<std::vector<std::string_view>> lines(n_thr);
+		std::vector<size_t> max_id(n_thr,0);
+		bool has_prop = (std::count_if(col.begin(),col.end(),[](int c){return c >= 0;}) != 0);
+
+		// first line (byte offset) with an invalid source or target for each thread
+
+		std::vector<size_t> bad(n_thr,std::string_view::npos);
+
+		graph_reader_parallel(n_thr,[&](size_t t)
+		{
+			size_t p = bnd[t];
+
+			while (p < bnd[t+1])
+			{
+				size_t e = std::min(buf.find('\n',p),bnd[t+1]);
+				std::string_view line = buf.substr(p,e - p);
+				p = e + 1;
+
+				if (line.size() == 0 || line[0] == '#' || line[0] == '%' || line[0] == '\r')
+				{continue;}
+
+				size_t lp = 0;
+				std::string_view s = next_field(line,lp);
+				std::string_view d = next_field(line,lp);
+
+				// blank line
+
+				if (s.size() == 0 && d.size() == 0)
+				{continue;}
+
+				size_t src = 0;
+				size_t trg = 0;
+
+				if (parse_id(s,src) == false || parse_id(d,trg) == false)
+				{
+					bad[t] = line.data() - buf.data();
+					break;
+				}
+
+				st[t].push_back(std::pair<size_t,size_t>(src,trg));
+				max_id[t] = std::max(max_id[t],std::max(src,trg) + 1);
+
+				if (has_prop == true)
+				{lines[t].push_back(line.substr(lp));}
+			}
+		});
+
+		size_t first_bad = *std::min_element(bad.begin(),bad.end());
+
+		if (first_bad != std::string_view::npos)
+		{
+			size_t line = std::count(buf.begin(),buf.begin() + first_bad,'\n') + 1;
+
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error " << file << ":" << line << " the source and the target must be non negative integers\n";
+			return false;
+		}
+
+		size_t n_vtx = *std::max_element(max_id.begin(),max_id.end());
+		size_t v_base = g.getNVertex();
+		size_t e_base = g.getNEdge();
+
+		for (size_t i = 0 ; i < n_vtx ; i++)
+		{g.addVertex();}
+
+		std::vector<size_t> e_off(n_thr+1,0);
+
+		for (size_t t = 0 ; t < n_thr ; t++)
+		{
+			e_off[t+1] = e_off[t] + st[t].size();
+
+			for (size_t i = 0 ; i < st[t].size() ; i++)
+			{g.addEdge(v_base + st[t][i].first,v_base + st[t][i].second);}
+		}
+
+		if (has_prop == false)
+		{return true;}
+
+		graph_reader_parallel(n_thr,[&](size_t t)
+		{
+			for (size_t i = 0 ; i < lines[t].size() ; i++)
+			{
+				size_t lp = 0;
+
+				for (size_t c = 0 ; c < col.size() && lp < lines[t][i].size() ; c++)
+				{
+					std::string_view v = next_field(lines[t][i],lp);
+					graph_reader_set<typename Graph::E_type>(g.edge(e_base + e_off[t] + i),col[c],v);
+				}
+			}
+		});
+
+		return true;
+	}
+};
+
+#endif /* OPENFPM_IO_SRC_GRAPHMLREADER_GRAPHMLREADER_HPP_ */
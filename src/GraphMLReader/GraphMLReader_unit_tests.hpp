@@ -0,0 +1,255 @@
+/*
+ * GraphMLReader_unit_tests.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef OPENFPM_IO_SRC_GRAPHMLREADER_GRAPHMLREADER_UNIT_TESTS_HPP_
+#define OPENFPM_IO_SRC_GRAPHMLREADER_GRAPHMLREADER_UNIT_TESTS_HPP_
+
+#include "GraphMLReader.hpp"
+#include "GraphMLWriter/GraphMLWriter.hpp"
+#include <fstream>
+
+BOOST_AUTO_TEST_SUITE( graphml_reader_test )
+
+/*! \brief Test node and edge
+ *
+ */
+struct ne_rd
+{
+	//! The node contain several properties
+	typedef boost::fusion::vector<float,double,long int,int,bool,std::string> type;
+
+	//! The data
+	type data;
+
+	//! x property id in boost::fusion::vector
+	static const unsigned int x = 0;
+	//! weight property id in boost::fusion::vector
+	static const unsigned int weight = 1;
+	//! long_num property id in boost::fusion::vector
+	static const unsigned int long_num = 2;
+	//! integer property id in boost::fusion::vector
+	static const unsigned int integer = 3;
+	//! flag property id in boost::fusion::vector
+	static const unsigned int flag = 4;
+	//! string property id in boost::fusion::vector
+	static const unsigned int string = 5;
+	//! total number of properties boost::fusion::vector
+	static const unsigned int max_prop = 6;
+
+	//! define attributes names
+	struct attributes
+	{
+		static const std::string name[max_prop];
+	};
+
+	static inline bool noPointers()
+	{
+		return true;
+	}
+
+	//! type of the spatial information
+	typedef float s_type;
+};
+
+// Initialize the attributes strings array
+const std::string ne_rd::attributes::name[] = {"x","weight","long_num","integer","flag","string"};
+
+BOOST_AUTO_TEST_CASE( graphml_reader_use)
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessUnitID() != 0)
+		return;
+
+	Graph_CSR<ne_rd,ne_rd> g;
+
+	for (size_t i = 0 ; i < 100 ; i++)
+	{
+		ne_rd n;
+		boost::fusion::at_c<ne_rd::x>(n.data) = 0.5f*i;
+		boost::fusion::at_c<ne_rd::weight>(n.data) = 0.1*i;
+		boost::fusion::at_c<ne_rd::long_num>(n.data) = -(long int)i;
+		boost::fusion::at_c<ne_rd::integer>(n.data) = i;
+		boost::fusion::at_c<ne_rd::flag>(n.data) = i % 2;
+		boost::fusion::at_c<ne_rd::string>(n.data) = "v<" + std::to_string(i) + ">";
+
+		g.addVertex(n);
+	}
+
+	for (size_t i = 0 ; i < 100 ; i++)
+	{
+		ne_rd n;
+		boost::fusion::at_c<ne_rd::x>(n.data) = 0.0;
+		boost::fusion::at_c<ne_rd::weight>(n.data) = 1.0 / (i+1);
+		boost::fusion::at_c<ne_rd::long_num>(n.data) = 0;
+		boost::fusion::at_c<ne_rd::integer>(n.data) = 0;
+		boost::fusion::at_c<ne_rd::flag>(n.data) = false;
+		boost::fusion::at_c<ne_rd::string>(n.data) = "e" + std::to_string(i);
+
+		g.addEdge(i,(i*7+1)%100,n);
+	}
+
+	GraphMLWriter<Graph_CSR<ne_rd,ne_rd>> gw(g);
+	gw.write_stream("test_graph_read.graphml");
+
+	// read it back with 3 threads
+
+	Graph_CSR<ne_rd,ne_rd> g2;
+
+	GraphMLReader<Graph_CSR<ne_rd,ne_rd>> gr(3);
+	bool ret = gr.read("test_graph_read.graphml",g2);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	BOOST_REQUIRE_EQUAL(g2.getNVertex(),g.getNVertex());
+	BOOST_REQUIRE_EQUAL(g2.getNEdge(),g.getNEdge());
+
+	for (size_t i = 0 ; i < g.getNVertex() ; i++)
+	{
+		BOOST_REQUIRE_EQUAL(g2.vertex(i).template get<ne_rd::x>(),g.vertex(i).template get<ne_rd::x>());
+		BOOST_REQUIRE_EQUAL(g2.vertex(i).template get<ne_rd::weight>(),g.vertex(i).template get<ne_rd::weight>());
+		BOOST_REQUIRE_EQUAL(g2.vertex(i).template get<ne_rd::long_num>(),g.vertex(i).template get<ne_rd::long_num>());
+		BOOST_REQUIRE_EQUAL(g2.vertex(i).template get<ne_rd::integer>(),g.vertex(i).template get<ne_rd::integer>());
+		BOOST_REQUIRE_EQUAL(g2.vertex(i).template get<ne_rd::flag>(),g.vertex(i).template get<ne_rd::flag>());
+		BOOST_REQUIRE_EQUAL(g2.vertex(i).template get<ne_rd::string>(),g.vertex(i).template get<ne_rd::string>());
+	}
+
+	auto it = g.getEdgeIterator();
+	auto it2 = g2.getEdgeIterator();
+
+	while (it.isNext())
+	{
+		BOOST_REQUIRE_EQUAL(it2.isNext(),true);
+		BOOST_REQUIRE_EQUAL(it2.source(),it.source());
+		BOOST_REQUIRE_EQUAL(it2.target(),it.target());
+		BOOST_REQUIRE_EQUAL(g2.edge(it2.get()).template get<ne_rd::weight>(),g.edge(it.get()).template get<ne_rd::weight>());
+		BOOST_REQUIRE_EQUAL(g2.edge(it2.get()).template get<ne_rd::string>(),g.edge(it.get()).template get<ne_rd::string>());
+
+		++it;
+		++it2;
+	}
+}
+
+BOOST_AUTO_TEST_CASE( graphml_reader_dangling_edge)
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessUnitID() != 0)
+		return;
+
+	GraphMLReader<Graph_CSR<ne_rd,ne_rd>> gr(2);
+
+	// the node n1x is not the node 1, the edge to n1 is dangling
+
+	std::ofstream ofs("test_graph_read_dangling.graphml");
+
+	ofs << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	       "<graphml xmlns=\"http://graphml.graphdrawing.org/xmlns\">\n"
+	       "<graph id=\"G\" edgedefault=\"undirected\">\n"
+	       "<node id=\"n0\"/>\n<node id=\"n1x\"/>\n"
+	       "<edge id=\"e0\" source=\"n0\" target=\"n1x\"/>\n"
+	       "<edge id=\"e1\" source=\"n0\" target=\"n1\"/>\n"
+	       "</graph>\n</graphml>\n";
+	ofs.close();
+
+	Graph_CSR<ne_rd,ne_rd> g;
+
+	bool ret = gr.read("test_graph_read_dangling.graphml",g);
+	BOOST_REQUIRE_EQUAL(ret,false);
+	BOOST_REQUIRE_EQUAL(g.getNVertex(),0ul);
+	BOOST_REQUIRE_EQUAL(g.getNEdge(),0ul);
+
+	// without the dangling edge the graph is read
+
+	std::ofstream ofs2("test_graph_read_dangling.graphml");
+
+	ofs2 << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	        "<graphml xmlns=\"http://graphml.graphdrawing.org/xmlns\">\n"
+	        "<graph id=\"G\" edgedefault=\"undirected\">\n"
+	        "<node id=\"n0\"/>\n<node id=\"n1x\"/>\n"
+	        "<edge id=\"e0\" source=\"n1x\" target=\"n0\"/>\n"
+	        "</graph>\n</graphml>\n";
+	ofs2.close();
+
+	ret = gr.read("test_graph_read_dangling.graphml",g);
+	BOOST_REQUIRE_EQUAL(ret,true);
+	BOOST_REQUIRE_EQUAL(g.getNVertex(),2ul);
+	BOOST_REQUIRE_EQUAL(g.getNEdge(),1ul);
+	BOOST_REQUIRE_EQUAL(g.getChild(1,0),0ul);
+}
+
+BOOST_AUTO_TEST_CASE( graphml_reader_edge_list_use)
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessUnitID() != 0)
+		return;
+
+	std::ofstream ofs("test_graph_read.csv");
+
+	ofs << "# edge list\n";
+	ofs << "source,target,integer,weight,unknown\n";
+
+	for (size_t i = 0 ; i < 50 ; i++)
+	{ofs << i << "," << (i+3)%60 << "," << i*2 << "," << 0.25*i << ",7\n";}
+
+	ofs.close();
+
+	Graph_CSR<ne_rd,ne_rd> g;
+
+	GraphMLReader<Graph_CSR<ne_rd,ne_rd>> gr(4);
+	bool ret = gr.read_edge_list("test_graph_read.csv",g);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	BOOST_REQUIRE_EQUAL(g.getNVertex(),53ul);
+	BOOST_REQUIRE_EQUAL(g.getNEdge(),50ul);
+
+	auto it = g.getEdgeIterator();
+
+	while (it.isNext())
+	{
+		size_t s = it.source();
+
+		BOOST_REQUIRE_EQUAL(it.target(),(s+3)%60);
+		BOOST_REQUIRE_EQUAL(g.edge(it.get()).template get<ne_rd::integer>(),(int)(2*s));
+		BOOST_REQUIRE_EQUAL(g.edge(it.get()).template get<ne_rd::weight>(),0.25*s);
+
+		++it;
+	}
+
+	// space separated without header
+
+	std::ofstream ofs2("test_graph_read.txt");
+
+	ofs2 << "0 1 1.5\n1 2 2.5\n2 0 3.5";
+	ofs2.close();
+
+	Graph_CSR<ne_rd,ne_rd> g2;
+
+	ret = gr.read_edge_list("test_graph_read.txt",g2);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	BOOST_REQUIRE_EQUAL(g2.getNVertex(),3ul);
+	BOOST_REQUIRE_EQUAL(g2.getNEdge(),3ul);
+	BOOST_REQUIRE_EQUAL(g2.edge(0).template get<ne_rd::x>(),1.5f);
+
+	// invalid target on the third line, the graph is not modified
+
+	std::ofstream ofs3("test_graph_read_bad.txt");
+
+	ofs3 << "0 1\n1 2\n2 x3\n3 0\n";
+	ofs3.close();
+
+	Graph_CSR<ne_rd,ne_rd> g3;
+
+	ret = gr.read_edge_list("test_graph_read_bad.txt",g3);
+	BOOST_REQUIRE_EQUAL(ret,false);
+	BOOST_REQUIRE_EQUAL(g3.getNVertex(),0ul);
+	BOOST_REQUIRE_EQUAL(g3.getNEdge(),0ul);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif /* OPENFPM_IO_SRC_GRAPHMLREADER_GRAPHMLREADER_UNIT_TESTS_HPP_ */
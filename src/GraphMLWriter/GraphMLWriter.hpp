@@ -4,6 +4,11 @@
 #include "Graph/map_graph.hpp"
 #include <iostream>
 #include <fstream>
+#include <charconv>
+#include <vector>
+#include <cstring>
+#include <climits>
+#include <algorithm>
 #include "util/common.hpp"
 
 
@@ -533,6 +538,376 @@ struct edge_node
     }
 };
 
+/*! \brief GraphML type name of a property type T (empty if the type is not supported)
+ *
+ * \tparam T property type
+ *
+ */
+template<typename T>
+struct graphml_type
+{
+	//! \brief return the GraphML type name
+	static const char * name() {return "";}
+};
+
+//! float property
+template<> struct graphml_type<float> {static const char * name() {return "float";}};
+//! double property
+template<> struct graphml_type<double> {static const char * name() {return "double";}};
+//! int property
+template<> struct graphml_type<int> {static const char * name() {return "int";}};
+//! long int property
+template<> struct graphml_type<long int> {static const char * name() {return "long";}};
+//! unsigned int property (GraphML has no unsigned types)
+template<> struct graphml_type<unsigned int> {static const char * name() {return "long";}};
+//! unsigned long int (size_t) property (values bigger than LONG_MAX cannot be read as long)
+template<> struct graphml_type<unsigned long int> {static const char * name() {return "long";}};
+//! bool property
+template<> struct graphml_type<bool> {static const char * name() {return "boolean";}};
+//! string property
+template<> struct graphml_type<std::string> {static const char * name() {return "string";}};
+
+/*! \brief Fixed size output buffer for the streaming GraphML writer
+ *
+ * Numbers are formatted with to_chars directly into the buffer, when the buffer is full
+ * it is flushed into the file
+ *
+ */
+class graphml_stream_buffer
+{
+	//! file where to flush
+	std::ofstream & ofs;
+
+	//! buffer
+	std::vector<char> buf;
+
+	//! position in the buffer
+	size_t pos;
+
+	//! true if a value bigger than LONG_MAX has been written
+	bool long_overflow;
+
+	/*! \brief Be sure that there is space for n chars (flush if needed)
+	 *
+	 * \param n number of chars
+	 *
+	 */
+	inline void ensure(size_t n)
+	{
+		if (pos + n > buf.size())
+		{flush();}
+	}
+
+public:
+
+	/*! \brief Constructor
+	 *
+	 * \param ofs file where to flush
+	 * \param size size of the buffer
+	 *
+	 */
+	graphml_stream_buffer(std::ofstream & ofs, size_t size)
+	:ofs(ofs),buf(std::max(size,(size_t)128)),pos(0),long_overflow(false)
+	{}
+
+	//! flush when destroyed
+	~graphml_stream_buffer()
+	{
+		flush();
+	}
+
+	//! write the buffer content into the file
+	void flush()
+	{
+		ofs.write(&buf[0],pos);
+		pos = 0;
+	}
+
+	/*! \brief Add n chars
+	 *
+	 * \param str chars to add
+	 * \param n number of chars
+	 *
+	 */
+	inline void put(const char * str, size_t n)
+	{
+		if (n > buf.size())
+		{
+			flush();
+			ofs.write(str,n);
+			return;
+		}
+
+		ensure(n);
+		memcpy(&buf[pos],str,n);
+		pos += n;
+	}
+
+	/*! \brief Add a string literal
+	 *
+	 * \param str string to add
+	 *
+	 */
+	template<size_t N> inline void put(const char (&str)[N])
+	{
+		put(str,N-1);
+	}
+
+	/*! \brief Add a string
+	 *
+	 * \param str string to add
+	 *
+	 */
+	inline void put(const std::string & str)
+	{
+		put(str.c_str(),str.size());
+	}
+
+	/*! \brief Add a number
+	 *
+	 * \param v number
+	 *
+	 */
+	template<typename T> inline void put_num(T v)
+	{
+		// enough for any integer and the shortest round-trip representation of a double
+		ensure(32);
+
+		auto res = std::to_chars(&buf[pos],&buf[pos] + 32,v);
+		pos = res.ptr - &buf[0];
+	}
+
+	/*! \brief Add a property value
+	 *
+	 * \param v value
+	 *
+	 */
+	inline void put_value(float v) {put_num(v);}
+	//! \brief Add a property value \param v value
+	inline void put_value(double v) {put_num(v);}
+	//! \brief Add a property value \param v value
+	inline void put_value(int v) {put_num(v);}
+	//! \brief Add a property value \param v value
+	inline void put_value(long int v) {put_num(v);}
+	//! \brief Add a property value \param v value
+	inline void put_value(unsigned int v) {put_num(v);}
+
+	/*! \brief Add an unsigned long property value
+	 *
+	 * The key is declared long, a value bigger than LONG_MAX is written anyway but a
+	 * long parser reject it, so it is reported (once)
+	 *
+	 * \param v value
+	 *
+	 */
+	inline void put_value(unsigned long int v)
+	{
+		if (v > (unsigned long int)LONG_MAX && long_overflow == false)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Warning: the value " << v << " does not fit the GraphML long type, readers can reject it" << std::endl;
+			long_overflow = true;
+		}
+
+		put_num(v);
+	}
+
+	/*! \brief Add a boolean property value (true or false)
+	 *
+	 * \param v value
+	 *
+	 */
+	inline void put_value(bool v)
+	{
+		if (v == true)
+		{put("true");}
+		else
+		{put("false");}
+	}
+
+	/*! \brief Add a string property value (XML escaped)
+	 *
+	 * \param v value
+	 *
+	 */
+	inline void put_value(const std::string & v)
+	{
+		size_t last = 0;
+
+		for (size_t i = 0 ; i < v.size() ; i++)
+		{
+			const char * esc = NULL;
+
+			if (v[i] == '&') {esc = "&amp;";}
+			else if (v[i] == '<') {esc = "&lt;";}
+			else if (v[i] == '>') {esc = "&gt;";}
+
+			if (esc != NULL)
+			{
+				put(v.c_str() + last,i - last);
+				put(esc,strlen(esc));
+				last = i+1;
+			}
+		}
+
+		put(v.c_str() + last,v.size() - last);
+	}
+
+	//! \brief Unsupported property types are not written
+	template<typename T> inline void put_value(const T & v) {}
+};
+
+/*! \brief Component i of a property (the property itself if it is not an array)
+ *
+ * \param v property
+ * \param i component
+ *
+ * \return the component
+ *
+ */
+template<typename T> inline const T & graphml_component(const T & v, size_t i)
+{
+	return v;
+}
+
+/*! \brief Component i of an array property
+ *
+ * \param v property
+ * \param i component
+ *
+ * \return the component
+ *
+ */
+template<typename T, size_t N> inline const T & graphml_component(const T (&v)[N], size_t i)
+{
+	return v[i];
+}
+
+/*! \brief this class is a functor for "for_each" algorithm
+ *
+ * For each property of T it create the key definition and precompute the
+ * prefix "  <data key=..>" used for every node/edge. Array properties are flattened
+ * in one key for each component (name_0, name_1 ...), the properties that GraphML
+ * cannot represent are skipped with a warning
+ *
+ * \tparam T vertex or edge type
+ *
+ */
+template<typename T>
+struct graphml_stream_key
+{
+	//! key definitions
+	std::string & keys;
+
+	//! data prefix for each component of each property (empty if not written)
+	std::vector<std::string> * prefix;
+
+	//! properties names
+	std::string * names;
+
+	//! key id prefix (vk or ek)
+	const char * kp;
+
+	//! node or edge
+	const char * fr;
+
+	/*! \brief Constructor
+	 *
+	 * \param keys string filled with the key definitions
+	 * \param prefix data prefix for each component of each property
+	 * \param names properties names
+	 * \param kp key id prefix
+	 * \param fr node or edge
+	 *
+	 */
+	graphml_stream_key(std::string & keys, std::vector<std::string> * prefix, std::string * names, const char * kp, const char * fr)
+	:keys(keys),prefix(prefix),names(names),kp(kp),fr(fr)
+	{}
+
+	/*! \brief Add a key
+	 *
+	 * \param id key id
+	 * \param name attribute name
+	 * \param type attribute type
+	 * \param pf where to add the data prefix
+	 *
+	 */
+	void add_key(const std::string & id, const std::string & name, const std::string & type, std::vector<std::string> & pf)
+	{
+		keys += "<key id=\"" + id + "\" for=\"" + fr + "\" attr.name=\"" + name + "\" attr.type=\"" + type + "\"/>\n";
+		pf.push_back("  <data key=\"" + id + "\">");
+	}
+
+	//! It create the key of the property
+	template<typename Tv> void operator()(Tv& t)
+	{
+		typedef typename boost::mpl::at<typename T::type,boost::mpl::int_<Tv::value>>::type ptype;
+		typedef typename std::remove_all_extents<ptype>::type base_type;
+
+		std::string type = graphml_type<base_type>::name();
+
+		if (type.size() == 0 || std::rank<ptype>::value > 1)
+		{
+			std::cerr << "Warning: GraphMLWriter the " << fr << " property " << names[Tv::value] << " has a type that cannot be written in GraphML, it is skipped\n";
+			return;
+		}
+
+		std::string id = kp + std::to_string(Tv::value);
+
+		if (std::rank<ptype>::value == 0)
+		{
+			add_key(id,names[Tv::value],type,prefix[Tv::value]);
+			return;
+		}
+
+		for (size_t i = 0 ; i < std::extent<ptype>::value ; i++)
+		{add_key(id + "_" + std::to_string(i),names[Tv::value] + "_" + std::to_string(i),type,prefix[Tv::value]);}
+	}
+};
+
+/*! \brief this class is a functor for "for_each" algorithm
+ *
+ * For each property of a node/edge it write the data into the stream buffer
+ *
+ * \tparam Obj node/edge object (for example encapc<...>)
+ *
+ */
+template<typename Obj>
+struct graphml_stream_data
+{
+	//! stream buffer
+	graphml_stream_buffer & out;
+
+	//! node/edge
+	const Obj & obj;
+
+	//! data prefix for each component of each property
+	const std::vector<std::string> * prefix;
+
+	/*! \brief Constructor
+	 *
+	 * \param out stream buffer
+	 * \param obj node/edge
+	 * \param prefix data prefix for each component of each property
+	 *
+	 */
+	graphml_stream_data(graphml_stream_buffer & out, const Obj & obj, const std::vector<std::string> * prefix)
+	:out(out),obj(obj),prefix(prefix)
+	{}
+
+	//! It write the property T
+	template<typename T> void operator()(T& t) const
+	{
+		const std::vector<std::string> & pf = prefix[T::value];
+
+		for (size_t i = 0 ; i < pf.size() ; i++)
+		{
+			out.put(pf[i]);
+			out.put_value(graphml_component(obj.template get<T::value>(),i));
+			out.put("</data>\n");
+		}
+	}
+};
+
 /*!
  *
  * From a Graphbasic structure it write a GraphML format file
@@ -759,6 +1134,124 @@ public:
 		// Completed succefully
 		return true;
 	}
+
+	/*! \brief It write a GraphML file from a graph streaming the output
+	 *
+	 * Nodes and edges are formatted directly into a fixed size buffer that is flushed into
+	 * the file when full, so the memory used does not depend on the size of the graph. Numbers
+	 * are written with to_chars (shortest representation that read back to the same value) and
+	 * the "<data key=..>" prefixes are computed once. Differently from write(), a key is defined
+	 * for every written property (x,y,z included), so the file can be read by NetworkX and Gephi.
+	 * Unsigned integers are written as long (up to LONG_MAX), booleans as true/false, arrays are
+	 * written with one key for each component
+	 *
+	 * \param file path where to write
+	 * \param graph_name name of the graph
+	 * \param buf_size size of the output buffer in byte [default = 1MB]
+	 *
+	 * \return true if the file has been written (false also if the data cannot be flushed, for example on a full disk)
+	 *
+	 */
+	bool write_stream(std::string file, std::string graph_name="Graph", size_t buf_size = 1048576)
+	{
+		std::string v_names[Graph::V_type::max_prop];
+		std::string e_names[Graph::E_type::max_prop];
+		std::vector<std::string> v_prefix[Graph::V_type::max_prop];
+		std::vector<std::string> e_prefix[Graph::E_type::max_prop];
+		std::string keys;
+
+		create_prop<typename Graph::V_type>(v_names);
+		create_prop<typename Graph::E_type>(e_names);
+
+		graphml_stream_key<typename Graph::V_type> vk(keys,v_prefix,v_names,"vk","node");
+		boost::mpl::for_each_ref< boost::mpl::range_c<int,0,Graph::V_type::max_prop> >(vk);
+
+		graphml_stream_key<typename Graph::E_type> ek(keys,e_prefix,e_names,"ek","edge");
+		boost::mpl::for_each_ref< boost::mpl::range_c<int,0,Graph::E_type::max_prop> >(ek);
+
+		std::ofstream ofs(file);
+
+		// Check if the file is open
+		if (ofs.is_open() == false)
+		{
+			std::cerr << "Error cannot creare the graphML file: " + file + "\n";
+			return false;
+		}
+
+		{
+		graphml_stream_buffer out(ofs,buf_size);
+
+		out.put("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+				"<graphml xmlns=\"http://graphml.graphdrawing.org/xmlns\"\n"
+				"    xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\"\n"
+				"    xsi:schemaLocation=\"http://graphml.graphdrawing.org/xmlns\n"
+				"     http://graphml.graphdrawing.org/xmlns/1.0/graphml.xsd\">\n");
+		out.put(keys);
+		out.put("<graph id=\"" + graph_name + "\" edgedefault=\"undirected\">\n");
+
+		// nodes
+
+		size_t nc = 0;
+		auto it = g.getVertexIterator();
+
+		while (it.isNext())
+		{
+			auto v = g.vertex(it.get());
+
+			out.put("<node id=\"n");
+			out.put_num(nc);
+			out.put("\">\n");
+
+			graphml_stream_data<decltype(v)> vd(out,v,v_prefix);
+			boost::mpl::for_each_ref< boost::mpl::range_c<int,0,Graph::V_type::max_prop> >(vd);
+
+			out.put("</node>\n");
+
+			++it;
+			nc++;
+		}
+
+		// edges
+
+		nc = 0;
+		auto it_e = g.getEdgeIterator();
+
+		while (it_e.isNext())
+		{
+			auto e = g.edge(it_e.get());
+
+			out.put("<edge id=\"e");
+			out.put_num(nc);
+			out.put("\" source=\"n");
+			out.put_num((size_t)it_e.source());
+			out.put("\" target=\"n");
+			out.put_num((size_t)it_e.target());
+			out.put("\">\n");
+
+			graphml_stream_data<decltype(e)> ed(out,e,e_prefix);
+			boost::mpl::for_each_ref< boost::mpl::range_c<int,0,Graph::E_type::max_prop> >(ed);
+
+			out.put("</edge>\n");
+
+			++it_e;
+			nc++;
+		}
+
+		out.put("</graph>\n</graphml>\n");
+		}
+
+		ofs.close();
+
+		// the data are flushed at the end, check that they are in the file
+
+		if (ofs.good() == false)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error writing the graphML file: " << file << std::endl;
+			return false;
+		}
+
+		return true;
+	}
 };
 
 #endif
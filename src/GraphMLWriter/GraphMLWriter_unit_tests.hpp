@@ -155,6 +155,154 @@ BOOST_AUTO_TEST_CASE( graphml_writer_use)
 	BOOST_REQUIRE_EQUAL(true,test);
 }
 
+BOOST_AUTO_TEST_CASE( graphml_writer_stream_use)
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessUnitID() != 0)
+		return;
+
+	Graph_CSR<ne_cp,ne_cp> g_csr2;
+
+	struct ne_cp n1;
+	n1.get_x() = 1.0;
+	n1.get_y() = 2.5;
+	n1.get_z() = 3.0;
+	n1.get_dn() = 0.1;
+	n1.get_ln() = 5;
+	n1.get_i() = -6;
+
+	for (size_t i = 0 ; i < 64 ; i++)
+	{
+		n1.get_str() = std::string("test<") + std::to_string(i) + ">";
+		g_csr2.addVertex(n1);
+	}
+
+	for (size_t i = 0 ; i < 64 ; i++)
+	{
+		n1.get_str() = std::string("edge") + std::to_string(i);
+		g_csr2.addEdge(i,(i+1)%64,n1);
+	}
+
+	GraphMLWriter<Graph_CSR<ne_cp,ne_cp>> gv2(g_csr2);
+
+	// small buffer, it is flushed many times
+
+	bool ret = gv2.write_stream("test_graph_stream_small.graphml","Graph",128);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	ret = gv2.write_stream("test_graph_stream.graphml");
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	bool test = compare("test_graph_stream_small.graphml","test_graph_stream.graphml");
+	BOOST_REQUIRE_EQUAL(true,test);
+
+	std::ifstream ifs("test_graph_stream.graphml");
+	std::stringstream ss;
+	ss << ifs.rdbuf();
+	std::string out = ss.str();
+
+	BOOST_REQUIRE(out.find("<key id=\"vk0\" for=\"node\" attr.name=\"x\" attr.type=\"float\"/>\n") != std::string::npos);
+	BOOST_REQUIRE(out.find("<key id=\"ek6\" for=\"edge\" attr.name=\"string\" attr.type=\"string\"/>\n") != std::string::npos);
+	BOOST_REQUIRE(out.find("<node id=\"n63\">\n  <data key=\"vk0\">1</data>\n  <data key=\"vk1\">2.5</data>\n  <data key=\"vk2\">3</data>\n"
+			               "  <data key=\"vk3\">0.1</data>\n  <data key=\"vk4\">5</data>\n  <data key=\"vk5\">-6</data>\n"
+			               "  <data key=\"vk6\">test&lt;63&gt;</data>\n</node>\n") != std::string::npos);
+	BOOST_REQUIRE(out.find("<edge id=\"e63\" source=\"n63\" target=\"n0\">\n") != std::string::npos);
+	BOOST_REQUIRE(out.find("  <data key=\"ek6\">edge63</data>\n</edge>\n</graph>\n</graphml>\n") != std::string::npos);
+}
+
+/*!
+ *
+ * Node with properties that GraphML does not have natively (unsigned and arrays)
+ *
+ */
+
+struct ne_types
+{
+	//! The node contain several properties
+	typedef boost::fusion::vector<size_t,unsigned int,float[3],double[2][2],bool> type;
+
+	//! The data
+	type data;
+
+	//! id property id in boost::fusion::vector
+	static const unsigned int id = 0;
+	//! flag property id in boost::fusion::vector
+	static const unsigned int flag = 1;
+	//! pos property id in boost::fusion::vector
+	static const unsigned int pos = 2;
+	//! mat property id in boost::fusion::vector
+	static const unsigned int mat = 3;
+	//! on property id in boost::fusion::vector
+	static const unsigned int on = 4;
+	//! total number of properties boost::fusion::vector
+	static const unsigned int max_prop = 5;
+
+	//! define attributes names
+	struct attributes
+	{
+		static const std::string name[max_prop];
+	};
+
+	static inline bool noPointers()
+	{
+		return true;
+	}
+};
+
+// Initialize the attributes strings array
+const std::string ne_types::attributes::name[] = {"id","flag","pos","mat","on"};
+
+BOOST_AUTO_TEST_CASE( graphml_writer_stream_types)
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessUnitID() != 0)
+		return;
+
+	Graph_CSR<ne_types,ne_types> g_csr;
+
+	for (size_t i = 0 ; i < 2 ; i++)
+	{
+		g_csr.addVertex();
+		g_csr.vertex(i).template get<ne_types::id>() = 10000000000ul + i;
+		g_csr.vertex(i).template get<ne_types::flag>() = 3*i;
+		g_csr.vertex(i).template get<ne_types::on>() = (i == 1);
+
+		for (size_t k = 0 ; k < 3 ; k++)
+		{g_csr.vertex(i).template get<ne_types::pos>()[k] = i + 0.5*k;}
+	}
+
+	g_csr.addEdge(0,1);
+
+	GraphMLWriter<Graph_CSR<ne_types,ne_types>> gw(g_csr);
+
+	bool ret = gw.write_stream("test_graph_stream_types.graphml");
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	std::ifstream ifs("test_graph_stream_types.graphml");
+	std::stringstream ss;
+	ss << ifs.rdbuf();
+	std::string out = ss.str();
+
+	// unsigned are written as long, the array is flattened, the 2D array is skipped, bool is true/false
+
+	BOOST_REQUIRE(out.find("<key id=\"vk0\" for=\"node\" attr.name=\"id\" attr.type=\"long\"/>\n") != std::string::npos);
+	BOOST_REQUIRE(out.find("<key id=\"vk1\" for=\"node\" attr.name=\"flag\" attr.type=\"long\"/>\n") != std::string::npos);
+	BOOST_REQUIRE(out.find("<key id=\"vk2_2\" for=\"node\" attr.name=\"pos_2\" attr.type=\"float\"/>\n") != std::string::npos);
+	BOOST_REQUIRE(out.find("attr.name=\"mat") == std::string::npos);
+	BOOST_REQUIRE(out.find("<node id=\"n1\">\n  <data key=\"vk0\">10000000001</data>\n  <data key=\"vk1\">3</data>\n"
+			               "  <data key=\"vk2_0\">1</data>\n  <data key=\"vk2_1\">1.5</data>\n  <data key=\"vk2_2\">2</data>\n"
+			               "  <data key=\"vk4\">true</data>\n</node>\n") != std::string::npos);
+	BOOST_REQUIRE(out.find("<key id=\"vk4\" for=\"node\" attr.name=\"on\" attr.type=\"boolean\"/>\n") != std::string::npos);
+	BOOST_REQUIRE(out.find("<data key=\"vk4\">false</data>") != std::string::npos);
+
+	// the data that cannot be flushed (full disk) are reported
+
+	ret = gw.write_stream("/dev/full");
+	BOOST_REQUIRE_EQUAL(ret,false);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 
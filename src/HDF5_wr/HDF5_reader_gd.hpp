@@ -12,15 +12,197 @@
 #include "Packer_Unpacker/Pack_selector.hpp"
 #include "Packer_Unpacker/Packer.hpp"
 #include "Packer_Unpacker/Unpacker.hpp"
+#include "Grid/map_grid.hpp"
 #include "util/GBoxes.hpp"
+#include "HDF5_util.hpp"
+
+/*! \brief this class is a functor for "for_each" algorithm
+ *
+ * For each property of the grid it read the domain of the local grids from the global
+ * dataset grid_prp_N (HDF5_writer<GRID_DIST>::save_global)
+ *
+ * \tparam device_grid type of the local grids
+ *
+ */
+template<typename device_grid>
+struct h5_gd_read_prop
+{
+	//! local grids
+	openfpm::vector<device_grid> & loc_grid;
+
+	//! boxes of the local grids
+	const openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext;
+
+	//! HDF5 file
+	hid_t file;
+
+	//! transfer property list
+	hid_t plist_id;
+
+	//! size of the global grid
+	const hsize_t * gsz;
+
+	//! number of collective reads (maximum number of local grids across the processors)
+	size_t n_read;
+
+	//! bytes read by this processor
+	size_t bytes = 0;
+
+	//! false if a property is not in the file or does not match
+	bool ret = true;
+
+	/*! \brief constructor
+	 *
+	 * \param loc_grid local grids
+	 * \param gdb_ext boxes of the local grids
+	 * \param file HDF5 file
+	 * \param plist_id transfer property list
+	 * \param gsz size of the global grid
+	 * \param n_read number of collective reads
+	 *
+	 */
+	h5_gd_read_prop(openfpm::vector<device_grid> & loc_grid, const openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext,
+			        hid_t file, hid_t plist_id, const hsize_t * gsz, size_t n_read)
+	:loc_grid(loc_grid),gdb_ext(gdb_ext),file(file),plist_id(plist_id),gsz(gsz),n_read(n_read)
+	{}
+
+	//! It read the property
+	template<typename T> void operator()(T& t)
+	{
+		typedef typename boost::mpl::at<typename device_grid::value_type::type,boost::mpl::int_<T::value>>::type ptype;
+
+		const unsigned int dim = device_grid::dims;
+		const unsigned int prp_rank = h5_array_dims<ptype>::rank;
+
+		if (h5_prop_rows<ptype>::is_valid == false)
+		{return;}
+
+		std::string name = "grid_prp_" + std::to_string(T::value);
+
+		hsize_t prp_dims[H5S_MAX_RANK];
+		h5_array_dims<ptype>::get(prp_dims);
+
+		// the file is the same for all the processors, so they skip the same properties
+
+		if (H5Lexists(file, name.c_str(), H5P_DEFAULT) <= 0)
+		{
+			ret = false;
+			return;
+		}
+
+		hid_t dataset = H5Dopen (file, name.c_str(), H5P_DEFAULT);
+		hid_t tp = h5_type<typename std::remove_all_extents<ptype>::type>::create();
+
+		hid_t ftype = H5Dget_type(dataset);
+		bool match = (H5Tget_size(ftype) == H5Tget_size(tp));
+		H5Tclose(ftype);
+
+		hid_t fspace = H5Dget_space(dataset);
+		hsize_t fdim[H5S_MAX_RANK];
+		int rank = H5Sget_simple_extent_dims(fspace,fdim,NULL);
+		H5Sclose(fspace);
+
+		match &= (rank == (int)(dim + prp_rank));
+
+		for (size_t i = 0 ; match == true && i < dim ; i++)
+		{match &= (fdim[i] == gsz[dim-1-i]);}
+
+		for (size_t i = 0 ; match == true && i < prp_rank ; i++)
+		{match &= (fdim[dim+i] == prp_dims[i]);}
+
+		if (match == false)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error: the dataset " << name << " does not match the property " << T::value << std::endl;
+			H5Tclose(tp);
+			H5Dclose(dataset);
+			ret = false;
+			return;
+		}
+
+		// every processor do n_read collective reads, the ones past its local grids are empty
+
+		for (size_t k = 0 ; k < n_read ; k++)
+		{
+			hsize_t low[dim];
+			hsize_t sz[dim];
+			size_t n = 0;
+
+			if (k < loc_grid.size())
+			{n = h5_grid_domain(gdb_ext.get(k),dim,low,sz);}
+			else
+			{
+				for (size_t d = 0 ; d < dim ; d++)
+				{low[d] = 0; sz[d] = 0;}
+			}
+
+			std::vector<char> buf(n*sizeof(ptype));
+
+			hid_t mem_dataspace_id;
+			hid_t file_dataspace_id = h5_grid_box_dataspace(dim,gsz,low,sz,prp_rank,prp_dims,mem_dataspace_id);
+
+			herr_t err = H5Dread(dataset, tp, mem_dataspace_id, file_dataspace_id, plist_id, buf.data());
+
+			H5Sclose(mem_dataspace_id);
+			H5Sclose(file_dataspace_id);
+
+			ret &= (err >= 0);
+
+			if (n == 0 || err < 0)
+			{continue;}
+
+			// copy the domain, x is the fastest index
+
+			grid_key_dx<dim> start;
+			grid_key_dx<dim> stop;
+
+			for (size_t d = 0 ; d < dim ; d++)
+			{
+				start.set_d(d,gdb_ext.get(k).Dbox.getLow(d));
+				stop.set_d(d,gdb_ext.get(k).Dbox.getHigh(d));
+			}
+
+			auto it = loc_grid.get(k).getSubIterator(start,stop);
+
+			for (size_t i = 0 ; it.isNext() ; ++it, i++)
+			{memcpy(&loc_grid.get(k).template get<T::value>(it.get()),&buf[i*sizeof(ptype)],sizeof(ptype));}
+
+			bytes += buf.size();
+		}
+
+		H5Tclose(tp);
+		H5Dclose(dataset);
+	}
+};
 
 template <>
 class HDF5_reader<GRID_DIST>
 {
+	//! maximum number of bytes read by a single H5Dread
+	size_t max_io = HDF5_MAX_IO_BYTES;
+
+	//! tuning of the file access
+	h5_io_options opt;
+
+	/*! \brief Read and unpack a block saved by an old processor
+	 *
+	 * Every processor do n_chunk collective reads, the reads past the end of the block are empty
+	 *
+	 * \param bid block (-1 or a block not in the file for an empty read)
+	 * \param mpi_size_old number of blocks in the file
+	 * \param metadata_out bytes of every block
+	 * \param metadata_accum offset of every block
+	 * \param n_chunk number of collective reads
+	 * \param plist_id collective transfer property list
+	 * \param dataset_2 dataset grid_dist
+	 * \param loc_grid_old local grids loaded (appended)
+	 * \param gdb_ext_old boxes of the local grids loaded (appended)
+	 *
+	 */
 	template<typename device_grid> void load_block(long int bid,
 			        hssize_t mpi_size_old,
 					long int * metadata_out,
 					openfpm::vector<size_t> & metadata_accum,
+					size_t n_chunk,
 					hid_t plist_id,
 					hid_t dataset_2,
 					openfpm::vector<device_grid> & loc_grid_old,
@@ -40,49 +222,16 @@ class HDF5_reader<GRID_DIST>
 			block[0] = 0;
 		}
 
-	    hsize_t count[1] = {1};
-
 		// allocate the memory
 		HeapMemory pmem;
 		//pmem.allocate(req);
 		ExtPreAlloc<HeapMemory> & mem = *(new ExtPreAlloc<HeapMemory>(block[0],pmem));
 		mem.incRef();
 
-		//Select file dataspace
-		hid_t file_dataspace_id_2 = H5Dget_space(dataset_2);
-
-	    size_t to_read = block[0];
-	    size_t coffset = 0;
-
-	    auto & v_cl = create_vcluster();
-
-	    int read_test = (to_read != 0);
-	    v_cl.max(read_test);
-	    v_cl.execute();
-
-	    while (read_test)
-	    {
-			hsize_t block_c[1];
-			block_c[0] = std::min((size_t)(to_read),(size_t)0x7FFFFFFF);
-
-			hsize_t offset_c[1] = {offset[0] + coffset};
-			H5Sselect_hyperslab(file_dataspace_id_2, H5S_SELECT_SET, offset_c, NULL, count, block_c);
-
-			hsize_t mdim_2[1] = {block_c[0]};
-
-			//Create data space in memory
-			hid_t mem_dataspace_id_2 = H5Screate_simple(1, mdim_2, NULL);
-
-			// Read the dataset.
-			H5Dread(dataset_2, H5T_NATIVE_CHAR, mem_dataspace_id_2, file_dataspace_id_2, plist_id, (char *)mem.getPointer() + coffset);
-
-			coffset += std::min((size_t)(to_read),(size_t)0x7FFFFFFF);
-			to_read -= std::min((size_t)(to_read),(size_t)0x7FFFFFFF);
-
-			read_test = (to_read != 0);
-			v_cl.max(read_test);
-			v_cl.execute();
-	    }
+		// We read in chunk of max_io (2GB) maximum
+		io_prof_scope p_read("hdf5_read");
+		h5_read_bytes(dataset_2,offset[0],block[0],n_chunk,(char *)mem.getPointer(),plist_id,max_io);
+		p_read.stop(block[0]);
 
 		mem.allocate(pmem.size());
 
@@ -91,9 +240,13 @@ class HDF5_reader<GRID_DIST>
 		openfpm::vector<device_grid> loc_grid_old_unp;
 		openfpm::vector<GBoxes<device_grid::dims>> gdb_ext_old_unp;
 
+		io_prof_scope p_unpack("hdf5_unpack");
+
 		Unpacker<typename std::remove_reference<decltype(loc_grid_old)>::type,HeapMemory>::unpack(mem,loc_grid_old_unp,ps,1);
 		Unpacker<typename std::remove_reference<decltype(gdb_ext_old)>::type,HeapMemory>::unpack(mem,gdb_ext_old_unp,ps,1);
 
+		p_unpack.stop(block[0]);
+
 		for (size_t i = 0; i < loc_grid_old_unp.size(); i++)
 		{
 			loc_grid_old.add();
@@ -108,33 +261,36 @@ class HDF5_reader<GRID_DIST>
 
 	}
 
-public:
-
-	template<typename device_grid> inline void load(const std::string & filename,
+	/*! \brief Load the blocks of a file assigned to this processor
+	 *
+	 * \param filename file
+	 * \param loc_grid_old local grids loaded (appended)
+	 * \param gdb_ext_old boxes of the local grids loaded (appended)
+	 * \param blocks blocks loaded by this processor
+	 * \param first index in loc_grid_old of the first grid of every loaded block
+	 *
+	 * \return the number of blocks in the file
+	 *
+	 */
+	template<typename device_grid> inline size_t load_file(const std::string & filename,
 													openfpm::vector<device_grid> & loc_grid_old,
-													openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext_old)
+													openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext_old,
+													openfpm::vector<size_t> & blocks,
+													openfpm::vector<size_t> & first)
 	{
 		Vcluster<> & v_cl = create_vcluster();
 
-		MPI_Comm comm = v_cl.getMPIComm();
-		MPI_Info info  = MPI_INFO_NULL;
-
 		int mpi_rank = v_cl.getProcessUnitID();
 		//int mpi_size = v_cl.getProcessingUnits();
 
-		// Set up file access property list with parallel I/O access
-		hid_t plist_id = H5Pcreate(H5P_FILE_ACCESS);
-		H5Pset_fapl_mpio(plist_id, comm, info);
-
 		//Open a file
-	    hid_t file = H5Fopen (filename.c_str(), H5F_ACC_RDONLY, plist_id);
-	    H5Pclose(plist_id);
+	    hid_t file = h5_open_checkpoint(filename,v_cl.getMPIComm(),opt);
 
 	    //Open dataset
 	    hid_t dataset = H5Dopen (file, "metadata", H5P_DEFAULT);
 
 	    //Create property list for collective dataset read
-	  	plist_id = H5Pcreate(H5P_DATASET_XFER);
+	  	hid_t plist_id = H5Pcreate(H5P_DATASET_XFER);
 	  	H5Pset_dxpl_mpio(plist_id, H5FD_MPIO_COLLECTIVE);
 
 		//Select file dataspace
@@ -215,19 +371,38 @@ public:
 
 	  	stop_block = start_block + n_block.get(v_cl.getProcessUnitID());
 
+	  	// Number of collective reads of the k-th block of every processor, every processor know
+	  	// the blocks of the others so it is computed without communication
+
+	  	openfpm::vector<size_t> n_chunk;
+	  	n_chunk.resize(std::max(max_block,(size_t)1));
+
+	  	for (size_t k = 0 ; k < n_chunk.size() ; k++)
+	  		n_chunk.get(k) = 0;
+
+	  	for (size_t i = 0, b = 0 ; i < n_block.size() ; i++)
+	  	{
+	  		for (size_t k = 0 ; k < n_block.get(i) ; k++, b++)
+	  			n_chunk.get(k) = std::max(n_chunk.get(k),h5_n_chunks(metadata_out[b],max_io));
+	  	}
+
 //	  	std::cout << "ID: " << v_cl.getProcessUnitID() << "; Start block: " << start_block << "; " << "Stop block: " << stop_block << std::endl;
 
 	  	if (mpi_rank >= mpi_size_old)
-	  		load_block(start_block,mpi_size_old,metadata_out,metadata_accum,plist_id,dataset_2,loc_grid_old,gdb_ext_old);
+	  		load_block(start_block,mpi_size_old,metadata_out,metadata_accum,n_chunk.get(0),plist_id,dataset_2,loc_grid_old,gdb_ext_old);
 	  	else
 	  	{
 	  		size_t n_bl = 0;
 	  		size_t lb = start_block;
 			for ( ; lb < stop_block ; lb++, n_bl++)
-				load_block(lb,mpi_size_old,metadata_out,metadata_accum,plist_id,dataset_2,loc_grid_old,gdb_ext_old);
+			{
+				blocks.add(lb);
+				first.add(loc_grid_old.size());
+				load_block(lb,mpi_size_old,metadata_out,metadata_accum,n_chunk.get(n_bl),plist_id,dataset_2,loc_grid_old,gdb_ext_old);
+			}
 
 			if (n_bl < max_block)
-				load_block(-1,mpi_size_old,metadata_out,metadata_accum,plist_id,dataset_2,loc_grid_old,gdb_ext_old);
+				load_block(-1,mpi_size_old,metadata_out,metadata_accum,n_chunk.get(n_bl),plist_id,dataset_2,loc_grid_old,gdb_ext_old);
 	  	}
 
 	  	////////////////////////////////////
@@ -240,6 +415,425 @@ public:
 	    // Close the file.
 	    H5Fclose(file);
 	    H5Pclose(plist_id);
+
+	    return mpi_size_old;
+	}
+
+	/*! \brief Base checkpoint of a delta checkpoint
+	 *
+	 * \param filename file
+	 * \param base base checkpoint
+	 *
+	 * \return true if the file is a delta checkpoint
+	 *
+	 */
+	bool delta_base(const std::string & filename, std::string & base)
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+	    hid_t file = h5_open_checkpoint(filename,v_cl.getMPIComm(),opt);
+
+	    if (file < 0)	{return false;}
+
+	    bool ret = (H5Lexists(file, "base", H5P_DEFAULT) > 0);
+
+	    if (ret == true)
+	    {
+	    	hid_t dataset = H5Dopen (file, "base", H5P_DEFAULT);
+	    	hid_t space = H5Dget_space(dataset);
+	    	base.resize(H5Sget_select_npoints(space));
+	    	H5Sclose(space);
+
+	    	H5Dread(dataset, H5T_NATIVE_CHAR, H5S_ALL, H5S_ALL, H5P_DEFAULT, &base[0]);
+	    	H5Dclose(dataset);
+	    }
+
+	    H5Fclose(file);
+
+	    return ret;
+	}
+
+	/*! \brief Read a dataset of rows with a variable number of rows for every block
+	 *
+	 * \param file HDF5 file
+	 * \param name dataset name (the number of rows of every block is in name_count)
+	 * \param rows rows
+	 * \param accum first row of every block
+	 *
+	 * \return true if the read succeed
+	 *
+	 */
+	bool load_rows(hid_t file, const std::string & name, openfpm::vector<long long int> & rows, openfpm::vector<size_t> & accum)
+	{
+		std::string names[2] = {name + "_count",name};
+		openfpm::vector<long long int> count;
+		openfpm::vector<long long int> * out[2] = {&count,&rows};
+
+		for (size_t k = 0 ; k < 2 ; k++)
+		{
+			if (H5Lexists(file, names[k].c_str(), H5P_DEFAULT) <= 0)
+			{return false;}
+
+			hid_t dataset = H5Dopen (file, names[k].c_str(), H5P_DEFAULT);
+			hid_t space = H5Dget_space(dataset);
+			out[k]->resize(H5Sget_select_npoints(space));
+			H5Sclose(space);
+
+			herr_t err = (out[k]->size() == 0)?0:H5Dread(dataset, H5T_NATIVE_LLONG, H5S_ALL, H5S_ALL, H5P_DEFAULT, out[k]->getPointer());
+			H5Dclose(dataset);
+
+			if (err < 0)	{return false;}
+		}
+
+		accum.resize(count.size()+1);
+		accum.get(0) = 0;
+
+		for (size_t i = 0 ; i < count.size() ; i++)
+		{accum.get(i+1) = accum.get(i) + count.get(i);}
+
+		return accum.last() == rows.size();
+	}
+
+	/*! \brief Load a delta checkpoint: load the base and overlay the saved grids
+	 *
+	 * The base and the delta are saved by the same processors, so the blocks of the two
+	 * files are distributed in the same way and the overlay is local. The grids are appended
+	 * to loc_grid_old and gdb_ext_old only if the delta match the base on all the processors
+	 *
+	 * \param filename delta checkpoint
+	 * \param base base checkpoint
+	 * \param loc_grid_old local grids loaded
+	 * \param gdb_ext_old boxes of the local grids loaded
+	 *
+	 * \return true if the delta has been applied to the base
+	 *
+	 */
+	template<typename device_grid> inline bool load_delta(const std::string & filename,
+													const std::string & base,
+													openfpm::vector<device_grid> & loc_grid_old,
+													openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext_old)
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+		openfpm::vector<device_grid> loc_grid_b;
+		openfpm::vector<GBoxes<device_grid::dims>> gdb_ext_b;
+		openfpm::vector<size_t> blocks_b;
+		openfpm::vector<size_t> first_b;
+		size_t n_b = load_file(base,loc_grid_b,gdb_ext_b,blocks_b,first_b);
+
+		openfpm::vector<device_grid> loc_grid_d;
+		openfpm::vector<GBoxes<device_grid::dims>> gdb_ext_d;
+		openfpm::vector<size_t> blocks_d;
+		openfpm::vector<size_t> first_d;
+		size_t n_d = load_file(filename,loc_grid_d,gdb_ext_d,blocks_d,first_d);
+
+		// index of the saved grids in the grids of every block
+
+	    hid_t file = h5_open_checkpoint(filename,v_cl.getMPIComm(),opt);
+
+	    openfpm::vector<long long int> delta_index;
+	    openfpm::vector<size_t> delta_accum;
+
+	    bool ret = (file >= 0) && load_rows(file,"delta_index",delta_index,delta_accum);
+
+	    if (file >= 0)
+	    {H5Fclose(file);}
+
+	    ret &= (n_b == n_d && blocks_b.size() == blocks_d.size() && delta_accum.size() == n_d + 1);
+
+	    // check all the saved grids before modifying the base
+
+	    for (size_t k = 0 ; ret == true && k < blocks_d.size() ; k++)
+	    {
+	    	size_t b = blocks_d.get(k);
+	    	size_t n_grid = ((k + 1 < first_b.size())?first_b.get(k+1):loc_grid_b.size()) - first_b.get(k);
+
+	    	for (size_t j = 0 ; j < delta_accum.get(b+1) - delta_accum.get(b) ; j++)
+	    	{
+	    		long long int idx = delta_index.get(delta_accum.get(b) + j);
+
+	    		if (blocks_b.get(k) != b || idx < 0 || (size_t)idx >= n_grid)
+	    		{
+	    			std::cerr << __FILE__ << ":" << __LINE__ << " Error: the grid " << idx << " of the block " << b << " of " << filename << " is not in " << base << std::endl;
+	    			ret = false;
+	    			break;
+	    		}
+	    	}
+	    }
+
+	    // all the processors fail if one fail
+
+	    size_t ok = ret;
+	    v_cl.min(ok);
+	    v_cl.execute();
+
+	    if (ok == 0)
+	    {
+	    	std::cerr << __FILE__ << ":" << __LINE__ << " Error: " << filename << " is not a delta of " << base << std::endl;
+	    	return false;
+	    }
+
+	    for (size_t k = 0 ; k < blocks_d.size() ; k++)
+	    {
+	    	size_t b = blocks_d.get(k);
+
+	    	for (size_t j = 0 ; j < delta_accum.get(b+1) - delta_accum.get(b) ; j++)
+	    	{
+	    		size_t idx = delta_index.get(delta_accum.get(b) + j);
+
+	    		loc_grid_b.get(first_b.get(k) + idx).swap(loc_grid_d.get(first_d.get(k) + j));
+	    		gdb_ext_b.get(first_b.get(k) + idx) = gdb_ext_d.get(first_d.get(k) + j);
+	    	}
+	    }
+
+	    for (size_t i = 0 ; i < loc_grid_b.size() ; i++)
+	    {
+	    	loc_grid_old.add();
+	    	loc_grid_old.last().swap(loc_grid_b.get(i));
+	    	gdb_ext_old.add(gdb_ext_b.get(i));
+	    }
+
+	    return true;
+	}
+
+	/*! \brief Check if the file has the global layout (HDF5_GRID_GLOBAL)
+	 *
+	 * \param filename file
+	 *
+	 * \return true if the file has the global layout
+	 *
+	 */
+	bool global_layout(const std::string & filename)
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+	    hid_t file = h5_open_checkpoint(filename,v_cl.getMPIComm(),opt);
+
+	    if (file < 0)	{return false;}
+
+	    bool ret = (H5Lexists(file, "grid_size", H5P_DEFAULT) > 0);
+
+	    H5Fclose(file);
+
+	    return ret;
+	}
+
+	/*! \brief Read the domain of the local grids from a file with the global layout
+	 *
+	 * \param filename file
+	 * \param loc_grid local grids (already allocated)
+	 * \param gdb_ext boxes of the local grids
+	 *
+	 * \return true if all the properties has been read
+	 *
+	 */
+	template<typename device_grid> bool read_global(const std::string & filename,
+			                                        openfpm::vector<device_grid> & loc_grid,
+													const openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext)
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+		const unsigned int dim = device_grid::dims;
+
+		// every processor must do the same number of collective reads
+
+		size_t n_read = loc_grid.size();
+		v_cl.max(n_read);
+		v_cl.execute();
+
+	    hid_t file = h5_open_checkpoint(filename,v_cl.getMPIComm(),opt);
+	    if (file < 0)	{return false;}
+
+	    long long int gsz_ll[dim];
+	    hsize_t gsz[dim];
+
+	    if (h5_read_1d(file,"grid_size",H5T_NATIVE_LLONG,0,dim,gsz_ll,H5P_DEFAULT) == false)
+	    {
+	    	std::cerr << __FILE__ << ":" << __LINE__ << " Error: " << filename << " does not have a grid of dimension " << dim << std::endl;
+	    	H5Fclose(file);
+	    	return false;
+	    }
+
+	    for (size_t d = 0 ; d < dim ; d++)
+	    {gsz[d] = gsz_ll[d];}
+
+	    //Create property list for collective dataset read
+	  	hid_t plist_id = H5Pcreate(H5P_DATASET_XFER);
+	  	H5Pset_dxpl_mpio(plist_id, H5FD_MPIO_COLLECTIVE);
+
+	  	io_prof_scope p_read("hdf5_read");
+
+	  	h5_gd_read_prop<device_grid> rp(loc_grid,gdb_ext,file,plist_id,gsz,n_read);
+	  	boost::mpl::for_each_ref< boost::mpl::range_c<int,0,device_grid::value_type::max_prop> >(rp);
+
+	  	p_read.stop(rp.bytes);
+
+	  	H5Pclose(plist_id);
+	  	H5Fclose(file);
+
+	  	return rp.ret;
+	}
+
+	/*! \brief Load the local grids saved with the global layout
+	 *
+	 * The domains saved by the old processors are distributed like the blocks of the packed
+	 * layout, every domain become a local grid without ghost
+	 *
+	 * \param filename file
+	 * \param loc_grid_old local grids loaded
+	 * \param gdb_ext_old boxes of the local grids loaded
+	 *
+	 * \return true if all the properties has been read
+	 *
+	 */
+	template<typename device_grid> inline bool load_global_file(const std::string & filename,
+													openfpm::vector<device_grid> & loc_grid_old,
+													openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext_old)
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+		const unsigned int dim = device_grid::dims;
+
+	    hid_t file = h5_open_checkpoint(filename,v_cl.getMPIComm(),opt);
+
+	    openfpm::vector<long long int> box;
+	    openfpm::vector<size_t> box_accum;
+
+	    bool ret = (file >= 0) && load_rows(file,"grid_box",box,box_accum);
+
+	    if (file >= 0)
+	    {H5Fclose(file);}
+
+	    if (ret == false)
+	    {
+	    	std::cerr << __FILE__ << ":" << __LINE__ << " Error: cannot read the boxes of the grids from " << filename << std::endl;
+	    	return false;
+	    }
+
+	  	size_t start_block;
+	  	size_t stop_block;
+
+	  	h5_block_range(box_accum.size() - 1,v_cl.getProcessUnitID(),v_cl.getProcessingUnits(),start_block,stop_block);
+
+	  	for (size_t i = box_accum.get(start_block) ; i + 2*dim < box_accum.get(stop_block) ; i += 2*dim+1)
+	  	{
+	  		GBoxes<dim> gb;
+	  		size_t sz[dim];
+	  		bool empty = false;
+
+	  		for (size_t d = 0 ; d < dim ; d++)
+	  		{
+	  			long int low = box.get(i+d);
+	  			long int high = box.get(i+dim+d);
+
+	  			empty |= (high < low);
+	  			sz[d] = (high < low)?0:high - low + 1;
+
+	  			gb.GDbox.setLow(d,0);
+	  			gb.GDbox.setHigh(d,high - low);
+	  			gb.Dbox.setLow(d,0);
+	  			gb.Dbox.setHigh(d,high - low);
+	  			gb.origin.get(d) = low;
+	  		}
+
+	  		gb.k = box.get(i+2*dim);
+
+	  		if (empty == true)
+	  		{continue;}
+
+	  		device_grid g(sz);
+	  		g.setMemory();
+
+	  		loc_grid_old.add();
+	  		loc_grid_old.last().swap(g);
+	  		gdb_ext_old.add(gb);
+	  	}
+
+	  	return read_global(filename,loc_grid_old,gdb_ext_old);
+	}
+
+public:
+
+	/*! \brief Set the maximum number of bytes read by a single H5Dread
+	 *
+	 * The default is 2GB (the limit of MPI-IO), smaller values are useful only to test
+	 *
+	 * \param max_io maximum number of bytes
+	 *
+	 */
+	void setMaxIOBytes(size_t max_io)
+	{
+		this->max_io = (max_io == 0)?1:std::min(max_io,(size_t)HDF5_MAX_IO_BYTES);
+	}
+
+	/*! \brief Set the MPI-IO hints and the metadata options used to open the file
+	 *
+	 * \param opt tuning of the file access
+	 *
+	 */
+	void setIOOptions(const h5_io_options & opt)
+	{
+		this->opt = opt;
+	}
+
+	/*! \brief Load the local grids
+	 *
+	 * If the file is a delta checkpoint (HDF5_writer<GRID_DIST>::save_delta) the base is
+	 * loaded and the grids saved in the delta replace the ones of the base. If the file has
+	 * the global layout (HDF5_GRID_GLOBAL) the domains of the old local grids are loaded as
+	 * grids without ghost
+	 *
+	 * \param filename file
+	 * \param loc_grid_old local grids loaded
+	 * \param gdb_ext_old boxes of the local grids loaded
+	 *
+	 * \return false if the delta does not match its base or the global layout cannot be read
+	 *
+	 */
+	template<typename device_grid> inline bool load(const std::string & filename,
+													openfpm::vector<device_grid> & loc_grid_old,
+													openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext_old)
+	{
+		std::string base;
+
+		if (delta_base(filename,base) == true)
+		{return load_delta(filename,base,loc_grid_old,gdb_ext_old);}
+
+		if (global_layout(filename) == true)
+		{return load_global_file(filename,loc_grid_old,gdb_ext_old);}
+
+		openfpm::vector<size_t> blocks;
+		openfpm::vector<size_t> first;
+
+		load_file(filename,loc_grid_old,gdb_ext_old,blocks,first);
+
+		return true;
+	}
+
+	/*! \brief Read the local grids of the current decomposition from a file with the global layout
+	 *
+	 * The domain of every local grid (Dbox shifted by origin) is read directly with an hyperslab
+	 * of the global datasets, so the file can be saved by any number of processors with any
+	 * decomposition. The ghost are not read
+	 *
+	 * \param filename file saved with HDF5_GRID_GLOBAL
+	 * \param loc_grid local grids (already allocated)
+	 * \param gdb_ext boxes of the local grids
+	 *
+	 * \return true if all the properties has been read
+	 *
+	 */
+	template<typename device_grid> inline bool load_global(const std::string & filename,
+													openfpm::vector<device_grid> & loc_grid,
+													const openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext)
+	{
+		if (global_layout(filename) == false)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error: " << filename << " does not have the global layout" << std::endl;
+			return false;
+		}
+
+		return read_global(filename,loc_grid,gdb_ext);
 	}
 
 };
@@ -0,0 +1,263 @@
+/*
+ * HDF5_reader_graph.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef OPENFPM_IO_SRC_HDF5_WR_HDF5_READER_GRAPH_HPP_
+#define OPENFPM_IO_SRC_HDF5_WR_HDF5_READER_GRAPH_HPP_
+
+#include "HDF5_util.hpp"
+
+/*! \brief this class is a functor for "for_each" algorithm
+ *
+ * For each property of the vertex (or of the edge) it read the dataset vertex_prp_N (edge_prp_N)
+ *
+ * \tparam Graph graph
+ * \tparam is_vertex true to read the vertex properties, false for the edges
+ *
+ */
+template<typename Graph, bool is_vertex>
+struct h5_graph_read_prop
+{
+	//! graph
+	Graph & g;
+
+	//! HDF5 file
+	hid_t file;
+
+	//! transfer property list
+	hid_t plist_id;
+
+	//! offset of the first vertex (edge) to read
+	hsize_t off;
+
+	//! number of vertices (edges) to read
+	size_t n;
+
+	/*! \brief constructor
+	 *
+	 * \param g graph
+	 * \param file HDF5 file
+	 * \param plist_id transfer property list
+	 * \param off offset of the first vertex (edge) to read
+	 * \param n number of vertices (edges) to read
+	 *
+	 */
+	h5_graph_read_prop(Graph & g, hid_t file, hid_t plist_id, hsize_t off, size_t n)
+	:g(g),file(file),plist_id(plist_id),off(off),n(n)
+	{}
+
+	//! It read the property
+	template<typename T> void operator()(T& t) const
+	{
+		typedef typename std::conditional<is_vertex,typename Graph::V_type,typename Graph::E_type>::type obj;
+		typedef typename boost::mpl::at<typename obj::type,boost::mpl::int_<T::value>>::type ptype;
+
+		Graph & g = this->g;
+
+		std::string name = std::string((is_vertex)?"vertex_prp_":"edge_prp_") + std::to_string(T::value);
+
+		if (is_vertex == true)
+		{
+			h5_prop_rows<ptype>::read(file,name,off,n,
+					[&](size_t i){return (void *)&g.vertex(i).template get<T::value>();},plist_id);
+		}
+		else
+		{
+			h5_prop_rows<ptype>::read(file,name,off,n,
+					[&](size_t i){return (void *)&g.edge(i).template get<T::value>();},plist_id);
+		}
+	}
+};
+
+/*! \brief It load a graph saved by HDF5_writer<GRAPH_DIST>
+ *
+ * The graphs saved by the old processors are distributed across the new processors like
+ * in HDF5_reader<VECTOR_DIST>, every processor read a contiguous range of vertices and edges
+ * with a single collective read for every dataset
+ *
+ */
+template <>
+class HDF5_reader<GRAPH_DIST>
+{
+	//! tuning of the file access
+	h5_io_options opt;
+
+public:
+
+	/*! \brief Set the MPI-IO hints and the metadata options used to open the file
+	 *
+	 * \param opt tuning of the file access
+	 *
+	 */
+	void setIOOptions(const h5_io_options & opt)
+	{
+		this->opt = opt;
+	}
+
+	/*! \brief Load the graph
+	 *
+	 * \param filename file
+	 * \param g graph loaded by this processor (the content is replaced)
+	 *
+	 * \return true if the load succeed
+	 *
+	 */
+	template<typename Graph> inline bool load(const std::string & filename, Graph & g)
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+		g.clear();
+
+		//Open a file
+	    hid_t file = h5_open_checkpoint(filename,v_cl.getMPIComm(),opt);
+	    if (file < 0)	{return false;}
+
+	    //Open dataset
+	    hid_t dataset = H5Dopen (file, "metadata", H5P_DEFAULT);
+	    if (dataset < 0)
+	    {
+	    	std::cerr << __FILE__ << ":" << __LINE__ << " Error: cannot open the metadata of " << filename << std::endl;
+	    	H5Fclose(file);
+	    	return false;
+	    }
+
+	    //Create property list for collective dataset read
+	  	hid_t plist_id = H5Pcreate(H5P_DATASET_XFER);
+	  	if (plist_id == -1)
+	  	{
+	  		H5Dclose(dataset);
+	  		H5Fclose(file);
+	  		return false;
+	  	}
+	  	H5Pset_dxpl_mpio(plist_id, H5FD_MPIO_COLLECTIVE);
+
+		hid_t file_dataspace_id = H5Dget_space(dataset);
+		if (file_dataspace_id < 0)
+		{
+			H5Pclose(plist_id);
+			H5Dclose(dataset);
+			H5Fclose(file);
+			return false;
+		}
+
+		size_t mpi_size_old = H5Sget_select_npoints (file_dataspace_id) / 2;
+
+	  	//Where to read metadata
+		openfpm::vector<long long int> metadata_out;
+		metadata_out.resize(2*mpi_size_old);
+
+		herr_t err = H5Dread(dataset, H5T_NATIVE_LLONG, H5S_ALL, H5S_ALL, plist_id, metadata_out.getPointer());
+		H5Sclose(file_dataspace_id);
+		H5Dclose(dataset);
+		if (err < 0)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error: cannot read the metadata of " << filename << std::endl;
+			H5Pclose(plist_id);
+			H5Fclose(file);
+			return false;
+		}
+
+	  	// Distribute the old processors blocks
+
+	  	size_t start_block;
+	  	size_t stop_block;
+
+	  	h5_block_range(mpi_size_old,v_cl.getProcessUnitID(),v_cl.getProcessingUnits(),start_block,stop_block);
+
+	  	size_t v_off = 0;
+	  	size_t n_v = 0;
+	  	size_t n_e = 0;
+
+	  	for (size_t i = 0 ; i < stop_block ; i++)
+	  	{
+	  		if (i < start_block)
+	  		{v_off += metadata_out.get(2*i);}
+	  		else
+	  		{
+	  			n_v += metadata_out.get(2*i);
+	  			n_e += metadata_out.get(2*i+1);
+	  		}
+	  	}
+
+	  	// Row pointer (n_v + 1) and column index
+
+	  	io_prof_scope p_read("hdf5_read");
+
+	  	openfpm::vector<long long int> row_ptr;
+	  	row_ptr.resize(n_v+1);
+
+	  	if (h5_read_1d(file,"row_ptr",H5T_NATIVE_LLONG,v_off,n_v+1,row_ptr.getPointer(),plist_id) == false)
+	  	{
+	  		std::cerr << __FILE__ << ":" << __LINE__ << " Error: cannot read row_ptr from " << filename << std::endl;
+	  		H5Pclose(plist_id);
+	  		H5Fclose(file);
+	  		return false;
+	  	}
+
+	  	size_t e_off = row_ptr.get(0);
+
+	  	openfpm::vector<long long int> col_index;
+	  	col_index.resize(n_e);
+
+	  	if (h5_read_1d(file,"col_index",H5T_NATIVE_LLONG,e_off,n_e,col_index.getPointer(),plist_id) == false)
+	  	{
+	  		std::cerr << __FILE__ << ":" << __LINE__ << " Error: cannot read col_index from " << filename << std::endl;
+	  		H5Pclose(plist_id);
+	  		H5Fclose(file);
+	  		return false;
+	  	}
+
+	  	p_read.stop((n_v + 1 + n_e) * sizeof(long long int));
+
+	  	// Create the graph, edges are added in CSR order so the edge k is the k-th of col_index
+
+	  	io_prof_scope p_unpack("hdf5_unpack");
+
+	  	for (size_t i = 0 ; i < n_v ; i++)
+	  	{g.addVertex();}
+
+	  	bool ret = true;
+
+	  	for (size_t i = 0 ; i < n_v ; i++)
+	  	{
+	  		for (long long int k = row_ptr.get(i) ; k < row_ptr.get(i+1) ; k++)
+	  		{
+	  			long long int trg = col_index.get(k - e_off) - v_off;
+
+	  			// save never write such edges, the file is corrupted
+
+	  			if (trg < 0 || trg >= (long long int)n_v)
+	  			{
+	  				std::cerr << __FILE__ << ":" << __LINE__ << " Error: the edge " << k << " in " << filename << " point to a vertex of another block" << std::endl;
+	  				ret = false;
+	  				continue;
+	  			}
+
+	  			g.addEdge(i,trg);
+	  		}
+	  	}
+
+	  	p_unpack.stop(n_v * sizeof(typename Graph::V_type) + n_e * sizeof(typename Graph::E_type));
+
+	  	// Properties
+
+	  	io_prof_scope p_read_prp("hdf5_read");
+
+	  	h5_graph_read_prop<Graph,true> rv(g,file,plist_id,v_off,n_v);
+	  	boost::mpl::for_each_ref< boost::mpl::range_c<int,0,Graph::V_type::max_prop> >(rv);
+
+	  	h5_graph_read_prop<Graph,false> re(g,file,plist_id,e_off,(ret == true)?n_e:0);
+	  	boost::mpl::for_each_ref< boost::mpl::range_c<int,0,Graph::E_type::max_prop> >(re);
+
+	  	p_read_prp.stop(n_v * sizeof(typename Graph::V_type) + ((ret == true)?n_e:0) * sizeof(typename Graph::E_type));
+
+	  	H5Pclose(plist_id);
+	    H5Fclose(file);
+
+	    return ret;
+	}
+};
+
+#endif /* OPENFPM_IO_SRC_HDF5_WR_HDF5_READER_GRAPH_HPP_ */
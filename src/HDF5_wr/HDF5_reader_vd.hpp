@@ -8,235 +8,1131 @@
 #ifndef OPENFPM_IO_SRC_HDF5_WR_HDF5_READER_VD_HPP_
 #define OPENFPM_IO_SRC_HDF5_WR_HDF5_READER_VD_HPP_
 
+#include "HDF5_util.hpp"
+#include "Space/Shape/Box.hpp"
+
+/*! \brief Reset an object to its default value
+ *
+ * \tparam T type of the object
+ *
+ */
+template<typename T>
+struct h5_vd_reset
+{
+	//! reset the object
+	static void reset(T & t)
+	{
+		t = T();
+	}
+};
+
+//! Reset every element of an array
+template<typename T, size_t N>
+struct h5_vd_reset<T[N]>
+{
+	//! reset the array
+	static void reset(T (& t)[N])
+	{
+		for (size_t i = 0 ; i < N ; i++)
+		{h5_vd_reset<T>::reset(t[i]);}
+	}
+};
+
+/*! \brief Check if a property is in the list of the properties to load
+ *
+ * \param prp list of properties (NULL for all the properties)
+ * \param id property
+ *
+ * \return true if the property must be loaded
+ *
+ */
+inline bool h5_vd_is_selected(const openfpm::vector<size_t> * prp, size_t id)
+{
+	if (prp == NULL)
+	{return true;}
+
+	for (size_t i = 0 ; i < prp->size() ; i++)
+	{
+		if (prp->get(i) == id)
+		{return true;}
+	}
+
+	return false;
+}
+
+/*! \brief Check if the particles are packed as plain memory
+ *
+ * In this case a packed block is the number of particles followed by the positions, and
+ * the number of particles followed by the properties
+ *
+ * \tparam vector_pos_type vector of positions
+ * \tparam vector_prp_type vector of properties
+ *
+ * \return true if positions and properties do not contain pointers
+ *
+ */
+template<typename vector_pos_type, typename vector_prp_type>
+inline bool h5_vd_packed_pod()
+{
+	return vector_pos_type::value_type::noPointers() == true && vector_prp_type::value_type::noPointers() == true;
+}
+
+/*! \brief Size in bytes of a block of n particles packed as plain memory
+ *
+ * \param n number of particles
+ *
+ * \return the size of the block
+ *
+ */
+template<typename vector_pos_type, typename vector_prp_type>
+inline size_t h5_vd_packed_size(size_t n)
+{
+	return 2*sizeof(size_t) + n*(sizeof(typename vector_pos_type::value_type) + sizeof(typename vector_prp_type::value_type));
+}
+
+/*! \brief Number of particles of a block packed as plain memory
+ *
+ * \param block size of the block in bytes
+ *
+ * \return the number of particles
+ *
+ */
+template<typename vector_pos_type, typename vector_prp_type>
+inline size_t h5_vd_packed_n(size_t block)
+{
+	if (block < 2*sizeof(size_t))
+	{return 0;}
+
+	return (block - 2*sizeof(size_t)) / (sizeof(typename vector_pos_type::value_type) + sizeof(typename vector_prp_type::value_type));
+}
+
+/*! \brief this class is a functor for "for_each" algorithm
+ *
+ * For each property not in the list of the properties to load it reset the property
+ * of the elements [start,stop) to the default value
+ *
+ * \tparam vector_type vector of properties
+ *
+ */
+template<typename vector_type>
+struct h5_vd_reset_prp
+{
+	//! vector
+	vector_type & v;
+
+	//! properties loaded
+	const openfpm::vector<size_t> * prp;
+
+	//! first element to reset
+	size_t start;
+
+	//! one after the last element to reset
+	size_t stop;
+
+	/*! \brief constructor
+	 *
+	 * \param v vector
+	 * \param prp properties loaded (NULL for all)
+	 * \param start first element to reset
+	 * \param stop one after the last element to reset
+	 *
+	 */
+	h5_vd_reset_prp(vector_type & v, const openfpm::vector<size_t> * prp, size_t start, size_t stop)
+	:v(v),prp(prp),start(start),stop(stop)
+	{}
+
+	//! It reset the property
+	template<typename T> void operator()(T& t) const
+	{
+		typedef typename boost::mpl::at<typename vector_type::value_type::type,boost::mpl::int_<T::value>>::type ptype;
+
+		if (h5_vd_is_selected(prp,T::value) == true)
+		{return;}
+
+		for (size_t i = start ; i < stop ; i++)
+		{h5_vd_reset<ptype>::reset(v.template get<T::value>(i));}
+	}
+};
+
+/*! \brief this class is a functor for "for_each" algorithm
+ *
+ * For each property of the vector it read the typed dataset prefix + property id
+ * (or name if the vector has a single property)
+ *
+ * \tparam vector_type vector of positions or properties
+ *
+ */
+template<typename vector_type>
+struct h5_vd_read_column
+{
+	//! vector
+	vector_type & v;
+
+	//! HDF5 file
+	hid_t file;
+
+	//! transfer property list
+	hid_t plist_id;
+
+	//! first particle to read
+	hsize_t off;
+
+	//! number of particles to read
+	size_t n;
+
+	//! where to store the first particle in v
+	size_t voff;
+
+	//! dataset name
+	std::string name;
+
+	//! true if all the properties has been read
+	bool ret = true;
+
+	//! properties to read, the others are reset to the default value (NULL for all)
+	const openfpm::vector<size_t> * prp = NULL;
+
+	//! maximum bytes for a single transfer
+	size_t max_io = HDF5_MAX_IO_BYTES;
+
+	/*! \brief constructor
+	 *
+	 * \param v vector (already resized)
+	 * \param file HDF5 file
+	 * \param plist_id transfer property list
+	 * \param off first particle to read
+	 * \param n number of particles to read
+	 * \param voff where to store the first particle in v
+	 * \param name dataset name (property_ for property_0 property_1 ...)
+	 *
+	 */
+	h5_vd_read_column(vector_type & v, hid_t file, hid_t plist_id, hsize_t off, size_t n, size_t voff, const std::string & name)
+	:v(v),file(file),plist_id(plist_id),off(off),n(n),voff(voff),name(name)
+	{}
+
+	//! It read the property
+	template<typename T> void operator()(T& t)
+	{
+		typedef typename boost::mpl::at<typename vector_type::value_type::type,boost::mpl::int_<T::value>>::type ptype;
+
+		vector_type & v = this->v;
+
+		std::string dname = (name.size() != 0 && name.back() == '_')?name + std::to_string(T::value):name;
+
+		if (h5_vd_is_selected(prp,T::value) == false)
+		{
+			for (size_t i = voff ; i < voff + n ; i++)
+			{h5_vd_reset<ptype>::reset(v.template get<T::value>(i));}
+
+			return;
+		}
+
+		// read directly in the memory of the vector
+
+		void * base = (n == 0)?NULL:(void *)&v.template get<T::value>(voff);
+		size_t stride = (n < 2)?sizeof(ptype):(char *)&v.template get<T::value>(voff+1) - (char *)base;
+
+		if (h5_prop_rows<ptype>::read_strided(file,dname,off,n,base,stride,plist_id,max_io) == false)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error: cannot read the dataset " << dname << std::endl;
+			ret = false;
+		}
+	}
+};
 
 template <>
 class HDF5_reader<VECTOR_DIST>
 {
 private:
 
+	//! maximum number of bytes read by a single H5Dread
+	size_t max_io = HDF5_MAX_IO_BYTES;
+
+	//! tuning of the file access
+	h5_io_options opt;
+
+	/*! \brief Load a file saved with the HDF5_COLUMNS layout
+	 *
+	 * Every processor read its ranges of particles, every range is a collective read
+	 * for every dataset, the processors with less ranges participate with empty reads
+	 *
+	 * \param file HDF5 file
+	 * \param plist_id transfer property list
+	 * \param offs first particle of every range
+	 * \param ns number of particles of every range
+	 * \param n_reads number of collective reads (maximum number of ranges across processors)
+	 * \param v_pos positions
+	 * \param v_prp properties
+	 * \param g_m number of particles loaded
+	 * \param prp properties to read (NULL for all)
+	 *
+	 * \return true if the load succeed
+	 *
+	 */
+	template<typename vector_pos_type, typename vector_prp_type>
+	bool load_columns(hid_t file,
+			          hid_t plist_id,
+					  const openfpm::vector<size_t> & offs,
+					  const openfpm::vector<size_t> & ns,
+					  size_t n_reads,
+			          vector_pos_type & v_pos,
+					  vector_prp_type & v_prp,
+					  size_t & g_m,
+					  const openfpm::vector<size_t> * prp = NULL)
+	{
+		size_t n = 0;
+
+		for (size_t k = 0 ; k < ns.size() ; k++)
+		{n += ns.get(k);}
+
+		v_pos.resize(n);
+		v_prp.resize(n);
+
+		bool ret = true;
+		size_t voff = 0;
+
+		io_prof_scope p_read("hdf5_read");
+
+		for (size_t k = 0 ; k < n_reads ; k++)
+		{
+			size_t off = (k < offs.size())?offs.get(k):0;
+			size_t nk = (k < ns.size())?ns.get(k):0;
+
+			h5_vd_read_column<vector_pos_type> rpos(v_pos,file,plist_id,off,nk,voff,"position");
+			rpos.max_io = max_io;
+			boost::mpl::for_each_ref< boost::mpl::range_c<int,0,1> >(rpos);
+
+			h5_vd_read_column<vector_prp_type> rprp(v_prp,file,plist_id,off,nk,voff,"property_");
+			rprp.prp = prp;
+			rprp.max_io = max_io;
+			boost::mpl::for_each_ref< boost::mpl::range_c<int,0,vector_prp_type::value_type::max_prop> >(rprp);
+
+			ret &= rpos.ret && rprp.ret;
+			voff += nk;
+		}
+
+		p_read.stop(n * (sizeof(typename vector_pos_type::value_type) + sizeof(typename vector_prp_type::value_type)));
+
+		g_m = v_pos.size();
+
+		return ret;
+	}
+
+	/*! \brief Assign every old block to the processor that own its region
+	 *
+	 * The block go to the processor whose sub-domains contain the center of the
+	 * bounding box of the block (the sub-domains are treated as half open so a point on
+	 * a shared face has a single owner). Blocks not claimed by any processor (empty blocks
+	 * or centers on the upper face of the domain) are assigned like in h5_block_balance
+	 *
+	 * \param file HDF5 file
+	 * \param metadata_out size of every block
+	 * \param sub_domains sub-domains of this processor
+	 * \param owner processor that load every block
+	 *
+	 * \return false if the file does not have the bounding box of the blocks
+	 *
+	 */
+	template<typename vector_box_type>
+	bool spatial_owner(hid_t file,
+			           openfpm::vector<long long int> & metadata_out,
+					   const vector_box_type & sub_domains,
+					   openfpm::vector<size_t> & owner)
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+		const unsigned int dim = vector_box_type::value_type::dims;
+		size_t mpi_size_old = metadata_out.size();
+
+		openfpm::vector<double> bbox;
+		bbox.resize(2*dim*mpi_size_old);
+
+		hsize_t row_dims[1] = {2*dim};
+
+		// block_bbox is read by everybody, the presence is the same on all the processors
+
+		if (H5Lexists(file, "block_bbox", H5P_DEFAULT) <= 0 ||
+			h5_read_rows(file,"block_bbox",H5T_NATIVE_DOUBLE,0,mpi_size_old,1,row_dims,bbox.getPointer(),H5P_DEFAULT) == false)
+		{return false;}
+
+		openfpm::vector<long long int> claim;
+		claim.resize(mpi_size_old);
+
+		for (size_t b = 0 ; b < mpi_size_old ; b++)
+		{
+			claim.get(b) = std::numeric_limits<long long int>::max();
+
+			const double * bb = &bbox.get(2*dim*b);
+
+			if (bb[0] > bb[dim])
+			{continue;}
+
+			for (size_t i = 0 ; i < sub_domains.size() ; i++)
+			{
+				bool inside = true;
+
+				for (size_t d = 0 ; d < dim ; d++)
+				{
+					double c = 0.5*(bb[d] + bb[dim+d]);
+					inside &= (sub_domains.get(i).getLow(d) <= c && c < sub_domains.get(i).getHigh(d));
+				}
+
+				if (inside == true)
+				{
+					claim.get(b) = v_cl.getProcessUnitID();
+					break;
+				}
+			}
+		}
+
+		MPI_Allreduce(MPI_IN_PLACE,claim.getPointer(),mpi_size_old,MPI_LONG_LONG,MPI_MIN,v_cl.getMPIComm());
+
+		openfpm::vector<size_t> first;
+		h5_block_balance((long long int *)metadata_out.getPointer(),mpi_size_old,v_cl.getProcessingUnits(),first);
+
+		owner.resize(mpi_size_old);
+
+		for (size_t i = 0 ; i < v_cl.getProcessingUnits() ; i++)
+		{
+			for (size_t b = first.get(i) ; b < first.get(i+1) ; b++)
+			{owner.get(b) = (claim.get(b) == std::numeric_limits<long long int>::max())?i:claim.get(b);}
+		}
+
+		return true;
+	}
+
+	/*! \brief Load the block bid saved by an old processor
+	 *
+	 * The block is read in n_chunk collective reads (the same number on all the processors)
+	 *
+	 * \param bid block to read (-1 or a block >= mpi_size_old to participate without reading)
+	 * \param mpi_size_old number of blocks
+	 * \param metadata_out size in bytes of every block
+	 * \param metadata_accum offset of every block
+	 * \param n_chunk number of collective reads
+	 * \param plist_id transfer property list
+	 * \param dataset_2 vector_dist dataset
+	 * \param g_m number of particles loaded
+	 * \param v_pos positions
+	 * \param v_prp properties
+	 *
+	 * \return true if the read succeed
+	 *
+	 */
 	template<typename vector_pos_type, typename vector_prp_type>
 	bool load_block(long int bid,
 			        hssize_t mpi_size_old,
-					int * metadata_out,
-					openfpm::vector<size_t> metadata_accum,
+					openfpm::vector<long long int> & metadata_out,
+					openfpm::vector<size_t> & metadata_accum,
+					size_t n_chunk,
 					hid_t plist_id,
 					hid_t dataset_2,
 					size_t & g_m,
 					vector_pos_type & v_pos,
 					vector_prp_type & v_prp)
 	{
-		hsize_t offset[1];
-		hsize_t block[1];
+		hsize_t offset;
+		size_t block;
 
 		if (bid < mpi_size_old && bid != -1)
 		{
-			offset[0] = metadata_accum.get(bid);
-			block[0] = metadata_out[bid];
+			offset = metadata_accum.get(bid);
+			block = metadata_out.get(bid);
 		}
 		else
 		{
-			offset[0] = 0;
-			block[0] = 0;
+			offset = 0;
+			block = 0;
 		}
 
-	    hsize_t count[1] = {1};
-
-
-		//Select file dataspace
-		hid_t file_dataspace_id_2 = H5Dget_space(dataset_2);
-		if (file_dataspace_id_2 < 0)	{return false;}
+		// allocate the memory
+		HeapMemory pmem;
 
-        herr_t err = H5Sselect_hyperslab(file_dataspace_id_2, H5S_SELECT_SET, offset, NULL, count, block);
-        if (err < 0)	{return false;}
+		ExtPreAlloc<HeapMemory> & mem = *(new ExtPreAlloc<HeapMemory>(block,pmem));
+		mem.incRef();
 
-        hsize_t mdim_2[1] = {block[0]};
+	  	// Read the dataset in chunk of max_io (2GB) maximum
+		io_prof_scope p_read("hdf5_read");
+		bool ret = h5_read_bytes(dataset_2,offset,block,n_chunk,(char *)mem.getPointer(),plist_id,max_io);
+		p_read.stop(block);
 
+		if (ret == false || block == 0)
+		{
+			mem.decRef();
+			delete &mem;
+			return ret;
+		}
 
-		//Create data space in memory
-		hid_t mem_dataspace_id_2 = H5Screate_simple(1, mdim_2, NULL);
-		if (mem_dataspace_id_2 < 0)	{return false;}
+		mem.allocate(pmem.size());
 
-		size_t sum = 0;
+		io_prof_scope p_unpack("hdf5_unpack");
 
-		for (int i = 0; i < mpi_size_old; i++)
-			sum += metadata_out[i];
+		if (h5_vd_packed_pod<vector_pos_type,vector_prp_type>())
+		{
+			// The block contain the number of particles followed by the positions, and the
+			// number of particles followed by the properties, unpack directly at the end of
+			// v_pos and v_prp (reserved by load_packed)
 
-		// allocate the memory
-		HeapMemory pmem;
+			const char * ptr = (const char *)mem.getPointer();
 
-		ExtPreAlloc<HeapMemory> & mem = *(new ExtPreAlloc<HeapMemory>(block[0],pmem));
-		mem.incRef();
+			size_t n_pos;
+			size_t n_prp;
+			std::memcpy(&n_pos,ptr,sizeof(size_t));
+			std::memcpy(&n_prp,ptr + sizeof(size_t) + n_pos*sizeof(typename vector_pos_type::value_type),sizeof(size_t));
 
-	  	// Read the dataset.
-	    err = H5Dread(dataset_2, H5T_NATIVE_CHAR, mem_dataspace_id_2, file_dataspace_id_2, plist_id, (char *)mem.getPointer());
-	    if (err < 0)	{return false;}
+			if (n_pos != n_prp || h5_vd_packed_size<vector_pos_type,vector_prp_type>(n_pos) != block)
+			{
+				std::cerr << __FILE__ << ":" << __LINE__ << " Error the block " << bid << " does not contain " << n_pos << " packed particles" << std::endl;
 
-		mem.allocate(pmem.size());
+				mem.decRef();
+				delete &mem;
+				return false;
+			}
 
-		Unpack_stat ps;
+			size_t old = v_pos.size();
 
-		vector_pos_type v_pos_unp;
+			v_pos.resize(old + n_pos);
+			v_prp.resize(old + n_pos);
 
-		vector_prp_type v_prp_unp;
+			std::memcpy((char *)v_pos.getPointer() + old*sizeof(typename vector_pos_type::value_type),
+					    ptr + sizeof(size_t),
+					    n_pos*sizeof(typename vector_pos_type::value_type));
+			std::memcpy((char *)v_prp.getPointer() + old*sizeof(typename vector_prp_type::value_type),
+					    ptr + 2*sizeof(size_t) + n_pos*sizeof(typename vector_pos_type::value_type),
+					    n_pos*sizeof(typename vector_prp_type::value_type));
+		}
+		else
+		{
+			// The particles contain pointers, the Unpacker can only unpack a full vector
+
+			Unpack_stat ps;
+
+			vector_pos_type v_pos_unp;
+			vector_prp_type v_prp_unp;
+
+			Unpacker<decltype(v_pos_unp),HeapMemory>::unpack(mem,v_pos_unp,ps,1);
+			Unpacker<decltype(v_prp_unp),HeapMemory>::unpack(mem,v_prp_unp,ps,1);
+
+			if (v_pos.size() == 0)
+			{
+				v_pos.swap(v_pos_unp);
+				v_prp.swap(v_prp_unp);
+			}
+			else
+			{
+				v_pos.add(v_pos_unp);
+				v_prp.add(v_prp_unp);
+			}
+		}
 
-		Unpacker<decltype(v_pos_unp),HeapMemory>::unpack(mem,v_pos_unp,ps,1);
-		Unpacker<decltype(v_prp_unp),HeapMemory>::unpack(mem,v_prp_unp,ps,1);
+		p_unpack.stop(block);
 
 		mem.decRef();
 		delete &mem;
 
-		for (size_t i = 0; i < v_pos_unp.size(); i++)
-			v_pos.add(v_pos_unp.get(i));
-
-		for (size_t i = 0; i < v_prp_unp.size(); i++)
-			v_prp.add(v_prp_unp.get(i));
-
 		g_m = v_pos.size();
 
-		H5Sclose(file_dataspace_id_2);
-		H5Sclose(mem_dataspace_id_2);
-
 		return true;
 	}
 
 public:
 
+	/*! \brief Set the maximum number of bytes read by a single H5Dread
+	 *
+	 * The default is 2GB (the limit of MPI-IO), smaller values are useful only to test
+	 *
+	 * \param max_io maximum number of bytes
+	 *
+	 */
+	void setMaxIOBytes(size_t max_io)
+	{
+		this->max_io = (max_io == 0)?1:std::min(max_io,(size_t)HDF5_MAX_IO_BYTES);
+	}
+
+	/*! \brief Set the MPI-IO hints and the metadata options used to open the file
+	 *
+	 * \param opt tuning of the file access
+	 *
+	 */
+	void setIOOptions(const h5_io_options & opt)
+	{
+		this->opt = opt;
+	}
+
+	/*! \brief Load the particles
+	 *
+	 * The blocks saved by the old processors are distributed balancing the bytes read by
+	 * every processor (see h5_block_balance)
+	 *
+	 * \param filename file
+	 * \param v_pos positions
+	 * \param v_prp properties
+	 * \param g_m number of particles loaded
+	 *
+	 * \return true if the load succeed
+	 *
+	 */
 	template<typename vector_pos_type, typename vector_prp_type> inline bool load(const std::string & filename,
 			                                                               vector_pos_type & v_pos,
 																		   vector_prp_type & v_prp,
 																		   size_t & g_m)
 	{
-		Vcluster<> & v_cl = create_vcluster();
+		typedef typename vector_pos_type::value_type pos_type;
 
-		v_pos.clear();
-		v_prp.clear();
+		return load_impl(filename,v_pos,v_prp,g_m,(const openfpm::vector<Box<pos_type::dims,typename pos_type::coord_type>> *)NULL);
+	}
 
-		g_m = 0;
+	/*! \brief Load the particles reading every old block on the processor that own its region
+	 *
+	 * Every block is loaded by the processor whose sub-domains contain the center of the
+	 * bounding box of the block, so most of the particles are already on the right processor
+	 * and the redistribution after the load move only the particles near the sub-domain borders.
+	 * Files without the bounding box of the blocks are loaded like in load
+	 *
+	 * \param filename file
+	 * \param v_pos positions
+	 * \param v_prp properties
+	 * \param g_m number of particles loaded
+	 * \param sub_domains sub-domains of this processor (vector of Box)
+	 *
+	 * \return true if the load succeed
+	 *
+	 */
+	template<typename vector_pos_type, typename vector_prp_type, typename vector_box_type> inline bool load(const std::string & filename,
+			                                                               vector_pos_type & v_pos,
+																		   vector_prp_type & v_prp,
+																		   size_t & g_m,
+																		   const vector_box_type & sub_domains)
+	{
+		return load_impl(filename,v_pos,v_prp,g_m,&sub_domains);
+	}
 
-		MPI_Comm comm = v_cl.getMPIComm();
-		MPI_Info info  = MPI_INFO_NULL;
+	/*! \brief Load a subset of the properties of all the particles
+	 *
+	 * The particles are distributed like in load, the properties not in prp are left to
+	 * their default value. With the HDF5_COLUMNS layout only the datasets of the selected
+	 * properties are read, the packed layout read the full blocks
+	 *
+	 * \param filename file
+	 * \param v_pos positions
+	 * \param v_prp properties
+	 * \param g_m number of particles loaded
+	 * \param prp properties to load (the same on all the processors)
+	 *
+	 * \return true if the load succeed
+	 *
+	 */
+	template<typename vector_pos_type, typename vector_prp_type> inline bool load_partial(const std::string & filename,
+			                                                               vector_pos_type & v_pos,
+																		   vector_prp_type & v_prp,
+																		   size_t & g_m,
+																		   const openfpm::vector<size_t> & prp)
+	{
+		typedef typename vector_pos_type::value_type pos_type;
 
-		int mpi_rank = v_cl.getProcessUnitID();
+		return load_partial_impl(filename,v_pos,v_prp,g_m,prp,(const Box<pos_type::dims,typename pos_type::coord_type> *)NULL);
+	}
 
-		// Set up file access property list with parallel I/O access
-		hid_t plist_id = H5Pcreate(H5P_FILE_ACCESS);
-		if (plist_id == -1)	{return false;}
-		herr_t err = H5Pset_fapl_mpio(plist_id, comm, info);
-		if (err < 0)
-			return false;
+	/*! \brief Load a subset of the properties of the particles inside a region
+	 *
+	 * Every processor read only the blocks whose bounding box overlap its region (all the blocks
+	 * if the file does not have the bounding boxes) and keep the particles inside the region,
+	 * the regions of different processors can overlap. The properties not in prp are left to
+	 * their default value
+	 *
+	 * \param filename file
+	 * \param v_pos positions
+	 * \param v_prp properties
+	 * \param g_m number of particles loaded
+	 * \param prp properties to load (the same on all the processors)
+	 * \param bbox region to load (Box)
+	 *
+	 * \return true if the load succeed
+	 *
+	 */
+	template<typename vector_pos_type, typename vector_prp_type, typename box_type> inline bool load_partial(const std::string & filename,
+			                                                               vector_pos_type & v_pos,
+																		   vector_prp_type & v_prp,
+																		   size_t & g_m,
+																		   const openfpm::vector<size_t> & prp,
+																		   const box_type & bbox)
+	{
+		return load_partial_impl(filename,v_pos,v_prp,g_m,prp,&bbox);
+	}
 
-		//Open a file
-	    hid_t file = H5Fopen (filename.c_str(), H5F_ACC_RDONLY, plist_id);
-	    if (file < 0)	{return false;}
-	    H5Pclose(plist_id);
+private:
+
+	/*! \brief Open the file for a collective read
+	 *
+	 * \param filename file
+	 *
+	 * \return the file (negative on failure)
+	 *
+	 */
+	hid_t open_file(const std::string & filename)
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+		return h5_open_checkpoint(filename,v_cl.getMPIComm(),opt);
+	}
 
+	/*! \brief Read the size of every block (bytes for the packed layout, particles for the columns)
+	 *
+	 * \param file HDF5 file
+	 * \param plist_id transfer property list
+	 * \param metadata_out size of every block
+	 * \param metadata_accum offset of every block
+	 *
+	 * \return true if the read succeed
+	 *
+	 */
+	bool read_metadata(hid_t file,
+			           hid_t plist_id,
+					   openfpm::vector<long long int> & metadata_out,
+					   openfpm::vector<size_t> & metadata_accum)
+	{
 	    //Open dataset
 	    hid_t dataset = H5Dopen (file, "metadata", H5P_DEFAULT);
 	    if (dataset < 0)	{return false;}
 
-	    //Create property list for collective dataset read
-	  	plist_id = H5Pcreate(H5P_DATASET_XFER);
-	  	if (plist_id == -1)	{return false;}
-	  	H5Pset_dxpl_mpio(plist_id, H5FD_MPIO_COLLECTIVE);
-
 		//Select file dataspace
 		hid_t file_dataspace_id = H5Dget_space(dataset);
 		if (file_dataspace_id < 0)	{return false;}
 
 		hssize_t mpi_size_old = H5Sget_select_npoints (file_dataspace_id);
-		if (mpi_size_old < 0)	{return false;}
+		if (mpi_size_old <= 0)	{return false;}
 
-	  	//Where to read metadata
-	  	int metadata_out[mpi_size_old];
+	  	//Where to read metadata (on the heap, it can be large with many processors)
+		metadata_out.resize(mpi_size_old);
 
 	  	for (int i = 0; i < mpi_size_old; i++)
-	  	{metadata_out[i] = 0;}
+	  	{metadata_out.get(i) = 0;}
 
-		//Size for data space in memory
-		hsize_t mdim[1] = {(size_t)mpi_size_old};
+	  	// Read the dataset, old files store the sizes as int and HDF5 convert them to 64 bit
+	    herr_t err = H5Dread(dataset, H5T_NATIVE_LLONG, H5S_ALL, H5S_ALL, plist_id, metadata_out.getPointer());
 
-		//Create data space in memory
-		hid_t mem_dataspace_id = H5Screate_simple(1, mdim, NULL);
-		if (mem_dataspace_id < 0)	{return false;}
+	  	// Close open object
+	  	H5Sclose(file_dataspace_id);
+	    H5Dclose(dataset);
 
-	  	// Read the dataset.
-	    err = H5Dread(dataset, H5T_NATIVE_INT, mem_dataspace_id, file_dataspace_id, plist_id, metadata_out);
 	    if (err < 0)	{return false;}
 
-	    openfpm::vector<size_t> metadata_accum;
 	    metadata_accum.resize(mpi_size_old);
 
 	    metadata_accum.get(0) = 0;
 	    for (int i = 1 ; i < mpi_size_old ; i++)
-	    	metadata_accum.get(i) = metadata_accum.get(i-1) + metadata_out[i-1];
+	    	metadata_accum.get(i) = metadata_accum.get(i-1) + metadata_out.get(i-1);
 
+	    return true;
+	}
+
+	/*! \brief Load the blocks of a file saved with the packed layout
+	 *
+	 * \param file HDF5 file
+	 * \param plist_id transfer property list
+	 * \param metadata_out size in bytes of every block
+	 * \param metadata_accum offset of every block
+	 * \param blocks blocks to load on this processor
+	 * \param n_chunk collective reads for every call of load_block (the same on all the processors)
+	 * \param v_pos positions
+	 * \param v_prp properties
+	 * \param g_m number of particles loaded
+	 *
+	 * \return true if the load succeed
+	 *
+	 */
+	template<typename vector_pos_type, typename vector_prp_type>
+	bool load_packed(hid_t file,
+			         hid_t plist_id,
+					 openfpm::vector<long long int> & metadata_out,
+					 openfpm::vector<size_t> & metadata_accum,
+					 const openfpm::vector<size_t> & blocks,
+					 const openfpm::vector<size_t> & n_chunk,
+					 vector_pos_type & v_pos,
+					 vector_prp_type & v_prp,
+					 size_t & g_m)
+	{
 	    //Open dataset
 	    hid_t dataset_2 = H5Dopen (file, "vector_dist", H5P_DEFAULT);
 	    if (dataset_2 < 0)	{return false;}
 
+	  	// When the particles are packed as plain memory the size of a block give exactly its
+	  	// number of particles, reserve once all the blocks of this processor
+
+	  	if (h5_vd_packed_pod<vector_pos_type,vector_prp_type>())
+	  	{
+	  		size_t n_part = 0;
+	  		for (size_t k = 0 ; k < blocks.size() ; k++)
+	  		{n_part += h5_vd_packed_n<vector_pos_type,vector_prp_type>(metadata_out.get(blocks.get(k)));}
+
+	  		v_pos.reserve(n_part);
+	  		v_prp.reserve(n_part);
+	  	}
+
+	  	// every processor call load_block the same number of times (at least once), the processors
+	  	// with less blocks participate to the collective reads without reading
+
+	  	bool ret = true;
+
+	  	for (size_t k = 0 ; k < n_chunk.size() ; k++)
+	  	{
+	  		long int bid = (k < blocks.size())?(long int)blocks.get(k):-1;
+	  		ret &= load_block(bid,metadata_out.size(),metadata_out,metadata_accum,n_chunk.get(k),plist_id,dataset_2,g_m,v_pos,v_prp);
+	  	}
+
+	    H5Dclose(dataset_2);
+
+	    return ret;
+	}
+
+	/*! \brief Load the particles
+	 *
+	 * \param filename file
+	 * \param v_pos positions
+	 * \param v_prp properties
+	 * \param g_m number of particles loaded
+	 * \param sub_domains sub-domains of this processor (NULL to balance the bytes)
+	 *
+	 * \return true if the load succeed
+	 *
+	 */
+	template<typename vector_pos_type, typename vector_prp_type, typename vector_box_type> inline bool load_impl(const std::string & filename,
+			                                                               vector_pos_type & v_pos,
+																		   vector_prp_type & v_prp,
+																		   size_t & g_m,
+																		   const vector_box_type * sub_domains)
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+		v_pos.clear();
+		v_prp.clear();
+
+		g_m = 0;
+
+		size_t mpi_rank = v_cl.getProcessUnitID();
+		size_t n_proc = v_cl.getProcessingUnits();
+
+	    hid_t file = open_file(filename);
+	    if (file < 0)	{return false;}
+
+	    // File saved with the HDF5_COLUMNS layout (metadata contain particles instead of bytes)
+
+	    bool columns = (H5Lexists(file, "position", H5P_DEFAULT) > 0);
+
 	    //Create property list for collective dataset read
-	  	plist_id = H5Pcreate(H5P_DATASET_XFER);
+	  	hid_t plist_id = H5Pcreate(H5P_DATASET_XFER);
 	  	if (plist_id == -1)	{return false;}
 
-	  	err = H5Pset_dxpl_mpio(plist_id, H5FD_MPIO_COLLECTIVE);
+	  	herr_t err = H5Pset_dxpl_mpio(plist_id, H5FD_MPIO_COLLECTIVE);
 	  	if (err < 0)	{return false;}
 
-	  	openfpm::vector<size_t> n_block;
-	  	n_block.resize(v_cl.getProcessingUnits());
+		openfpm::vector<long long int> metadata_out;
+	    openfpm::vector<size_t> metadata_accum;
 
+	    if (read_metadata(file,plist_id,metadata_out,metadata_accum) == false)
+	    {
+	    	H5Pclose(plist_id);
+	    	H5Fclose(file);
+	    	return false;
+	    }
 
-	  	for(size_t i = 0 ; i < n_block.size() ; i++)
-	  		n_block.get(i) = mpi_size_old / v_cl.getProcessingUnits();
+	    size_t mpi_size_old = metadata_out.size();
 
-	  	size_t rest_block = mpi_size_old % v_cl.getProcessingUnits();
+	  	// Processor that load every old block, on its region or balancing the bytes
 
-	  	size_t max_block;
+	    openfpm::vector<size_t> owner;
 
-	  	if (rest_block != 0)
-	  		max_block = n_block.get(0) + 1;
-	  	else
-	  		max_block = n_block.get(0);
+	    bool spatial = (sub_domains != NULL && spatial_owner(file,metadata_out,*sub_domains,owner) == true);
+
+	    if (spatial == false)
+	    {
+	    	openfpm::vector<size_t> first;
+	    	h5_block_balance((long long int *)metadata_out.getPointer(),mpi_size_old,n_proc,first);
+
+	    	owner.resize(mpi_size_old);
+
+	    	for (size_t i = 0 ; i < n_proc ; i++)
+	    	{
+	    		for (size_t b = first.get(i) ; b < first.get(i+1) ; b++)
+	    		{owner.get(b) = i;}
+	    	}
+	    }
+
+	  	// Blocks of this processor and number of collective reads for the call k of load_block,
+	  	// it is the maximum across all the processors and it is computed locally from the metadata
 
-	  	//for(size_t i = 0 ; i < n_block.size() ; i++)
-	  	for(size_t i = 0 ; i < rest_block ; i++)
-	  		n_block.get(i) += 1;
+	    openfpm::vector<size_t> blocks;
+	    openfpm::vector<size_t> n_block;
+	  	openfpm::vector<size_t> n_chunk;
 
-	  	size_t start_block = 0;
-	  	size_t stop_block = 0;
+	  	n_block.resize(n_proc);
 
+	  	for (size_t i = 0 ; i < n_proc ; i++)
+	  	{n_block.get(i) = 0;}
 
-	  	if (v_cl.getProcessUnitID() != 0)
+	  	n_chunk.add(0);
+
+	  	for (size_t b = 0 ; b < mpi_size_old ; b++)
 	  	{
-			for(size_t i = 0 ; i < v_cl.getProcessUnitID() ; i++)
-				start_block += n_block.get(i);
+	  		size_t k = n_block.get(owner.get(b))++;
+
+	  		if (k >= n_chunk.size())
+	  		{n_chunk.add(0);}
+
+	  		n_chunk.get(k) = std::max(n_chunk.get(k),h5_n_chunks(metadata_out.get(b),max_io));
+
+	  		if (owner.get(b) == mpi_rank)
+	  		{blocks.add(b);}
 	  	}
 
-	  	stop_block = start_block + n_block.get(v_cl.getProcessUnitID());
+	  	bool ret = true;
 
-	  	if (mpi_rank >= mpi_size_old)
-	  	{load_block(start_block,mpi_size_old,metadata_out,metadata_accum,plist_id,dataset_2,g_m,v_pos,v_prp);}
-	  	else
+	  	if (columns == true)
 	  	{
-	  		size_t n_bl = 0;
-	  		size_t lb = start_block;
-			for ( ; lb < stop_block ; lb++, n_bl++)
-			{load_block(lb,mpi_size_old,metadata_out,metadata_accum,plist_id,dataset_2,g_m,v_pos,v_prp);}
-
-			if (n_bl < max_block)
-			{load_block(-1,mpi_size_old,metadata_out,metadata_accum,plist_id,dataset_2,g_m,v_pos,v_prp);}
+	  		// particles are not bound to blocks, without sub-domains every processor read
+	  		// the same number of particles
+
+	  		openfpm::vector<size_t> offs;
+	  		openfpm::vector<size_t> ns;
+
+	  		if (spatial == false)
+	  		{
+	  			size_t off;
+	  			size_t n;
+
+	  			h5_row_balance((long long int *)metadata_out.getPointer(),mpi_size_old,mpi_rank,n_proc,off,n);
+
+	  			offs.add(off);
+	  			ns.add(n);
+	  		}
+	  		else
+	  		{
+	  			for (size_t k = 0 ; k < blocks.size() ; k++)
+	  			{
+	  				offs.add(metadata_accum.get(blocks.get(k)));
+	  				ns.add(metadata_out.get(blocks.get(k)));
+	  			}
+	  		}
+
+	  		ret = load_columns(file,plist_id,offs,ns,(spatial == true)?n_chunk.size():1,v_pos,v_prp,g_m);
 	  	}
+	  	else
+	  	{ret = load_packed(file,plist_id,metadata_out,metadata_accum,blocks,n_chunk,v_pos,v_prp,g_m);}
 
-	  	// Close open object
-	  	H5Sclose(mem_dataspace_id);
-	  	H5Sclose(file_dataspace_id);
-	    // Close the dataset.
-	    H5Dclose(dataset);
-	    H5Dclose(dataset_2);
 	    // Close the file.
 	    H5Fclose(file);
 	    H5Pclose(plist_id);
 
-	    return true;
+	    return ret;
+	}
+
+	/*! \brief Blocks whose bounding box overlap a region
+	 *
+	 * \param file HDF5 file
+	 * \param mpi_size_old number of blocks
+	 * \param bbox region
+	 * \param blocks blocks overlapping the region (all the blocks if the file does not have the bounding boxes)
+	 *
+	 */
+	template<typename box_type>
+	void overlap_blocks(hid_t file,
+			            size_t mpi_size_old,
+						const box_type & bbox,
+						openfpm::vector<size_t> & blocks)
+	{
+		const unsigned int dim = box_type::dims;
+
+		openfpm::vector<double> bb;
+		bb.resize(2*dim*mpi_size_old);
+
+		hsize_t row_dims[1] = {2*dim};
+
+		bool has_bbox = (H5Lexists(file, "block_bbox", H5P_DEFAULT) > 0 &&
+				         h5_read_rows(file,"block_bbox",H5T_NATIVE_DOUBLE,0,mpi_size_old,1,row_dims,bb.getPointer(),H5P_DEFAULT) == true);
+
+		for (size_t b = 0 ; b < mpi_size_old ; b++)
+		{
+			bool overlap = true;
+
+			for (size_t d = 0 ; has_bbox == true && d < dim ; d++)
+			{overlap &= (bb.get(2*dim*b+d) <= bbox.getHigh(d) && bb.get(2*dim*b+dim+d) >= bbox.getLow(d));}
+
+			if (overlap == true)
+			{blocks.add(b);}
+		}
+	}
+
+	/*! \brief Remove the particles outside a region
+	 *
+	 * \param v_pos positions
+	 * \param v_prp properties
+	 * \param bbox region
+	 *
+	 */
+	template<typename vector_pos_type, typename vector_prp_type, typename box_type>
+	void filter_bbox(vector_pos_type & v_pos,
+			         vector_prp_type & v_prp,
+					 const box_type & bbox)
+	{
+		const unsigned int dim = box_type::dims;
+
+		size_t j = 0;
+
+		for (size_t i = 0 ; i < v_pos.size() ; i++)
+		{
+			bool inside = true;
+
+			for (size_t d = 0 ; d < dim ; d++)
+			{inside &= (bbox.getLow(d) <= v_pos.template get<0>(i)[d] && v_pos.template get<0>(i)[d] <= bbox.getHigh(d));}
+
+			if (inside == false)
+			{continue;}
+
+			if (i != j)
+			{
+				v_pos.set(j,v_pos.get(i));
+				v_prp.set(j,v_prp.get(i));
+			}
+
+			j++;
+		}
+
+		v_pos.resize(j);
+		v_prp.resize(j);
+	}
+
+	/*! \brief Load a subset of the properties of the particles, optionally inside a region
+	 *
+	 * \param filename file
+	 * \param v_pos positions
+	 * \param v_prp properties
+	 * \param g_m number of particles loaded
+	 * \param prp properties to load
+	 * \param bbox region to load (NULL for all the particles distributed like in load)
+	 *
+	 * \return true if the load succeed
+	 *
+	 */
+	template<typename vector_pos_type, typename vector_prp_type, typename box_type> inline bool load_partial_impl(const std::string & filename,
+			                                                               vector_pos_type & v_pos,
+																		   vector_prp_type & v_prp,
+																		   size_t & g_m,
+																		   const openfpm::vector<size_t> & prp,
+																		   const box_type * bbox)
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+		v_pos.clear();
+		v_prp.clear();
+
+		g_m = 0;
+
+		size_t mpi_rank = v_cl.getProcessUnitID();
+		size_t n_proc = v_cl.getProcessingUnits();
+
+	    hid_t file = open_file(filename);
+	    if (file < 0)	{return false;}
+
+	    bool columns = (H5Lexists(file, "position", H5P_DEFAULT) > 0);
+
+	    //Create property list for collective dataset read
+	  	hid_t plist_id = H5Pcreate(H5P_DATASET_XFER);
+	  	if (plist_id == -1)	{return false;}
+
+	  	herr_t err = H5Pset_dxpl_mpio(plist_id, H5FD_MPIO_COLLECTIVE);
+	  	if (err < 0)	{return false;}
+
+		openfpm::vector<long long int> metadata_out;
+	    openfpm::vector<size_t> metadata_accum;
+
+	    if (read_metadata(file,plist_id,metadata_out,metadata_accum) == false)
+	    {
+	    	H5Pclose(plist_id);
+	    	H5Fclose(file);
+	    	return false;
+	    }
+
+	    size_t mpi_size_old = metadata_out.size();
+
+	    // Blocks to read, the region of different processors can overlap so the number
+	    // of collective reads is agreed with a reduction
+
+	    openfpm::vector<size_t> blocks;
+
+	    if (bbox != NULL)
+	    {overlap_blocks(file,mpi_size_old,*bbox,blocks);}
+	    else
+	    {
+	    	openfpm::vector<size_t> first;
+	    	h5_block_balance((long long int *)metadata_out.getPointer(),mpi_size_old,n_proc,first);
+
+	    	for (size_t b = first.get(mpi_rank) ; b < first.get(mpi_rank+1) ; b++)
+	    	{blocks.add(b);}
+	    }
+
+	    size_t n_reads = blocks.size();
+	    v_cl.max(n_reads);
+	    v_cl.execute();
+
+	  	bool ret = true;
+
+	    if (columns == true)
+	    {
+	  		openfpm::vector<size_t> offs;
+	  		openfpm::vector<size_t> ns;
+
+	  		if (bbox == NULL)
+	  		{
+	  			size_t off;
+	  			size_t n;
+
+	  			h5_row_balance((long long int *)metadata_out.getPointer(),mpi_size_old,mpi_rank,n_proc,off,n);
+
+	  			offs.add(off);
+	  			ns.add(n);
+	  			n_reads = 1;
+	  		}
+	  		else
+	  		{
+	  			for (size_t k = 0 ; k < blocks.size() ; k++)
+	  			{
+	  				offs.add(metadata_accum.get(blocks.get(k)));
+	  				ns.add(metadata_out.get(blocks.get(k)));
+	  			}
+	  		}
+
+	  		ret = load_columns(file,plist_id,offs,ns,n_reads,v_pos,v_prp,g_m,&prp);
+	    }
+	    else
+	    {
+	    	// the packed blocks contain all the properties, the ones not requested are reset
+
+	    	size_t n_chunk_max = 0;
+
+	    	for (size_t b = 0 ; b < mpi_size_old ; b++)
+	    	{n_chunk_max = std::max(n_chunk_max,h5_n_chunks(metadata_out.get(b),max_io));}
+
+	    	openfpm::vector<size_t> n_chunk;
+	    	n_chunk.resize((n_reads == 0)?1:n_reads);
+
+	    	for (size_t k = 0 ; k < n_chunk.size() ; k++)
+	    	{n_chunk.get(k) = n_chunk_max;}
+
+	    	ret = load_packed(file,plist_id,metadata_out,metadata_accum,blocks,n_chunk,v_pos,v_prp,g_m);
+
+	    	h5_vd_reset_prp<vector_prp_type> rst(v_prp,&prp,0,v_prp.size());
+	    	boost::mpl::for_each_ref< boost::mpl::range_c<int,0,vector_prp_type::value_type::max_prop> >(rst);
+	    }
+
+	    if (bbox != NULL)
+	    {filter_bbox(v_pos,v_prp,*bbox);}
+
+	    g_m = v_pos.size();
+
+	    H5Fclose(file);
+	    H5Pclose(plist_id);
+
+	    return ret;
 	}
 };
 
@@ -0,0 +1,1676 @@
+/*
+ * HDF5_util.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef OPENFPM_IO_SRC_HDF5_WR_HDF5_UTIL_HPP_
+#define OPENFPM_IO_SRC_HDF5_WR_HDF5_UTIL_HPP_
+
+#include "hdf5.h"
+#include "VCluster/VCluster.hpp"
+#include "util/io_profiler.hpp"
+#include <type_traits>
+#include <iostream>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+
+//! Maximum number of bytes transferred by a single H5Dwrite/H5Dread (MPI-IO count is an int)
+#define HDF5_MAX_IO_BYTES 0x7FFFFFFF
+
+//! Maximum size of a chunk of a compressed dataset
+#define HDF5_MAX_CHUNK_BYTES 67108864
+
+//! Minimum size of a chunk of a compressed dataset
+#define HDF5_MIN_CHUNK_BYTES 65536
+
+//! Alignment of the objects of a large checkpoint when the stripe size is unknown
+#define HDF5_ALIGN_BYTES 1048576
+
+//! Average bytes written by a processor above which the checkpoint is aligned
+#define HDF5_ALIGN_MIN_BYTES 16777216
+
+/*! \brief Tuning of the parallel access to a checkpoint file
+ *
+ * The MPI-IO hints are passed to MPI_File_open (0 keep the default of the MPI library), the
+ * alignment and the metadata block size to the HDF5 file access. Without alignment the objects
+ * are aligned to the stripe (striping_unit) if it is set, otherwise to HDF5_ALIGN_BYTES when the
+ * processors write on average more than HDF5_ALIGN_MIN_BYTES. Without cb_nodes there is one
+ * aggregator for every storage target (striping_factor)
+ *
+ */
+struct h5_io_options
+{
+	//! MPI-IO hint cb_nodes, number of aggregators of the collective buffering
+	int cb_nodes = 0;
+
+	//! MPI-IO hint cb_buffer_size, buffer of every aggregator in bytes
+	size_t cb_buffer_size = 0;
+
+	//! MPI-IO hint striping_factor, number of storage targets of a new file
+	int striping_factor = 0;
+
+	//! MPI-IO hint striping_unit, stripe size of a new file in bytes
+	size_t striping_unit = 0;
+
+	//! alignment of the objects in the file (0 derived from the size, 1 no alignment)
+	hsize_t alignment = 0;
+
+	//! only objects of at least this size are aligned (0 the alignment)
+	hsize_t align_threshold = 0;
+
+	//! minimum size of the blocks allocated for the metadata (0 the alignment, or the HDF5 default)
+	hsize_t meta_block_size = 0;
+
+	//! create and open the objects with collective metadata operations (HDF5 1.10 or later)
+	bool coll_metadata = false;
+};
+
+/*! \brief Create the file access property list of a checkpoint
+ *
+ * \param comm communicator of the processors that access the file
+ * \param opt tuning of the access
+ * \param bytes size of the data written in the file (0 on read)
+ *
+ * \return the file access property list
+ *
+ */
+inline hid_t h5_create_fapl(MPI_Comm comm, const h5_io_options & opt, size_t bytes)
+{
+	int n_proc;
+	MPI_Comm_size(comm,&n_proc);
+
+	// MPI-IO hints
+
+	int cb_nodes = opt.cb_nodes;
+
+	if (cb_nodes == 0 && opt.striping_factor != 0)
+	{cb_nodes = std::min(opt.striping_factor,n_proc);}
+
+	const char * keys[4] = {"cb_nodes","cb_buffer_size","striping_factor","striping_unit"};
+	size_t values[4] = {(size_t)cb_nodes,opt.cb_buffer_size,(size_t)opt.striping_factor,opt.striping_unit};
+
+	MPI_Info info = MPI_INFO_NULL;
+
+	for (size_t k = 0 ; k < 4 ; k++)
+	{
+		if (values[k] == 0)
+		{continue;}
+
+		if (info == MPI_INFO_NULL)
+		{MPI_Info_create(&info);}
+
+		MPI_Info_set(info,(char *)keys[k],(char *)std::to_string(values[k]).c_str());
+	}
+
+	hid_t plist_id = H5Pcreate(H5P_FILE_ACCESS);
+	if (plist_id < 0)	{return -1;}
+	H5Pset_fapl_mpio(plist_id, comm, info);
+
+	if (info != MPI_INFO_NULL)
+	{MPI_Info_free(&info);}
+
+	// alignment of the objects and of the metadata blocks
+
+	hsize_t alignment = opt.alignment;
+
+	if (alignment == 0)
+	{
+		if (opt.striping_unit != 0)
+		{alignment = opt.striping_unit;}
+		else
+		{alignment = (bytes / n_proc > HDF5_ALIGN_MIN_BYTES)?HDF5_ALIGN_BYTES:1;}
+	}
+
+	if (alignment > 1)
+	{H5Pset_alignment(plist_id, (opt.align_threshold == 0)?alignment:opt.align_threshold, alignment);}
+
+	if (opt.meta_block_size != 0 || alignment > 1)
+	{H5Pset_meta_block_size(plist_id, (opt.meta_block_size == 0)?alignment:opt.meta_block_size);}
+
+#if H5_VERSION_GE(1,10,0)
+
+	if (opt.coll_metadata == true)
+	{
+		H5Pset_all_coll_metadata_ops(plist_id, true);
+		H5Pset_coll_metadata_write(plist_id, true);
+	}
+
+#endif
+
+	return plist_id;
+}
+
+/*! \brief Compression of the checkpoint datasets
+ *
+ * Compressed datasets are chunked, in parallel they require HDF5 1.10.2 or later
+ *
+ */
+struct h5_compression
+{
+	//! deflate level (0 no compression, 1-9)
+	int level;
+
+	//! apply the shuffle filter before deflate
+	bool shuffle;
+
+	/*! \brief Constructor
+	 *
+	 * \param level deflate level (0 no compression, 1-9)
+	 * \param shuffle apply the shuffle filter before deflate
+	 *
+	 */
+	h5_compression(int level = 0, bool shuffle = true)
+	:level(level),shuffle(shuffle)
+	{}
+};
+
+/*! \brief Rows of a chunk for a dataset written in blocks by the processors
+ *
+ * The chunk is the greatest common divisor of the blocks, so that the chunks never cross the
+ * boundary between two processors. If it is smaller than HDF5_MIN_CHUNK_BYTES the chunk is the
+ * biggest block. In both cases it is limited to max_chunk_bytes (for the gcd to a divisor of it)
+ *
+ * \param blocks rows written by every processor
+ * \param row_bytes bytes of a row
+ * \param max_chunk_bytes maximum size of a chunk
+ *
+ * \return the number of rows of a chunk (0 if all the blocks are empty)
+ *
+ */
+inline size_t h5_chunk_rows(const openfpm::vector<size_t> & blocks, size_t row_bytes, size_t max_chunk_bytes = HDF5_MAX_CHUNK_BYTES)
+{
+	size_t g = 0;
+	size_t mx = 0;
+
+	for (size_t i = 0 ; i < blocks.size() ; i++)
+	{
+		size_t a = blocks.get(i);
+		size_t b = g;
+
+		while (b != 0)
+		{
+			size_t t = a % b;
+			a = b;
+			b = t;
+		}
+
+		g = a;
+		mx = std::max(mx,blocks.get(i));
+	}
+
+	if (g == 0)
+	{return 0;}
+
+	size_t max_rows = std::max(max_chunk_bytes / row_bytes,(size_t)1);
+
+	if (g * row_bytes >= HDF5_MIN_CHUNK_BYTES)
+	{
+		// smallest split of g that fit max_rows and keep the alignment
+
+		for (size_t d = (g + max_rows - 1) / max_rows ; (g / d) * row_bytes >= HDF5_MIN_CHUNK_BYTES ; d++)
+		{
+			if (g % d == 0)
+			{return g / d;}
+		}
+	}
+
+	return std::min(mx,max_rows);
+}
+
+/*! \brief Dataset creation property list for a compressed dataset of rows
+ *
+ * \param cmp compression
+ * \param tot number of rows of the dataset
+ * \param row_rank number of dimensions of a row
+ * \param row_dims dimensions of a row
+ * \param row_bytes bytes of a row
+ * \param blocks rows written by every processor
+ *
+ * \return the property list (H5P_DEFAULT if the dataset is not compressed), close it with h5_close_dcpl
+ *
+ */
+inline hid_t h5_compression_dcpl(const h5_compression & cmp, hsize_t tot, unsigned int row_rank, const hsize_t * row_dims,
+		                         size_t row_bytes, const openfpm::vector<size_t> & blocks)
+{
+	if (cmp.level <= 0 || tot == 0)
+	{return H5P_DEFAULT;}
+
+#if defined(H5_HAVE_PARALLEL) && !H5_VERSION_GE(1,10,2)
+
+	// parallel writes to filtered datasets are supported from 1.10.2
+
+	if (blocks.size() > 1)
+	{
+		std::cerr << __FILE__ << ":" << __LINE__ << " Warning: compression in parallel require HDF5 1.10.2 or later, the dataset is not compressed" << std::endl;
+		return H5P_DEFAULT;
+	}
+
+#endif
+
+	if (H5Zfilter_avail(H5Z_FILTER_DEFLATE) <= 0)
+	{
+		std::cerr << __FILE__ << ":" << __LINE__ << " Warning: the deflate filter is not available, the dataset is not compressed" << std::endl;
+		return H5P_DEFAULT;
+	}
+
+	hsize_t chunk[H5S_MAX_RANK];
+	chunk[0] = std::min((hsize_t)h5_chunk_rows(blocks,row_bytes),tot);
+
+	for (size_t i = 0 ; i < row_rank ; i++)
+	{chunk[i+1] = row_dims[i];}
+
+	hid_t dcpl_id = H5Pcreate(H5P_DATASET_CREATE);
+	H5Pset_chunk(dcpl_id, row_rank+1, chunk);
+
+	if (cmp.shuffle == true)
+	{H5Pset_shuffle(dcpl_id);}
+
+	H5Pset_deflate(dcpl_id, std::min(cmp.level,9));
+
+	// every chunk is written, there is no need to fill it
+	H5Pset_fill_time(dcpl_id, H5D_FILL_TIME_NEVER);
+
+	return dcpl_id;
+}
+
+/*! \brief Close a property list created by h5_compression_dcpl
+ *
+ * \param dcpl_id property list
+ *
+ */
+inline void h5_close_dcpl(hid_t dcpl_id)
+{
+	if (dcpl_id != H5P_DEFAULT)
+	{H5Pclose(dcpl_id);}
+}
+
+/*! \brief Return the native HDF5 type equivalent to T
+ *
+ * The returned type is a copy and must be released with H5Tclose. Arrays are not
+ * mapped here, they are stored as extra dimensions of the dataset (see h5_prop_rows)
+ *
+ * \tparam T type (unsupported types has valid = false)
+ *
+ */
+template<typename T, bool is_arith = std::is_arithmetic<T>::value>
+struct h5_type
+{
+	//! T cannot be stored in a typed dataset
+	static const bool valid = false;
+
+	/*! \brief Create the HDF5 type
+	 *
+	 * \return -1
+	 *
+	 */
+	static hid_t create()
+	{
+		return -1;
+	}
+};
+
+//! Scalar types
+template<typename T>
+struct h5_type<T,true>
+{
+	//! T can be stored in a typed dataset
+	static const bool valid = true;
+
+	/*! \brief Create the HDF5 type
+	 *
+	 * \return the HDF5 type
+	 *
+	 */
+	static hid_t create()
+	{
+		if (std::is_same<T,float>::value)
+		{return H5Tcopy(H5T_NATIVE_FLOAT);}
+		else if (std::is_same<T,double>::value)
+		{return H5Tcopy(H5T_NATIVE_DOUBLE);}
+		else if (std::is_same<T,long double>::value)
+		{return H5Tcopy(H5T_NATIVE_LDOUBLE);}
+		else if (std::is_same<T,bool>::value && sizeof(bool) == 1)
+		{return H5Tcopy(H5T_NATIVE_UCHAR);}
+		else if (std::is_floating_point<T>::value)
+		{return -1;}
+
+		// integers are selected by size and sign
+
+		bool sig = std::is_signed<T>::value;
+
+		if (sizeof(T) == 1)
+		{return H5Tcopy((sig)?H5T_NATIVE_SCHAR:H5T_NATIVE_UCHAR);}
+		else if (sizeof(T) == 2)
+		{return H5Tcopy((sig)?H5T_NATIVE_INT16:H5T_NATIVE_UINT16);}
+		else if (sizeof(T) == 4)
+		{return H5Tcopy((sig)?H5T_NATIVE_INT32:H5T_NATIVE_UINT32);}
+		else if (sizeof(T) == 8)
+		{return H5Tcopy((sig)?H5T_NATIVE_INT64:H5T_NATIVE_UINT64);}
+
+		return -1;
+	}
+};
+
+/*! \brief Dimensions of an array type T[N][M]...
+ *
+ * rank is the number of extents, get fill the extents (nothing for a scalar)
+ *
+ * \tparam T type
+ *
+ */
+template<typename T>
+struct h5_array_dims
+{
+	//! number of extents
+	static const unsigned int rank = 0;
+
+	/*! \brief Fill the extents
+	 *
+	 * \param d extents
+	 *
+	 */
+	static void get(hsize_t * d)
+	{}
+};
+
+//! Arrays
+template<typename T, size_t N>
+struct h5_array_dims<T[N]>
+{
+	//! number of extents
+	static const unsigned int rank = 1 + h5_array_dims<T>::rank;
+
+	/*! \brief Fill the extents
+	 *
+	 * \param d extents
+	 *
+	 */
+	static void get(hsize_t * d)
+	{
+		d[0] = N;
+		h5_array_dims<T>::get(d+1);
+	}
+};
+
+/*! \brief Number of transfers needed to move n bytes
+ *
+ * \param n bytes
+ * \param max_io maximum bytes for a single transfer
+ *
+ * \return the number of transfers
+ *
+ */
+inline size_t h5_n_chunks(size_t n, size_t max_io = HDF5_MAX_IO_BYTES)
+{
+	return (n + max_io - 1) / max_io;
+}
+
+/*! \brief Number of transfers needed to move n rows of row_bytes bytes, in chunks of at most max_io bytes
+ *
+ * With a collective transfer all the processors must do the same number of transfers, so the
+ * maximum across the processors is returned (all the processors must call it). With an
+ * independent transfer (or H5P_DEFAULT) the number of transfers of this processor is returned
+ *
+ * \param n rows of this processor
+ * \param row_bytes bytes of a row
+ * \param plist_id transfer property list
+ * \param max_io maximum bytes for a single transfer
+ * \param chunk_rows output rows in a transfer
+ *
+ * \return the number of transfers
+ *
+ */
+inline size_t h5_n_chunks_rows(size_t n, size_t row_bytes, hid_t plist_id, size_t max_io, size_t & chunk_rows)
+{
+	chunk_rows = std::max(max_io / std::max(row_bytes,(size_t)1),(size_t)1);
+	size_t n_chunk = h5_n_chunks(n,chunk_rows);
+
+	H5FD_mpio_xfer_t mode = H5FD_MPIO_INDEPENDENT;
+
+	if (plist_id != H5P_DEFAULT)
+	{H5Pget_dxpl_mpio(plist_id,&mode);}
+
+	if (mode == H5FD_MPIO_COLLECTIVE)
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+		v_cl.max(n_chunk);
+		v_cl.execute();
+	}
+
+	return n_chunk;
+}
+
+/*! \brief Create a dataspace of tot rows, every row has the dimensions row_dims and select the rows [off,off+n)
+ *
+ * If n == 0 nothing is selected. With mem_stride != 0 the rows in memory are not contiguous,
+ * the row i start mem_stride elements after the row i-1 (for example a property inside an
+ * array of structures), the memory dataspace select the rows directly in the user buffer
+ *
+ * \param tot number of rows
+ * \param off first row to select
+ * \param n number of rows to select
+ * \param row_rank number of dimensions of a row
+ * \param row_dims dimensions of a row
+ * \param mem_dataspace_id output memory dataspace (n rows)
+ * \param mem_stride distance in elements between two rows in memory (0 contiguous rows)
+ *
+ * \return the file dataspace
+ *
+ */
+inline hid_t h5_rows_dataspace(hsize_t tot, hsize_t off, hsize_t n, unsigned int row_rank, const hsize_t * row_dims, hid_t & mem_dataspace_id,
+		                       hsize_t mem_stride = 0)
+{
+	hsize_t fdim[H5S_MAX_RANK];
+	hsize_t mdim[H5S_MAX_RANK];
+	hsize_t offset[H5S_MAX_RANK];
+	hsize_t count[H5S_MAX_RANK];
+
+	fdim[0] = tot;
+	mdim[0] = (n == 0)?1:n;
+	offset[0] = off;
+	count[0] = n;
+
+	for (size_t i = 0 ; i < row_rank ; i++)
+	{
+		fdim[i+1] = row_dims[i];
+		mdim[i+1] = row_dims[i];
+		offset[i+1] = 0;
+		count[i+1] = row_dims[i];
+	}
+
+	hid_t file_dataspace_id = H5Screate_simple(row_rank+1, fdim, NULL);
+
+	if (mem_stride == 0 || n == 0)
+	{mem_dataspace_id = H5Screate_simple(row_rank+1, mdim, NULL);}
+	else
+	{
+		// the rows are blocks of row_elem elements every mem_stride elements
+
+		hsize_t row_elem = 1;
+		for (size_t i = 0 ; i < row_rank ; i++)
+		{row_elem *= row_dims[i];}
+
+		hsize_t mdim1[1] = {(n-1)*mem_stride + row_elem};
+		hsize_t mstart[1] = {0};
+		hsize_t mstride[1] = {mem_stride};
+		hsize_t mcount[1] = {n};
+		hsize_t mblock[1] = {row_elem};
+
+		mem_dataspace_id = H5Screate_simple(1, mdim1, NULL);
+		H5Sselect_hyperslab(mem_dataspace_id, H5S_SELECT_SET, mstart, mstride, mcount, mblock);
+	}
+
+	if (n == 0)
+	{
+		H5Sselect_none(file_dataspace_id);
+		H5Sselect_none(mem_dataspace_id);
+	}
+	else
+	{H5Sselect_hyperslab(file_dataspace_id, H5S_SELECT_SET, offset, NULL, count, NULL);}
+
+	return file_dataspace_id;
+}
+
+/*! \brief Collectively write a dataset of rows, every processor write the rows [off,off+n)
+ *
+ * Processors with n == 0 participate in the collective write with an empty selection. The rows
+ * are written in transfers of at most max_io bytes, with a collective transfer all the processors
+ * do the same number of transfers (the processors that have less rows write empty selections)
+ *
+ * \param file HDF5 file
+ * \param name dataset name
+ * \param type HDF5 type of the elements
+ * \param tot total number of rows in the dataset
+ * \param off first row of this processor
+ * \param n number of rows of this processor
+ * \param row_rank number of dimensions of a row (0 for a 1D dataset)
+ * \param row_dims dimensions of a row
+ * \param ptr data
+ * \param plist_id transfer property list
+ * \param cmp compression
+ * \param blocks rows written by every processor (required to compress)
+ * \param mem_stride distance in elements between two rows in ptr (0 contiguous rows)
+ * \param max_io maximum bytes for a single transfer
+ *
+ * \return true if the write succeed
+ *
+ */
+inline bool h5_write_rows(hid_t file, const std::string & name, hid_t type, hsize_t tot, hsize_t off, hsize_t n,
+		                  unsigned int row_rank, const hsize_t * row_dims, const void * ptr, hid_t plist_id,
+						  const h5_compression & cmp = h5_compression(), const openfpm::vector<size_t> * blocks = NULL,
+						  hsize_t mem_stride = 0, size_t max_io = HDF5_MAX_IO_BYTES)
+{
+	size_t elem_bytes = H5Tget_size(type);
+	size_t row_elem = 1;
+
+	for (size_t i = 0 ; i < row_rank ; i++)
+	{row_elem *= row_dims[i];}
+
+	size_t chunk_rows;
+	size_t n_chunk = h5_n_chunks_rows(n,row_elem*elem_bytes,plist_id,max_io,chunk_rows);
+
+	hsize_t fdim[H5S_MAX_RANK];
+	fdim[0] = tot;
+
+	for (size_t i = 0 ; i < row_rank ; i++)
+	{fdim[i+1] = row_dims[i];}
+
+	hid_t file_dataspace_id = H5Screate_simple(row_rank+1, fdim, NULL);
+
+	hid_t dcpl_id = H5P_DEFAULT;
+
+	if (blocks != NULL)
+	{dcpl_id = h5_compression_dcpl(cmp,tot,row_rank,row_dims,row_elem*elem_bytes,*blocks);}
+
+	hid_t file_dataset = H5Dcreate (file, name.c_str(), type, file_dataspace_id, H5P_DEFAULT, dcpl_id, H5P_DEFAULT);
+	h5_close_dcpl(dcpl_id);
+	H5Sclose(file_dataspace_id);
+
+	if (file_dataset < 0)
+	{
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error: cannot create the dataset " << name << std::endl;
+		return false;
+	}
+
+	size_t mem_row = (mem_stride == 0)?row_elem:mem_stride;
+	bool ret = true;
+
+	for (size_t c = 0 ; c < n_chunk ; c++)
+	{
+		size_t coff = std::min(c*chunk_rows,(size_t)n);
+		size_t cn = std::min((size_t)n - coff,chunk_rows);
+
+		hid_t mem_dataspace_id;
+		file_dataspace_id = h5_rows_dataspace(tot,off+coff,cn,row_rank,row_dims,mem_dataspace_id,mem_stride);
+
+		ret &= H5Dwrite(file_dataset, type, mem_dataspace_id, file_dataspace_id, plist_id, (const char *)ptr + coff*mem_row*elem_bytes) >= 0;
+
+		H5Sclose(mem_dataspace_id);
+		H5Sclose(file_dataspace_id);
+	}
+
+	H5Dclose(file_dataset);
+
+	return ret;
+}
+
+/*! \brief Collectively read the rows [off,off+n) of a dataset of rows
+ *
+ * The rows are read in transfers of at most max_io bytes, with a collective transfer all the
+ * processors do the same number of transfers (the processors that have less rows read empty selections)
+ *
+ * \param file HDF5 file
+ * \param name dataset name
+ * \param type HDF5 type of the elements in memory
+ * \param off first row to read
+ * \param n number of rows to read
+ * \param row_rank number of dimensions of a row (0 for a 1D dataset)
+ * \param row_dims dimensions of a row
+ * \param ptr where to store the data
+ * \param plist_id transfer property list
+ * \param mem_stride distance in elements between two rows in ptr (0 contiguous rows)
+ * \param max_io maximum bytes for a single transfer
+ *
+ * \return false if the dataset does not exist, has a different shape or element size or the read fail
+ *
+ */
+inline bool h5_read_rows(hid_t file, const std::string & name, hid_t type, hsize_t off, hsize_t n,
+		                 unsigned int row_rank, const hsize_t * row_dims, void * ptr, hid_t plist_id,
+						 hsize_t mem_stride = 0, size_t max_io = HDF5_MAX_IO_BYTES)
+{
+	if (H5Lexists(file, name.c_str(), H5P_DEFAULT) <= 0)
+	{return false;}
+
+	hid_t dataset = H5Dopen (file, name.c_str(), H5P_DEFAULT);
+	if (dataset < 0)	{return false;}
+
+	// check the element size and the shape
+
+	hid_t ftype = H5Dget_type(dataset);
+	bool match = (H5Tget_size(ftype) == H5Tget_size(type));
+	H5Tclose(ftype);
+
+	hid_t fspace = H5Dget_space(dataset);
+	hsize_t fdim[H5S_MAX_RANK];
+	int rank = H5Sget_simple_extent_dims(fspace,fdim,NULL);
+	H5Sclose(fspace);
+
+	match &= (rank == (int)row_rank + 1);
+
+	for (size_t i = 0 ; match == true && i < row_rank ; i++)
+	{match &= (fdim[i+1] == row_dims[i]);}
+
+	if (match == false)
+	{
+		H5Dclose(dataset);
+		return false;
+	}
+
+	size_t elem_bytes = H5Tget_size(type);
+	size_t row_elem = 1;
+
+	for (size_t i = 0 ; i < row_rank ; i++)
+	{row_elem *= row_dims[i];}
+
+	size_t chunk_rows;
+	size_t n_chunk = h5_n_chunks_rows(n,row_elem*elem_bytes,plist_id,max_io,chunk_rows);
+
+	size_t mem_row = (mem_stride == 0)?row_elem:mem_stride;
+	bool ret = true;
+
+	for (size_t c = 0 ; c < n_chunk ; c++)
+	{
+		size_t coff = std::min(c*chunk_rows,(size_t)n);
+		size_t cn = std::min((size_t)n - coff,chunk_rows);
+
+		hid_t mem_dataspace_id;
+		hid_t file_dataspace_id = h5_rows_dataspace(fdim[0],off+coff,cn,row_rank,row_dims,mem_dataspace_id,mem_stride);
+
+		ret &= H5Dread(dataset, type, mem_dataspace_id, file_dataspace_id, plist_id, (char *)ptr + coff*mem_row*elem_bytes) >= 0;
+
+		H5Sclose(mem_dataspace_id);
+		H5Sclose(file_dataspace_id);
+	}
+
+	H5Dclose(dataset);
+
+	return ret;
+}
+
+/*! \brief Collectively write a 1D dataset, every processor write n elements starting from off
+ *
+ * Processors with n == 0 participate in the collective write with an empty selection
+ *
+ * \param file HDF5 file
+ * \param name dataset name
+ * \param type HDF5 type of the elements
+ * \param tot total number of elements in the dataset
+ * \param off offset of the elements of this processor
+ * \param n number of elements of this processor
+ * \param ptr data
+ * \param plist_id transfer property list
+ * \param cmp compression
+ * \param blocks elements written by every processor (required to compress)
+ *
+ * \return true if the write succeed
+ *
+ */
+inline bool h5_write_1d(hid_t file, const std::string & name, hid_t type, hsize_t tot, hsize_t off, hsize_t n, const void * ptr, hid_t plist_id,
+		                const h5_compression & cmp = h5_compression(), const openfpm::vector<size_t> * blocks = NULL)
+{
+	return h5_write_rows(file,name,type,tot,off,n,0,NULL,ptr,plist_id,cmp,blocks);
+}
+
+/*! \brief Collectively read n elements starting from off from a 1D dataset
+ *
+ * \param file HDF5 file
+ * \param name dataset name
+ * \param type HDF5 type of the elements in memory
+ * \param off offset of the elements to read
+ * \param n number of elements to read
+ * \param ptr where to store the data
+ * \param plist_id transfer property list
+ *
+ * \return false if the dataset does not exist, has a different element size or the read fail
+ *
+ */
+inline bool h5_read_1d(hid_t file, const std::string & name, hid_t type, hsize_t off, hsize_t n, void * ptr, hid_t plist_id)
+{
+	return h5_read_rows(file,name,type,off,n,0,NULL,ptr,plist_id);
+}
+
+/*! \brief Create the dataspace of a property of a global N-D grid
+ *
+ * The dataset has the dimensions of the grid in reverse order followed by the extents of
+ * the property, so the last dimension of the dataset is x and a box copied from a grid
+ * with x as fastest index (like grid_sm) is contiguous in the dataset
+ *
+ * \param dim dimensionality of the grid
+ * \param gsz size of the grid
+ * \param prp_rank number of extents of the property (0 for a scalar)
+ * \param prp_dims extents of the property
+ *
+ * \return the dataspace
+ *
+ */
+inline hid_t h5_grid_dataspace(unsigned int dim, const hsize_t * gsz, unsigned int prp_rank, const hsize_t * prp_dims)
+{
+	hsize_t fdim[H5S_MAX_RANK];
+
+	for (size_t i = 0 ; i < dim ; i++)
+	{fdim[i] = gsz[dim-1-i];}
+
+	for (size_t i = 0 ; i < prp_rank ; i++)
+	{fdim[dim+i] = prp_dims[i];}
+
+	return H5Screate_simple(dim+prp_rank, fdim, NULL);
+}
+
+/*! \brief Create the dataspace of a property of a global N-D grid and select a box
+ *
+ * The memory dataspace is the box stored contiguously with x as fastest index. If the box
+ * is empty nothing is selected, so the processor can participate to a collective transfer
+ *
+ * \param dim dimensionality of the grid
+ * \param gsz size of the grid
+ * \param low first point of the box in global grid coordinates
+ * \param sz size of the box
+ * \param prp_rank number of extents of the property (0 for a scalar)
+ * \param prp_dims extents of the property
+ * \param mem_dataspace_id output memory dataspace
+ *
+ * \return the file dataspace
+ *
+ */
+inline hid_t h5_grid_box_dataspace(unsigned int dim, const hsize_t * gsz, const hsize_t * low, const hsize_t * sz,
+		                           unsigned int prp_rank, const hsize_t * prp_dims, hid_t & mem_dataspace_id)
+{
+	hsize_t mdim[H5S_MAX_RANK];
+	hsize_t offset[H5S_MAX_RANK];
+
+	bool empty = false;
+
+	for (size_t i = 0 ; i < dim ; i++)
+	{
+		mdim[i] = sz[dim-1-i];
+		offset[i] = low[dim-1-i];
+		empty |= (sz[i] == 0);
+	}
+
+	for (size_t i = 0 ; i < prp_rank ; i++)
+	{
+		mdim[dim+i] = prp_dims[i];
+		offset[dim+i] = 0;
+	}
+
+	hid_t file_dataspace_id = h5_grid_dataspace(dim,gsz,prp_rank,prp_dims);
+
+	if (empty == true)
+	{
+		hsize_t one[1] = {1};
+		mem_dataspace_id = H5Screate_simple(1, one, NULL);
+
+		H5Sselect_none(file_dataspace_id);
+		H5Sselect_none(mem_dataspace_id);
+	}
+	else
+	{
+		mem_dataspace_id = H5Screate_simple(dim+prp_rank, mdim, NULL);
+		H5Sselect_hyperslab(file_dataspace_id, H5S_SELECT_SET, offset, NULL, mdim, NULL);
+	}
+
+	return file_dataspace_id;
+}
+
+/*! \brief Domain of a local grid in global grid coordinates (Dbox shifted by origin)
+ *
+ * \tparam gboxes_type GBoxes of the local grid
+ *
+ * \param gb boxes of the local grid
+ * \param dim dimensionality
+ * \param low first point of the domain in global grid coordinates
+ * \param sz size of the domain (0 for an empty domain)
+ *
+ * \return the number of points of the domain
+ *
+ */
+template<typename gboxes_type>
+inline size_t h5_grid_domain(const gboxes_type & gb, unsigned int dim, hsize_t * low, hsize_t * sz)
+{
+	size_t n = 1;
+
+	for (size_t d = 0 ; d < dim ; d++)
+	{
+		long int l = gb.Dbox.getLow(d);
+		long int h = gb.Dbox.getHigh(d);
+
+		low[d] = (h < l)?0:gb.origin.get(d) + l;
+		sz[d] = (h < l)?0:h - l + 1;
+		n *= sz[d];
+	}
+
+	return n;
+}
+
+/*! \brief Write or read a property as a dataset with one row for every element
+ *
+ * A property T[N][M] become a dataset of dimensions {elements,N,M} of the native type of T.
+ * Properties that cannot be mapped (for example strings or vectors) are not written and not read
+ *
+ * \tparam ptype property type
+ * \tparam valid true if ptype can be mapped
+ *
+ */
+template<typename ptype, bool valid = h5_type<typename std::remove_all_extents<ptype>::type>::valid && std::is_trivially_copyable<ptype>::value>
+struct h5_prop_rows
+{
+	//! the property cannot be stored in a typed dataset
+	static const bool is_valid = false;
+
+	/*! \brief Write the property
+	 *
+	 * \param file HDF5 file
+	 * \param name dataset name
+	 * \param tot total number of elements
+	 * \param off offset of this processor
+	 * \param n number of elements of this processor
+	 * \param get function returning a pointer to the property of the element i
+	 * \param plist_id transfer property list
+	 * \param cmp compression
+	 * \param blocks elements written by every processor (required to compress)
+	 * \param max_io maximum bytes for a single transfer
+	 *
+	 * \return false
+	 *
+	 */
+	template<typename F> static bool write(hid_t file, const std::string & name, hsize_t tot, hsize_t off, size_t n, F get, hid_t plist_id,
+			                               const h5_compression & cmp = h5_compression(), const openfpm::vector<size_t> * blocks = NULL,
+			                               size_t max_io = HDF5_MAX_IO_BYTES)
+	{
+		return false;
+	}
+
+	/*! \brief Read the property
+	 *
+	 * \param file HDF5 file
+	 * \param name dataset name
+	 * \param off offset of the first element to read
+	 * \param n number of elements to read
+	 * \param get function returning a pointer to the property of the element i
+	 * \param plist_id transfer property list
+	 * \param max_io maximum bytes for a single transfer
+	 *
+	 * \return false
+	 *
+	 */
+	template<typename F> static bool read(hid_t file, const std::string & name, hsize_t off, size_t n, F get, hid_t plist_id,
+			                              size_t max_io = HDF5_MAX_IO_BYTES)
+	{
+		return false;
+	}
+
+	//! The property cannot be written
+	static bool write_strided(hid_t file, const std::string & name, hsize_t tot, hsize_t off, size_t n, const void * base, size_t stride, hid_t plist_id,
+			                  const h5_compression & cmp = h5_compression(), const openfpm::vector<size_t> * blocks = NULL,
+			                  size_t max_io = HDF5_MAX_IO_BYTES)
+	{
+		return false;
+	}
+
+	//! The property cannot be read
+	static bool read_strided(hid_t file, const std::string & name, hsize_t off, size_t n, void * base, size_t stride, hid_t plist_id,
+			                 size_t max_io = HDF5_MAX_IO_BYTES)
+	{
+		return false;
+	}
+};
+
+//! Write or read the property
+template<typename ptype>
+struct h5_prop_rows<ptype,true>
+{
+	//! the property can be stored in a typed dataset
+	static const bool is_valid = true;
+
+	/*! \brief Write the property
+	 *
+	 * \param file HDF5 file
+	 * \param name dataset name
+	 * \param tot total number of elements
+	 * \param off offset of this processor
+	 * \param n number of elements of this processor
+	 * \param get function returning a pointer to the property of the element i
+	 * \param plist_id transfer property list
+	 * \param cmp compression
+	 * \param blocks elements written by every processor (required to compress)
+	 * \param max_io maximum bytes for a single transfer
+	 *
+	 * \return true if the write succeed
+	 *
+	 */
+	template<typename F> static bool write(hid_t file, const std::string & name, hsize_t tot, hsize_t off, size_t n, F get, hid_t plist_id,
+			                               const h5_compression & cmp = h5_compression(), const openfpm::vector<size_t> * blocks = NULL,
+			                               size_t max_io = HDF5_MAX_IO_BYTES)
+	{
+		std::vector<char> buf(n*sizeof(ptype));
+
+		for (size_t i = 0 ; i < n ; i++)
+		{memcpy(&buf[i*sizeof(ptype)],get(i),sizeof(ptype));}
+
+		hsize_t row_dims[H5S_MAX_RANK];
+		h5_array_dims<ptype>::get(row_dims);
+
+		hid_t tp = h5_type<typename std::remove_all_extents<ptype>::type>::create();
+		bool ret = h5_write_rows(file,name,tp,tot,off,n,h5_array_dims<ptype>::rank,row_dims,buf.data(),plist_id,cmp,blocks,0,max_io);
+		H5Tclose(tp);
+
+		return ret;
+	}
+
+	/*! \brief Read the property
+	 *
+	 * \param file HDF5 file
+	 * \param name dataset name
+	 * \param off offset of the first element to read
+	 * \param n number of elements to read
+	 * \param get function returning a pointer to the property of the element i
+	 * \param plist_id transfer property list
+	 * \param max_io maximum bytes for a single transfer
+	 *
+	 * \return false if the dataset does not exist or does not match the property
+	 *
+	 */
+	template<typename F> static bool read(hid_t file, const std::string & name, hsize_t off, size_t n, F get, hid_t plist_id,
+			                              size_t max_io = HDF5_MAX_IO_BYTES)
+	{
+		std::vector<char> buf(n*sizeof(ptype));
+
+		hsize_t row_dims[H5S_MAX_RANK];
+		h5_array_dims<ptype>::get(row_dims);
+
+		hid_t tp = h5_type<typename std::remove_all_extents<ptype>::type>::create();
+		bool ret = h5_read_rows(file,name,tp,off,n,h5_array_dims<ptype>::rank,row_dims,buf.data(),plist_id,0,max_io);
+		H5Tclose(tp);
+
+		if (ret == false)
+		{return false;}
+
+		for (size_t i = 0 ; i < n ; i++)
+		{memcpy(get(i),&buf[i*sizeof(ptype)],sizeof(ptype));}
+
+		return true;
+	}
+
+	/*! \brief Stride in elements of the base type, 0 if the rows cannot be selected in place
+	 *
+	 * \param stride distance in bytes between two properties in memory
+	 *
+	 */
+	static hsize_t elem_stride(size_t stride)
+	{
+		typedef typename std::remove_all_extents<ptype>::type btype;
+
+		if (stride < sizeof(ptype) || stride % sizeof(btype) != 0)
+		{return 0;}
+
+		return stride / sizeof(btype);
+	}
+
+	/*! \brief Write the property directly from the memory of the vector (no copy)
+	 *
+	 * The property of the element i is at base + i*stride (an array of structures or a
+	 * structure of arrays), the rows are selected in place with a strided memory dataspace.
+	 * If the stride is not a multiple of the element size the property is copied like in write
+	 *
+	 * \param file HDF5 file
+	 * \param name dataset name
+	 * \param tot total number of elements
+	 * \param off offset of this processor
+	 * \param n number of elements of this processor
+	 * \param base pointer to the property of the first element
+	 * \param stride distance in bytes between the properties of two consecutive elements
+	 * \param plist_id transfer property list
+	 * \param cmp compression
+	 * \param blocks elements written by every processor (required to compress)
+	 * \param max_io maximum bytes for a single transfer
+	 *
+	 * \return true if the write succeed
+	 *
+	 */
+	static bool write_strided(hid_t file, const std::string & name, hsize_t tot, hsize_t off, size_t n, const void * base, size_t stride, hid_t plist_id,
+			                  const h5_compression & cmp = h5_compression(), const openfpm::vector<size_t> * blocks = NULL,
+			                  size_t max_io = HDF5_MAX_IO_BYTES)
+	{
+		hsize_t mem_stride = elem_stride(stride);
+
+		if (n != 0 && mem_stride == 0)
+		{return write(file,name,tot,off,n,[&](size_t i){return (const void *)((const char *)base + i*stride);},plist_id,cmp,blocks,max_io);}
+
+		hsize_t row_dims[H5S_MAX_RANK];
+		h5_array_dims<ptype>::get(row_dims);
+
+		hid_t tp = h5_type<typename std::remove_all_extents<ptype>::type>::create();
+		bool ret = h5_write_rows(file,name,tp,tot,off,n,h5_array_dims<ptype>::rank,row_dims,base,plist_id,cmp,blocks,mem_stride,max_io);
+		H5Tclose(tp);
+
+		return ret;
+	}
+
+	/*! \brief Read the property directly in the memory of the vector (no copy)
+	 *
+	 * \param file HDF5 file
+	 * \param name dataset name
+	 * \param off offset of the first element to read
+	 * \param n number of elements to read
+	 * \param base pointer to the property of the first element
+	 * \param stride distance in bytes between the properties of two consecutive elements
+	 * \param plist_id transfer property list
+	 * \param max_io maximum bytes for a single transfer
+	 *
+	 * \return false if the dataset does not exist or does not match the property
+	 *
+	 */
+	static bool read_strided(hid_t file, const std::string & name, hsize_t off, size_t n, void * base, size_t stride, hid_t plist_id,
+			                 size_t max_io = HDF5_MAX_IO_BYTES)
+	{
+		hsize_t mem_stride = elem_stride(stride);
+
+		if (n != 0 && mem_stride == 0)
+		{return read(file,name,off,n,[&](size_t i){return (void *)((char *)base + i*stride);},plist_id,max_io);}
+
+		hsize_t row_dims[H5S_MAX_RANK];
+		h5_array_dims<ptype>::get(row_dims);
+
+		hid_t tp = h5_type<typename std::remove_all_extents<ptype>::type>::create();
+		bool ret = h5_read_rows(file,name,tp,off,n,h5_array_dims<ptype>::rank,row_dims,base,plist_id,mem_stride,max_io);
+		H5Tclose(tp);
+
+		return ret;
+	}
+};
+
+/*! \brief Blocks saved by the old processors assigned to this processor on restart
+ *
+ * The mpi_size_old blocks are split in contiguous ranges, the first mpi_size_old % n_proc
+ * processors get one block more
+ *
+ * \param mpi_size_old number of blocks (processors that saved the file)
+ * \param rank this processor
+ * \param n_proc number of processors
+ * \param start_block first block
+ * \param stop_block one after the last block
+ *
+ */
+inline void h5_block_range(size_t mpi_size_old, size_t rank, size_t n_proc, size_t & start_block, size_t & stop_block)
+{
+	start_block = 0;
+
+	for(size_t i = 0 ; i < rank ; i++)
+	{start_block += mpi_size_old / n_proc + ((i < mpi_size_old % n_proc)?1:0);}
+
+	stop_block = start_block + mpi_size_old / n_proc + ((rank < mpi_size_old % n_proc)?1:0);
+}
+
+/*! \brief Blocks saved by the old processors assigned to every processor on restart, balanced by bytes
+ *
+ * Every processor get a contiguous range of blocks, the block i go to the processor
+ * that own the middle byte of the block when the total is split in n_proc equal parts.
+ * With the same number of processors every processor get back its block
+ *
+ * \param sizes size in bytes of every block
+ * \param mpi_size_old number of blocks (processors that saved the file)
+ * \param n_proc number of processors
+ * \param first processor i load the blocks [first(i),first(i+1)) (n_proc + 1 elements)
+ *
+ */
+inline void h5_block_balance(const long long int * sizes, size_t mpi_size_old, size_t n_proc, openfpm::vector<size_t> & first)
+{
+	first.resize(n_proc+1);
+
+	size_t sum = 0;
+	for (size_t i = 0 ; i < mpi_size_old ; i++)
+	{sum += sizes[i];}
+
+	if (mpi_size_old == n_proc || sum == 0)
+	{
+		for (size_t i = 0 ; i < n_proc ; i++)
+		{
+			size_t stop;
+			h5_block_range(mpi_size_old,i,n_proc,first.get(i),stop);
+		}
+
+		first.get(n_proc) = mpi_size_old;
+		return;
+	}
+
+	size_t accum = 0;
+	size_t b = 0;
+
+	for (size_t i = 0 ; i < n_proc ; i++)
+	{
+		first.get(i) = b;
+
+		// the blocks with the middle byte before the end of the part i
+
+		while (b < mpi_size_old && (accum + sizes[b] / 2.0) * n_proc < (double)sum * (i+1))
+		{
+			accum += sizes[b];
+			b++;
+		}
+	}
+
+	first.get(n_proc) = mpi_size_old;
+}
+
+/*! \brief Rows saved by the old processors assigned to this processor on restart, balanced by rows
+ *
+ * The rows have fixed size so every processor read about the same number of bytes,
+ * with the same number of processors every processor get back its rows
+ *
+ * \param rows rows saved by every old processor
+ * \param mpi_size_old number of old processors
+ * \param rank this processor
+ * \param n_proc number of processors
+ * \param off first row to read
+ * \param n number of rows to read
+ *
+ */
+inline void h5_row_balance(const long long int * rows, size_t mpi_size_old, size_t rank, size_t n_proc, size_t & off, size_t & n)
+{
+	size_t tot = 0;
+	off = 0;
+
+	for (size_t i = 0 ; i < mpi_size_old ; i++)
+	{
+		if (mpi_size_old == n_proc && i < rank)
+		{off += rows[i];}
+
+		tot += rows[i];
+	}
+
+	if (mpi_size_old == n_proc)
+	{
+		n = rows[rank];
+		return;
+	}
+
+	off = tot / n_proc * rank + std::min(rank,tot % n_proc);
+	n = tot / n_proc + ((rank < tot % n_proc)?1:0);
+}
+
+/*! \brief Select the chunk c of the byte range [off,off+n) in the file and create the memory dataspace
+ *
+ * \param file_dataspace_id file dataspace
+ * \param off first byte of this processor
+ * \param n bytes of this processor
+ * \param c chunk
+ * \param max_io maximum bytes for a single transfer
+ * \param coffset offset of the chunk from off
+ *
+ * \return the memory dataspace
+ *
+ */
+inline hid_t h5_select_chunk(hid_t file_dataspace_id, hsize_t off, size_t n, size_t c, size_t max_io, size_t & coffset)
+{
+	coffset = std::min(c*max_io,n);
+	size_t bc = std::min(n - coffset,max_io);
+
+	hsize_t mdim[1] = {(bc == 0)?1:bc};
+	hid_t mem_dataspace_id = H5Screate_simple(1, mdim, NULL);
+
+	if (bc == 0)
+	{
+		H5Sselect_none(file_dataspace_id);
+		H5Sselect_none(mem_dataspace_id);
+	}
+	else
+	{
+		hsize_t offset[1] = {off + coffset};
+		hsize_t count[1] = {1};
+		hsize_t block[1] = {bc};
+
+		H5Sselect_hyperslab(file_dataspace_id, H5S_SELECT_SET, offset, NULL, count, block);
+	}
+
+	return mem_dataspace_id;
+}
+
+/*! \brief Collectively write the bytes [off,off+n) of a byte dataset in chunks of max_io bytes
+ *
+ * All the processors must call it with the same n_chunk (the maximum across processors), the
+ * processors that have less chunks participate with empty selections
+ *
+ * \param dataset dataset
+ * \param off first byte of this processor
+ * \param n bytes of this processor
+ * \param n_chunk number of collective writes
+ * \param ptr data
+ * \param plist_id transfer property list
+ * \param max_io maximum bytes for a single transfer
+ *
+ * \return true if the write succeed
+ *
+ */
+inline bool h5_write_bytes(hid_t dataset, hsize_t off, size_t n, size_t n_chunk, const char * ptr, hid_t plist_id, size_t max_io = HDF5_MAX_IO_BYTES)
+{
+	hid_t file_dataspace_id = H5Dget_space(dataset);
+	bool ret = true;
+
+	for (size_t c = 0 ; c < n_chunk ; c++)
+	{
+		size_t coffset;
+		hid_t mem_dataspace_id = h5_select_chunk(file_dataspace_id,off,n,c,max_io,coffset);
+
+		ret &= H5Dwrite(dataset, H5T_NATIVE_CHAR, mem_dataspace_id, file_dataspace_id, plist_id, ptr + coffset) >= 0;
+
+		H5Sclose(mem_dataspace_id);
+	}
+
+	H5Sclose(file_dataspace_id);
+
+	return ret;
+}
+
+/*! \brief Collectively read the bytes [off,off+n) of a byte dataset in chunks of max_io bytes
+ *
+ * All the processors must call it with the same n_chunk (the maximum across processors), the
+ * processors that have less chunks participate with empty selections
+ *
+ * \param dataset dataset
+ * \param off first byte to read
+ * \param n bytes to read
+ * \param n_chunk number of collective reads
+ * \param ptr where to store the data
+ * \param plist_id transfer property list
+ * \param max_io maximum bytes for a single transfer
+ *
+ * \return true if the read succeed
+ *
+ */
+inline bool h5_read_bytes(hid_t dataset, hsize_t off, size_t n, size_t n_chunk, char * ptr, hid_t plist_id, size_t max_io = HDF5_MAX_IO_BYTES)
+{
+	hid_t file_dataspace_id = H5Dget_space(dataset);
+	bool ret = true;
+
+	for (size_t c = 0 ; c < n_chunk ; c++)
+	{
+		size_t coffset;
+		hid_t mem_dataspace_id = h5_select_chunk(file_dataspace_id,off,n,c,max_io,coffset);
+
+		ret &= H5Dread(dataset, H5T_NATIVE_CHAR, mem_dataspace_id, file_dataspace_id, plist_id, ptr + coffset) >= 0;
+
+		H5Sclose(mem_dataspace_id);
+	}
+
+	H5Sclose(file_dataspace_id);
+
+	return ret;
+}
+
+/*! \brief 64 bit FNV-1a hash of a sequence of bytes
+ *
+ * \param ptr bytes
+ * \param n number of bytes
+ * \param h initial value (the hash of the previous bytes to hash several sequences)
+ *
+ * \return the hash
+ *
+ */
+inline unsigned long long h5_hash_bytes(const char * ptr, size_t n, unsigned long long h = 14695981039346656037ull)
+{
+	for (size_t i = 0 ; i < n ; i++)
+	{
+		h ^= (unsigned char)ptr[i];
+		h *= 1099511628211ull;
+	}
+
+	return h;
+}
+
+/*! \brief File written by a group of processors when a checkpoint is saved in one file for every group
+ *
+ * \param filename checkpoint (index file)
+ * \param id index of the group
+ *
+ * \return the file of the group
+ *
+ */
+inline std::string h5_group_file(const std::string & filename, size_t id)
+{
+	return filename + "." + std::to_string(id);
+}
+
+/*! \brief Group of processors that write the same file of a checkpoint
+ *
+ * With n_group = 0 all the processors write the single shared file filename, otherwise every group
+ * of n_group consecutive processors write its own file filename.N (N index of the group) and
+ * h5_write_index create filename as index of the files. Every file is a checkpoint written by
+ * the processors of its group, so the writers only replace rank, size and communicator
+ *
+ */
+struct h5_file_group
+{
+	//! processors of every group (0 single shared file)
+	size_t n_group;
+
+	//! index of the group
+	size_t id;
+
+	//! first processor of the group
+	size_t first;
+
+	//! rank in the group
+	int rank;
+
+	//! number of processors in the group
+	int size;
+
+	//! communicator of the group
+	MPI_Comm comm;
+
+	/*! \brief Constructor (collective)
+	 *
+	 * \param n_group processors of every group (0 single shared file)
+	 *
+	 */
+	h5_file_group(size_t n_group)
+	:n_group(n_group),id(0),first(0)
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+		rank = v_cl.getProcessUnitID();
+		size = v_cl.getProcessingUnits();
+		comm = v_cl.getMPIComm();
+
+		if (n_group == 0)
+		{return;}
+
+		id = rank / n_group;
+		first = id * n_group;
+		rank -= first;
+		size = std::min(n_group,(size_t)size - first);
+
+		MPI_Comm_split(v_cl.getMPIComm(),id,rank,&comm);
+	}
+
+	//! Destructor
+	~h5_file_group()
+	{
+		if (n_group != 0)
+		{MPI_Comm_free(&comm);}
+	}
+
+	h5_file_group(const h5_file_group &) = delete;
+	h5_file_group & operator=(const h5_file_group &) = delete;
+
+	/*! \brief File written by this group
+	 *
+	 * \param filename checkpoint
+	 *
+	 * \return the file
+	 *
+	 */
+	std::string file(const std::string & filename) const
+	{
+		return (n_group == 0)?filename:h5_group_file(filename,id);
+	}
+
+	/*! \brief Keep only the entries of the processors of this group
+	 *
+	 * \param v one entry for every processor
+	 *
+	 */
+	template<typename T> void slice(openfpm::vector<T> & v) const
+	{
+		if (n_group == 0)
+		{return;}
+
+		for (int i = 0 ; i < size ; i++)
+		{v.get(i) = v.get(first + i);}
+
+		v.resize(size);
+	}
+};
+
+//! Append the name of a link to a string (names separated by '\0')
+inline herr_t h5_index_name(hid_t loc, const char * name, const H5L_info_t * info, void * data)
+{
+	std::string & names = *(std::string *)data;
+	names += name;
+	names += '\0';
+
+	return 0;
+}
+
+/*! \brief Copy an attribute of a dataset of the first file to the virtual dataset of the index
+ *
+ * Attributes with variable length types are not copied
+ *
+ * \param loc source dataset
+ * \param name attribute
+ * \param info attribute info
+ * \param data destination dataset (hid_t)
+ *
+ * \return 0 to continue the iteration
+ *
+ */
+inline herr_t h5_index_copy_attr(hid_t loc, const char * name, const H5A_info_t * info, void * data)
+{
+	hid_t dst = *(hid_t *)data;
+
+	hid_t attr = H5Aopen(loc, name, H5P_DEFAULT);
+	hid_t type = H5Aget_type(attr);
+	hid_t space = H5Aget_space(attr);
+
+	if (H5Tis_variable_str(type) > 0 || H5Tdetect_class(type,H5T_VLEN) > 0)
+	{
+		std::cerr << __FILE__ << ":" << __LINE__ << " Warning: the attribute " << name << " has a variable length type and it is not copied in the index" << std::endl;
+	}
+	else
+	{
+		std::vector<char> buf(H5Tget_size(type)*H5Sget_select_npoints(space));
+		H5Aread(attr, type, buf.data());
+
+		hid_t attr_dst = H5Acreate2(dst, name, type, space, H5P_DEFAULT, H5P_DEFAULT);
+		H5Awrite(attr_dst, type, buf.data());
+		H5Aclose(attr_dst);
+	}
+
+	H5Sclose(space);
+	H5Tclose(type);
+	H5Aclose(attr);
+
+	return 0;
+}
+
+/*! \brief Create the index of a checkpoint saved in one file for every group of processors (collective)
+ *
+ * Every dataset of the index is a virtual dataset that concatenate (along the first dimension)
+ * the datasets of the files of the groups in order, so the index is a checkpoint identical to
+ * the one written in a single shared file. The attributes of the datasets are copied from the
+ * first file. Scalar datasets cannot be concatenated and are not in the index. The dataset
+ * file_group contain the processors of every group and the number of files. It require HDF5
+ * 1.10 or later
+ *
+ * \param filename checkpoint (index file)
+ * \param grp group of this processor (the files of the groups must be closed)
+ *
+ */
+inline void h5_write_index(const std::string & filename, const h5_file_group & grp)
+{
+	if (grp.n_group == 0)
+	{return;}
+
+	io_prof_scope p_index("hdf5_index");
+
+	Vcluster<> & v_cl = create_vcluster();
+
+	// the first processor of every group read the rows of the datasets of its file
+
+	MPI_Comm leaders;
+	MPI_Comm_split(v_cl.getMPIComm(),(grp.rank == 0)?0:MPI_UNDEFINED,grp.id,&leaders);
+
+	if (grp.rank == 0)
+	{
+		hid_t file = H5Fopen(grp.file(filename).c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+
+		// names of the datasets of the first file
+
+		std::string names;
+
+		if (grp.id == 0)
+		{H5Literate(file, H5_INDEX_NAME, H5_ITER_INC, NULL, h5_index_name, &names);}
+
+		long long int len = names.size();
+		MPI_Bcast(&len,1,MPI_LONG_LONG,0,leaders);
+		names.resize(len);
+		MPI_Bcast(&names[0],len,MPI_CHAR,0,leaders);
+
+		openfpm::vector<std::string> dset;
+
+		for (size_t i = 0 ; i < names.size() ; i += dset.last().size() + 1)
+		{dset.add(std::string(names.c_str() + i));}
+
+		openfpm::vector<long long int> rows;
+		rows.resize(dset.size());
+
+		for (size_t k = 0 ; k < dset.size() ; k++)
+		{
+			rows.get(k) = 0;
+
+			if (H5Lexists(file, dset.get(k).c_str(), H5P_DEFAULT) <= 0)
+			{continue;}
+
+			hid_t dataset = H5Dopen(file, dset.get(k).c_str(), H5P_DEFAULT);
+			hid_t space = H5Dget_space(dataset);
+			hsize_t dims[H5S_MAX_RANK];
+
+			if (H5Sget_simple_extent_dims(space, dims, NULL) > 0)
+			{rows.get(k) = dims[0];}
+
+			H5Sclose(space);
+			H5Dclose(dataset);
+		}
+
+		H5Fclose(file);
+
+		int n_file;
+		MPI_Comm_size(leaders,&n_file);
+
+		openfpm::vector<long long int> rows_all;
+		rows_all.resize((grp.id == 0)?n_file*dset.size():1);
+
+		MPI_Gather(rows.getPointer(),dset.size(),MPI_LONG_LONG,rows_all.getPointer(),dset.size(),MPI_LONG_LONG,0,leaders);
+		MPI_Comm_free(&leaders);
+
+		if (grp.id == 0)
+		{
+			// the files of the groups are referred relative to the directory of the index
+
+			std::string local = filename.substr(filename.find_last_of('/') + 1);
+
+			hid_t index = H5Fcreate(filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+			file = H5Fopen(grp.file(filename).c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+
+			for (size_t k = 0 ; k < dset.size() ; k++)
+			{
+				hid_t src = H5Dopen(file, dset.get(k).c_str(), H5P_DEFAULT);
+				hid_t type = H5Dget_type(src);
+				hid_t space = H5Dget_space(src);
+
+				hsize_t dims[H5S_MAX_RANK];
+				int rank = H5Sget_simple_extent_dims(space, dims, NULL);
+				H5Sclose(space);
+
+				if (rank <= 0)
+				{
+					std::cerr << __FILE__ << ":" << __LINE__ << " Warning: the dataset " << dset.get(k) << " is scalar and it is not in the index " << filename << std::endl;
+					H5Dclose(src);
+					H5Tclose(type);
+					continue;
+				}
+
+				dims[0] = 0;
+				for (int g = 0 ; g < n_file ; g++)
+				{dims[0] += rows_all.get(g*dset.size() + k);}
+
+				hid_t vspace = H5Screate_simple(rank, dims, NULL);
+				hid_t dcpl_id = H5Pcreate(H5P_DATASET_CREATE);
+
+				hsize_t start[H5S_MAX_RANK];
+				hsize_t count[H5S_MAX_RANK];
+				hsize_t block[H5S_MAX_RANK];
+
+				for (int d = 0 ; d < rank ; d++)
+				{
+					start[d] = 0;
+					count[d] = 1;
+					block[d] = dims[d];
+				}
+
+				for (int g = 0 ; g < n_file ; g++)
+				{
+					block[0] = rows_all.get(g*dset.size() + k);
+
+					if (block[0] != 0)
+					{
+						H5Sselect_hyperslab(vspace, H5S_SELECT_SET, start, NULL, count, block);
+						hid_t src_space = H5Screate_simple(rank, block, NULL);
+
+						H5Pset_virtual(dcpl_id, vspace, h5_group_file(local,g).c_str(), dset.get(k).c_str(), src_space);
+						H5Sclose(src_space);
+					}
+
+					start[0] += block[0];
+				}
+
+				H5Sselect_all(vspace);
+				hid_t dataset = H5Dcreate(index, dset.get(k).c_str(), type, vspace, H5P_DEFAULT, dcpl_id, H5P_DEFAULT);
+
+				H5Aiterate2(src, H5_INDEX_NAME, H5_ITER_INC, NULL, h5_index_copy_attr, &dataset);
+
+				H5Dclose(dataset);
+				H5Dclose(src);
+				H5Pclose(dcpl_id);
+				H5Sclose(vspace);
+				H5Tclose(type);
+			}
+
+			H5Fclose(file);
+
+			long long int file_group[2] = {(long long int)grp.n_group,n_file};
+
+			hsize_t fdim[1] = {2};
+			hid_t space = H5Screate_simple(1, fdim, NULL);
+			hid_t dataset = H5Dcreate(index, "file_group", H5T_NATIVE_LLONG, space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+			H5Dwrite(dataset, H5T_NATIVE_LLONG, H5S_ALL, H5S_ALL, H5P_DEFAULT, file_group);
+
+			H5Dclose(dataset);
+			H5Sclose(space);
+			H5Fclose(index);
+		}
+	}
+
+	// the index exist when the save return
+	MPI_Barrier(v_cl.getMPIComm());
+}
+
+/*! \brief Open a checkpoint for a collective read
+ *
+ * If the file is the index of a checkpoint saved in one file for every group of processors
+ * (h5_write_index) every processor open it independently, the virtual datasets open the
+ * files of the groups with the same access, and the collective reads become independent
+ *
+ * \param filename file
+ * \param comm communicator
+ * \param opt tuning of the access
+ *
+ * \return the file (negative on failure)
+ *
+ */
+inline hid_t h5_open_checkpoint(const std::string & filename, MPI_Comm comm, const h5_io_options & opt = h5_io_options())
+{
+	hid_t plist_id = h5_create_fapl(comm,opt,0);
+	if (plist_id < 0)	{return -1;}
+
+	hid_t file = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, plist_id);
+	H5Pclose(plist_id);
+
+	if (file < 0 || H5Lexists(file, "file_group", H5P_DEFAULT) <= 0)
+	{return file;}
+
+	H5Fclose(file);
+
+	plist_id = h5_create_fapl(MPI_COMM_SELF,opt,0);
+
+	file = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, plist_id);
+	H5Pclose(plist_id);
+
+	return file;
+}
+
+#endif /* OPENFPM_IO_SRC_HDF5_WR_HDF5_UTIL_HPP_ */
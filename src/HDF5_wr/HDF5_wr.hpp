@@ -11,6 +11,7 @@
 
 #define VECTOR_DIST 1
 #define GRID_DIST 2
+#define GRAPH_DIST 3
 
 #include "HDF5_writer.hpp"
 #include "HDF5_reader.hpp"
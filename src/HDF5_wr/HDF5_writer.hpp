@@ -25,5 +25,6 @@ class HDF5_writer
 
 #include "HDF5_writer_vd.hpp"
 #include "HDF5_writer_gd.hpp"
+#include "HDF5_writer_graph.hpp"
 
 #endif /* OPENFPM_IO_SRC_HDF5_WR_HDF5_WRITER_HPP_ */
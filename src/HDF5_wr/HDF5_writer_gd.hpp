@@ -12,20 +12,217 @@
 #include "Packer_Unpacker/Pack_selector.hpp"
 #include "Packer_Unpacker/Packer.hpp"
 #include "Packer_Unpacker/Unpacker.hpp"
+#include "Grid/map_grid.hpp"
 #include "util/GBoxes.hpp"
+#include "HDF5_util.hpp"
+
+/*! \brief Layout of the grid_dist checkpoint
+ *
+ */
+enum hdf5_gd_layout
+{
+	//! local grids and their boxes packed in a single byte dataset grid_dist
+	HDF5_GRID_PACKED,
+	//! every property in a global N-D dataset indexed by the global grid coordinates
+	HDF5_GRID_GLOBAL
+};
+
+/*! \brief this class is a functor for "for_each" algorithm
+ *
+ * For each property of the grid it check if it can be stored in a typed dataset
+ *
+ * \tparam device_grid type of the local grids
+ *
+ */
+template<typename device_grid>
+struct h5_gd_check_prop
+{
+	//! true if all the properties can be stored in a typed dataset
+	bool valid = true;
+
+	//! first property that cannot be stored
+	int prp = -1;
+
+	//! It check the property
+	template<typename T> void operator()(T& t)
+	{
+		typedef typename boost::mpl::at<typename device_grid::value_type::type,boost::mpl::int_<T::value>>::type ptype;
+
+		if (h5_prop_rows<ptype>::is_valid == false && valid == true)
+		{
+			valid = false;
+			prp = T::value;
+		}
+	}
+};
+
+/*! \brief this class is a functor for "for_each" algorithm
+ *
+ * For each property of the grid it write the global dataset grid_prp_N, every processor
+ * write the domain of its local grids at their global position
+ *
+ * \tparam device_grid type of the local grids
+ *
+ */
+template<typename device_grid>
+struct h5_gd_write_prop
+{
+	//! local grids
+	const openfpm::vector<device_grid> & loc_grid;
+
+	//! boxes of the local grids
+	const openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext;
+
+	//! HDF5 file
+	hid_t file;
+
+	//! transfer property list
+	hid_t plist_id;
+
+	//! size of the global grid
+	const hsize_t * gsz;
+
+	//! number of collective writes (maximum number of local grids across the processors)
+	size_t n_write;
+
+	//! bytes written by this processor
+	size_t bytes = 0;
+
+	/*! \brief constructor
+	 *
+	 * \param loc_grid local grids
+	 * \param gdb_ext boxes of the local grids
+	 * \param file HDF5 file
+	 * \param plist_id transfer property list
+	 * \param gsz size of the global grid
+	 * \param n_write number of collective writes
+	 *
+	 */
+	h5_gd_write_prop(const openfpm::vector<device_grid> & loc_grid, const openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext,
+			         hid_t file, hid_t plist_id, const hsize_t * gsz, size_t n_write)
+	:loc_grid(loc_grid),gdb_ext(gdb_ext),file(file),plist_id(plist_id),gsz(gsz),n_write(n_write)
+	{}
+
+	//! It write the property
+	template<typename T> void operator()(T& t)
+	{
+		typedef typename boost::mpl::at<typename device_grid::value_type::type,boost::mpl::int_<T::value>>::type ptype;
+
+		const unsigned int dim = device_grid::dims;
+
+		if (h5_prop_rows<ptype>::is_valid == false)
+		{return;}
+
+		hsize_t prp_dims[H5S_MAX_RANK];
+		h5_array_dims<ptype>::get(prp_dims);
+
+		std::string name = "grid_prp_" + std::to_string(T::value);
+
+		hid_t tp = h5_type<typename std::remove_all_extents<ptype>::type>::create();
+		hid_t file_dataspace_id = h5_grid_dataspace(dim,gsz,h5_array_dims<ptype>::rank,prp_dims);
+		hid_t dataset = H5Dcreate (file, name.c_str(), tp, file_dataspace_id, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+		H5Sclose(file_dataspace_id);
+
+		if (dataset < 0)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error: cannot create the dataset " << name << std::endl;
+			H5Tclose(tp);
+			return;
+		}
+
+		// every processor do n_write collective writes, the ones past its local grids are empty
+
+		for (size_t k = 0 ; k < n_write ; k++)
+		{
+			hsize_t low[dim];
+			hsize_t sz[dim];
+			size_t n = 0;
+
+			if (k < loc_grid.size())
+			{n = h5_grid_domain(gdb_ext.get(k),dim,low,sz);}
+			else
+			{
+				for (size_t d = 0 ; d < dim ; d++)
+				{low[d] = 0; sz[d] = 0;}
+			}
+
+			// copy the domain with x as fastest index
+
+			std::vector<char> buf(n*sizeof(ptype));
+
+			if (n != 0)
+			{
+				grid_key_dx<dim> start;
+				grid_key_dx<dim> stop;
+
+				for (size_t d = 0 ; d < dim ; d++)
+				{
+					start.set_d(d,gdb_ext.get(k).Dbox.getLow(d));
+					stop.set_d(d,gdb_ext.get(k).Dbox.getHigh(d));
+				}
+
+				auto it = loc_grid.get(k).getSubIterator(start,stop);
+
+				for (size_t i = 0 ; it.isNext() ; ++it, i++)
+				{memcpy(&buf[i*sizeof(ptype)],&loc_grid.get(k).template get<T::value>(it.get()),sizeof(ptype));}
+			}
+
+			hid_t mem_dataspace_id;
+			file_dataspace_id = h5_grid_box_dataspace(dim,gsz,low,sz,h5_array_dims<ptype>::rank,prp_dims,mem_dataspace_id);
+
+			H5Dwrite(dataset, tp, mem_dataspace_id, file_dataspace_id, plist_id, buf.data());
+
+			H5Sclose(mem_dataspace_id);
+			H5Sclose(file_dataspace_id);
+
+			bytes += buf.size();
+		}
+
+		H5Dclose(dataset);
+		H5Tclose(tp);
+	}
+};
 
 template <>
 class HDF5_writer<GRID_DIST>
 {
-public:
-
+	//! maximum number of bytes written by a single H5Dwrite
+	size_t max_io = HDF5_MAX_IO_BYTES;
+
+	//! compression of the datasets
+	h5_compression cmp;
+
+	//! store the hash of every local grid
+	bool store_hash = false;
+
+	//! processors that write the same file (0 single shared file)
+	size_t n_group = 0;
+
+	//! tuning of the file access
+	h5_io_options opt;
+
+	/*! \brief Pack the local grids and write them in the datasets grid_dist and metadata
+	 *
+	 * \param filename file
+	 * \param loc_grid local grids
+	 * \param gdb_ext boxes of the local grids
+	 * \param plist_id output collective transfer property list (to write other datasets)
+	 * \param grp group of processors that write the file
+	 *
+	 * \return the file still open (the caller close it and plist_id)
+	 *
+	 */
 	template<typename device_grid>
-	inline void save(const std::string & filename,
-			         const openfpm::vector<device_grid> & loc_grid,
-					 const openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext) const
+	inline hid_t save_packed(const std::string & filename,
+			                 const openfpm::vector<device_grid> & loc_grid,
+					         const openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext,
+							 hid_t & plist_id,
+							 const h5_file_group & grp) const
 	{
 		Vcluster<> & v_cl = create_vcluster();
 
+		io_prof_scope p_pack("hdf5_pack");
+
 		//Pack_request vector
 		size_t req = 0;
 
@@ -48,26 +245,18 @@ public:
 		Packer<typename std::remove_reference<decltype(loc_grid)>::type,HeapMemory>::pack(mem,loc_grid,sts);
 		Packer<typename std::remove_reference<decltype(gdb_ext)>::type,HeapMemory>::pack(mem,gdb_ext,sts);
 
+		p_pack.stop(pmem.size());
+
 	    /*****************************************************************
 	     * Create a new file with default creation and access properties.*
 	     * Then create a dataset and write data to it and close the file *
 	     * and dataset.                                                  *
 	     *****************************************************************/
 
-		int mpi_rank = v_cl.getProcessUnitID();
-		int mpi_size = v_cl.getProcessingUnits();
+		int mpi_rank = grp.rank;
+		int mpi_size = grp.size;
 
-		MPI_Comm comm = v_cl.getMPIComm();
-		MPI_Info info  = MPI_INFO_NULL;
-
-	    // Set up file access property list with parallel I/O access
-
-		hid_t plist_id = H5Pcreate(H5P_FILE_ACCESS);
-		H5Pset_fapl_mpio(plist_id, comm, info);
-
-		// Create a new file collectively and release property list identifier.
-		hid_t file = H5Fcreate (filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, plist_id);
-		H5Pclose(plist_id);
+		io_prof_scope p_gather("hdf5_allgather");
 
 		size_t sz = pmem.size();
 		//std::cout << "Pmem.size: " << pmem.size() << std::endl;
@@ -75,11 +264,25 @@ public:
 		v_cl.allGather(sz,sz_others);
 		v_cl.execute();
 
+		p_gather.stop(sz_others.size()*sizeof(size_t));
+
+		grp.slice(sz_others);
+
 		size_t sum = 0;
 
 		for (size_t i = 0; i < sz_others.size(); i++)
 			sum += sz_others.get(i);
 
+	    // Set up file access property list with parallel I/O access
+
+		io_prof_scope p_create("hdf5_create");
+
+		plist_id = h5_create_fapl(grp.comm,opt,sum);
+
+		// Create a new file collectively and release property list identifier.
+		hid_t file = H5Fcreate (grp.file(filename).c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, plist_id);
+		H5Pclose(plist_id);
+
 		//Size for data space in file
 		hsize_t fdim[1] = {sum};
 
@@ -96,7 +299,9 @@ public:
 			//std::cout << "Total object size: " << sum << std::endl;
 
 		//Create data set in file
-		hid_t file_dataset = H5Dcreate (file, "grid_dist", H5T_NATIVE_CHAR, file_dataspace_id, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+		hid_t dcpl_id = h5_compression_dcpl(cmp,sum,0,NULL,1,sz_others);
+		hid_t file_dataset = H5Dcreate (file, "grid_dist", H5T_NATIVE_CHAR, file_dataspace_id, H5P_DEFAULT, dcpl_id, H5P_DEFAULT);
+		h5_close_dcpl(dcpl_id);
 
 		//Create data set 2 in file
 		hid_t file_dataset_2 = H5Dcreate (file, "metadata", H5T_NATIVE_LLONG, file_dataspace_id_2, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
@@ -105,12 +310,12 @@ public:
 	    H5Sclose(file_dataspace_id);
 	    H5Sclose(file_dataspace_id_2);
 
+	    p_create.stop();
+
 	    hsize_t block[1] = {pmem.size()};
 
 	    //hsize_t stride[1] = {1};
 
-		hsize_t count[1] = {1};
-
 	    hsize_t offset[1] = {0};
 
 	    for (int i = 0; i < mpi_rank; i++)
@@ -138,44 +343,474 @@ public:
             plist_id = H5Pcreate(H5P_DATASET_XFER);
             H5Pset_dxpl_mpio(plist_id, H5FD_MPIO_COLLECTIVE);
 
-	    // We slipt the write in chunk of 2GB maximum
-	    size_t to_write = block[0];
-	    size_t coffset = 0;
-	    while (to_write)
-	    {
-			hsize_t block_c[1];
-			block_c[0] = std::min((size_t)(to_write),(size_t)0x7FFFFFFF);
+	    // We slipt the write in chunk of max_io (2GB) maximum, every processor must do the same number of collective writes
+	    size_t n_chunk = 0;
 
-			//Create data space in memory
-			hid_t mem_dataspace_id = H5Screate_simple(1, block_c, NULL);
-
-			hsize_t offset_c[1] = {offset[0] + coffset};
-			H5Sselect_hyperslab(file_dataspace_id, H5S_SELECT_SET, offset_c, NULL, count, block_c);
+	    for (int i = 0; i < mpi_size; i++)
+	    {n_chunk = std::max(n_chunk,h5_n_chunks(sz_others.get(i),max_io));}
 
-			//Write a data set to a file
-			H5Dwrite(file_dataset, H5T_NATIVE_CHAR, mem_dataspace_id, file_dataspace_id, plist_id, (const char *)pmem.getPointer() + coffset);
+	    io_prof_scope p_write("hdf5_write");
 
-			coffset += std::min((size_t)(to_write),(size_t)0x7FFFFFFF);
-			to_write -= std::min((size_t)(to_write),(size_t)0x7FFFFFFF);
-
-			H5Sclose(mem_dataspace_id);
-	    }
+	    h5_write_bytes(file_dataset,offset[0],block[0],n_chunk,(const char *)pmem.getPointer(),plist_id,max_io);
 
 	    file_dataspace_id_2 = H5Dget_space(file_dataset_2);
 
 	    //Write a data set 2 to a file
 	    H5Dwrite(file_dataset_2, H5T_NATIVE_LLONG, H5S_ALL, file_dataspace_id_2, plist_id, metadata);
+
+	    p_write.stop(pmem.size());
 	    
 	    //Close/release resources.
 	    H5Dclose(file_dataset);
 	    H5Sclose(file_dataspace_id);
 	    H5Dclose(file_dataset_2);
 	    H5Sclose(file_dataspace_id_2);
-	    H5Pclose(plist_id);
-	    H5Fclose(file);
 
 	    mem.decRef();
 	    delete &mem;
+
+	    return file;
+	}
+
+	/*! \brief Hash of every local grid (packed grid and its boxes)
+	 *
+	 * \param loc_grid local grids
+	 * \param gdb_ext boxes of the local grids
+	 * \param hash hash of every local grid
+	 *
+	 */
+	template<typename device_grid>
+	static void patch_hash(const openfpm::vector<device_grid> & loc_grid,
+			               const openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext,
+						   openfpm::vector<unsigned long long> & hash)
+	{
+		hash.resize(loc_grid.size());
+
+		for (size_t i = 0 ; i < loc_grid.size() ; i++)
+		{
+			size_t req = 0;
+			Packer<device_grid,HeapMemory>::packRequest(loc_grid.get(i),req);
+
+			HeapMemory pmem;
+			ExtPreAlloc<HeapMemory> & mem = *(new ExtPreAlloc<HeapMemory>(req,pmem));
+			mem.incRef();
+
+			Pack_stat sts;
+			Packer<device_grid,HeapMemory>::pack(mem,loc_grid.get(i),sts);
+
+			hash.get(i) = h5_hash_bytes((const char *)pmem.getPointer(),pmem.size());
+			hash.get(i) = h5_hash_bytes((const char *)&gdb_ext.get(i),sizeof(GBoxes<device_grid::dims>),hash.get(i));
+
+			mem.decRef();
+			delete &mem;
+		}
+	}
+
+	/*! \brief Write a 1D dataset with a variable number of rows for every processor
+	 *
+	 * It write also the dataset name_count with the number of rows of every processor
+	 *
+	 * \param file HDF5 file
+	 * \param name dataset name
+	 * \param type HDF5 type of the rows
+	 * \param n number of rows of this processor
+	 * \param ptr rows
+	 * \param plist_id transfer property list
+	 * \param grp group of processors that write the file
+	 *
+	 */
+	void save_rows(hid_t file, const std::string & name, hid_t type, size_t n, const void * ptr, hid_t plist_id,
+			       const h5_file_group & grp) const
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+		openfpm::vector<size_t> n_others;
+		v_cl.allGather(n,n_others);
+		v_cl.execute();
+
+		grp.slice(n_others);
+
+		openfpm::vector<long long int> count;
+		count.resize(n_others.size());
+
+		size_t tot = 0;
+		size_t off = 0;
+
+		for (size_t i = 0 ; i < n_others.size() ; i++)
+		{
+			if (i < (size_t)grp.rank)
+			{off += n_others.get(i);}
+
+			count.get(i) = n_others.get(i);
+			tot += n_others.get(i);
+		}
+
+		size_t rank = grp.rank;
+
+		h5_write_1d(file,name + "_count",H5T_NATIVE_LLONG,count.size(),rank,1,&count.get(rank),plist_id);
+		h5_write_1d(file,name,type,tot,off,n,ptr,plist_id);
+	}
+
+	/*! \brief Save every property in a global N-D dataset indexed by the global grid coordinates
+	 *
+	 * * grid_size (dim) size of the global grid
+	 * * grid_prp_N (grid size in reverse order x extents of the property) property N, the
+	 *   last dimension is x
+	 * * grid_box (local grids x (2*dim+1)) low and high corner of the domain of every local
+	 *   grid in global coordinates and GBoxes::k, grid_box_count number of values of every processor
+	 *
+	 * Every processor write the domain (Dbox shifted by origin) of its local grids as an
+	 * hyperslab, the size of the grid is the maximum of the domains. The ghost are not saved
+	 *
+	 * \param filename file
+	 * \param loc_grid local grids
+	 * \param gdb_ext boxes of the local grids
+	 *
+	 */
+	template<typename device_grid>
+	inline void save_global(const std::string & filename,
+			                const openfpm::vector<device_grid> & loc_grid,
+					        const openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext) const
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+		const unsigned int dim = device_grid::dims;
+
+		// domain of the local grids and size of the global grid
+
+		io_prof_scope p_gather("hdf5_allgather");
+
+		openfpm::vector<long long int> box;
+		size_t gsz_r[dim];
+		hsize_t gsz[dim];
+
+		for (size_t d = 0 ; d < dim ; d++)
+		{gsz_r[d] = 0;}
+
+		for (size_t i = 0 ; i < loc_grid.size() ; i++)
+		{
+			hsize_t low[dim];
+			hsize_t sz[dim];
+			size_t n = h5_grid_domain(gdb_ext.get(i),dim,low,sz);
+
+			for (size_t d = 0 ; d < dim ; d++)
+			{
+				if (n != 0)
+				{gsz_r[d] = std::max(gsz_r[d],(size_t)(low[d] + sz[d]));}
+
+				box.add(gdb_ext.get(i).Dbox.getLow(d) + gdb_ext.get(i).origin.get(d));
+			}
+
+			for (size_t d = 0 ; d < dim ; d++)
+			{box.add(gdb_ext.get(i).Dbox.getHigh(d) + gdb_ext.get(i).origin.get(d));}
+
+			box.add(gdb_ext.get(i).k);
+		}
+
+		size_t n_write = loc_grid.size();
+
+		for (size_t d = 0 ; d < dim ; d++)
+		{v_cl.max(gsz_r[d]);}
+		v_cl.max(n_write);
+		v_cl.execute();
+
+		size_t tot = 1;
+
+		for (size_t d = 0 ; d < dim ; d++)
+		{
+			gsz[d] = gsz_r[d];
+			tot *= gsz[d];
+		}
+
+		p_gather.stop((dim+1)*sizeof(size_t));
+
+		io_prof_scope p_create("hdf5_create");
+
+		hid_t plist_id = h5_create_fapl(v_cl.getMPIComm(),opt,tot*sizeof(typename device_grid::value_type));
+
+		hid_t file = H5Fcreate (filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, plist_id);
+		H5Pclose(plist_id);
+
+		if (file < 0)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error: cannot create the file " << filename << std::endl;
+			return;
+		}
+
+		//Create property list for collective dataset write.
+		plist_id = H5Pcreate(H5P_DATASET_XFER);
+		H5Pset_dxpl_mpio(plist_id, H5FD_MPIO_COLLECTIVE);
+
+		p_create.stop();
+
+		io_prof_scope p_write("hdf5_write");
+
+		long long int gsz_ll[dim];
+
+		for (size_t d = 0 ; d < dim ; d++)
+		{gsz_ll[d] = gsz[d];}
+
+		h5_write_1d(file,"grid_size",H5T_NATIVE_LLONG,dim,0,(v_cl.getProcessUnitID() == 0)?dim:0,gsz_ll,plist_id);
+
+		h5_file_group grp(0);
+		save_rows(file,"grid_box",H5T_NATIVE_LLONG,box.size(),box.getPointer(),plist_id,grp);
+
+		h5_gd_write_prop<device_grid> wp(loc_grid,gdb_ext,file,plist_id,gsz,n_write);
+		boost::mpl::for_each_ref< boost::mpl::range_c<int,0,device_grid::value_type::max_prop> >(wp);
+
+		p_write.stop(wp.bytes);
+
+		io_prof_scope p_flush("hdf5_flush");
+
+		H5Pclose(plist_id);
+		H5Fclose(file);
+
+		p_flush.stop();
+	}
+
+public:
+
+	/*! \brief Set the maximum number of bytes written by a single H5Dwrite
+	 *
+	 * The default is 2GB (the limit of MPI-IO), smaller values are useful only to test
+	 *
+	 * \param max_io maximum number of bytes
+	 *
+	 */
+	void setMaxIOBytes(size_t max_io)
+	{
+		this->max_io = (max_io == 0)?1:std::min(max_io,(size_t)HDF5_MAX_IO_BYTES);
+	}
+
+	/*! \brief Compress the datasets with deflate (chunked datasets)
+	 *
+	 * The chunks are aligned to the blocks written by the processors. In parallel it
+	 * require HDF5 1.10.2 or later, with older versions the datasets are not compressed
+	 *
+	 * \param level deflate level (0 no compression, 1-9)
+	 * \param shuffle apply the shuffle filter before deflate
+	 *
+	 */
+	void setCompression(int level, bool shuffle = true)
+	{
+		cmp = h5_compression(level,shuffle);
+	}
+
+	/*! \brief Store the hash of every local grid
+	 *
+	 * A file saved with the hashes can be used as base of save_delta
+	 *
+	 * \param store true to store the hashes
+	 *
+	 */
+	void setPatchHash(bool store)
+	{
+		store_hash = store;
+	}
+
+	/*! \brief Save one file for every group of processors instead of a single shared file
+	 *
+	 * Every group of n_proc consecutive processors write the file filename.N (N index of the
+	 * group) and filename become a small index of the files, that can be loaded like a single
+	 * file by any number of processors
+	 *
+	 * \param n_proc processors of every group (0 single shared file, default)
+	 *
+	 */
+	void setFileGroup(size_t n_proc)
+	{
+		n_group = n_proc;
+	}
+
+	/*! \brief Set the MPI-IO hints, the alignment and the metadata options of the file
+	 *
+	 * \param opt tuning of the file access
+	 *
+	 */
+	void setIOOptions(const h5_io_options & opt)
+	{
+		this->opt = opt;
+	}
+
+	/*! \brief Save the local grids
+	 *
+	 * With HDF5_GRID_GLOBAL every property is stored in a global N-D dataset (see save_global)
+	 * that can be read on any decomposition with HDF5_reader<GRID_DIST>::load_global or sliced
+	 * by external tools. The patch hashes and the file groups are used only by the packed
+	 * layout (a warning is printed if setFileGroup is combined with the global layout), if a
+	 * property cannot be stored in a typed dataset the packed layout is used
+	 *
+	 * \param filename file
+	 * \param loc_grid local grids
+	 * \param gdb_ext boxes of the local grids
+	 * \param layout layout of the file
+	 *
+	 */
+	template<typename device_grid>
+	inline void save(const std::string & filename,
+			         const openfpm::vector<device_grid> & loc_grid,
+					 const openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext,
+					 hdf5_gd_layout layout = HDF5_GRID_PACKED) const
+	{
+		if (layout == HDF5_GRID_GLOBAL)
+		{
+			h5_gd_check_prop<device_grid> cprp;
+			boost::mpl::for_each_ref< boost::mpl::range_c<int,0,device_grid::value_type::max_prop> >(cprp);
+
+			if (cprp.valid == true)
+			{
+				if (n_group != 0)
+				{std::cerr << __FILE__ << ":" << __LINE__ << " Warning: the global layout is saved in a single shared file, the file groups are ignored" << std::endl;}
+
+				save_global(filename,loc_grid,gdb_ext);
+				return;
+			}
+
+			std::cerr << __FILE__ << ":" << __LINE__ << " Warning: the property " << cprp.prp << " cannot be stored in a typed dataset, using the packed layout" << std::endl;
+		}
+
+		h5_file_group grp(n_group);
+
+		hid_t plist_id;
+		hid_t file = save_packed(filename,loc_grid,gdb_ext,plist_id,grp);
+
+		if (store_hash == true)
+		{
+			openfpm::vector<unsigned long long> hash;
+			patch_hash(loc_grid,gdb_ext,hash);
+
+			save_rows(file,"patch_hash",H5T_NATIVE_ULLONG,hash.size(),hash.getPointer(),plist_id,grp);
+		}
+
+	    io_prof_scope p_flush("hdf5_flush");
+
+	    H5Pclose(plist_id);
+	    H5Fclose(file);
+
+	    p_flush.stop();
+
+	    h5_write_index(filename,grp);
+	}
+
+	/*! \brief Save only the local grids changed from a base checkpoint
+	 *
+	 * The base must be saved with setPatchHash(true) by the same number of processors with
+	 * the same number of local grids. If on any processor the base does not match, a full
+	 * checkpoint is saved with save (without base). The file contain the changed grids in
+	 * the same format of save and
+	 *
+	 * * base name of the base file (as passed to this function)
+	 * * patch_count number of local grids of every processor
+	 * * delta_index index of every saved grid in the local grids of its processor
+	 * * delta_index_count number of saved grids of every processor
+	 *
+	 * HDF5_reader<GRID_DIST>::load rebuild the state loading the base and overlaying the
+	 * saved grids
+	 *
+	 * \param filename file
+	 * \param base base checkpoint
+	 * \param loc_grid local grids
+	 * \param gdb_ext boxes of the local grids
+	 *
+	 */
+	template<typename device_grid>
+	inline void save_delta(const std::string & filename,
+			               const std::string & base,
+			               const openfpm::vector<device_grid> & loc_grid,
+					       const openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext) const
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+		size_t rank = v_cl.getProcessUnitID();
+
+		openfpm::vector<unsigned long long> hash;
+		patch_hash(loc_grid,gdb_ext,hash);
+
+		// hashes of the base for the local grids of this processor
+
+		openfpm::vector<unsigned long long> hash_base;
+		size_t usable = 0;
+
+		hid_t file = h5_open_checkpoint(base,v_cl.getMPIComm(),opt);
+
+		if (file >= 0 && H5Lexists(file, "patch_hash_count", H5P_DEFAULT) > 0)
+		{
+			hid_t dataset = H5Dopen (file, "patch_hash_count", H5P_DEFAULT);
+			hid_t space = H5Dget_space(dataset);
+			size_t mpi_size_base = H5Sget_select_npoints(space);
+			H5Sclose(space);
+
+			openfpm::vector<long long int> count;
+			count.resize(mpi_size_base);
+			H5Dread(dataset, H5T_NATIVE_LLONG, H5S_ALL, H5S_ALL, H5P_DEFAULT, count.getPointer());
+			H5Dclose(dataset);
+
+			if (mpi_size_base == v_cl.getProcessingUnits() && (size_t)count.get(rank) == loc_grid.size())
+			{
+				size_t off = 0;
+				for (size_t i = 0 ; i < rank ; i++)
+				{off += count.get(i);}
+
+				hash_base.resize(loc_grid.size());
+
+				usable = h5_read_1d(file,"patch_hash",H5T_NATIVE_ULLONG,off,loc_grid.size(),hash_base.getPointer(),H5P_DEFAULT);
+			}
+		}
+
+		if (file >= 0)
+		{H5Fclose(file);}
+
+		// the delta is saved only if the base match on all the processors
+
+		v_cl.min(usable);
+		v_cl.execute();
+
+		if (usable == 0)
+		{
+			if (rank == 0)
+			{std::cerr << __FILE__ << ":" << __LINE__ << " Warning: " << base << " does not match the local grids, saving a full checkpoint" << std::endl;}
+
+			save(filename,loc_grid,gdb_ext);
+			return;
+		}
+
+		// changed grids
+
+		openfpm::vector<device_grid> loc_grid_d;
+		openfpm::vector<GBoxes<device_grid::dims>> gdb_ext_d;
+		openfpm::vector<long long int> delta_index;
+
+		for (size_t i = 0 ; i < loc_grid.size() ; i++)
+		{
+			if (hash_base.get(i) == hash.get(i))
+			{continue;}
+
+			loc_grid_d.add(loc_grid.get(i));
+			gdb_ext_d.add(gdb_ext.get(i));
+			delta_index.add(i);
+		}
+
+		h5_file_group grp(n_group);
+
+		hid_t plist_id;
+		file = save_packed(filename,loc_grid_d,gdb_ext_d,plist_id,grp);
+
+		long long int n_patch = loc_grid.size();
+		h5_write_1d(file,"patch_count",H5T_NATIVE_LLONG,grp.size,grp.rank,1,&n_patch,plist_id);
+		save_rows(file,"delta_index",H5T_NATIVE_LLONG,delta_index.size(),delta_index.getPointer(),plist_id,grp);
+
+		// with one file for every group only the first file has the name of the base
+		if (grp.id == 0)
+		{h5_write_1d(file,"base",H5T_NATIVE_CHAR,base.size(),0,(grp.rank == 0)?base.size():0,base.c_str(),plist_id);}
+
+	    io_prof_scope p_flush("hdf5_flush");
+
+	    H5Pclose(plist_id);
+	    H5Fclose(file);
+
+	    p_flush.stop();
+
+	    h5_write_index(filename,grp);
 	}
 
 };
@@ -0,0 +1,335 @@
+/*
+ * HDF5_writer_graph.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef OPENFPM_IO_SRC_HDF5_WR_HDF5_WRITER_GRAPH_HPP_
+#define OPENFPM_IO_SRC_HDF5_WR_HDF5_WRITER_GRAPH_HPP_
+
+#include "HDF5_util.hpp"
+
+/*! \brief this class is a functor for "for_each" algorithm
+ *
+ * For each property of the vertex (or of the edge) it write the dataset vertex_prp_N (edge_prp_N)
+ *
+ * \tparam Graph graph
+ * \tparam is_vertex true to write the vertex properties, false for the edges
+ *
+ */
+template<typename Graph, bool is_vertex>
+struct h5_graph_write_prop
+{
+	//! graph
+	const Graph & g;
+
+	//! HDF5 file
+	hid_t file;
+
+	//! transfer property list
+	hid_t plist_id;
+
+	//! total number of vertices (edges)
+	hsize_t tot;
+
+	//! offset of this processor
+	hsize_t off;
+
+	//! vertices (edges) to write in order
+	const openfpm::vector<size_t> & ids;
+
+	//! compression
+	const h5_compression & cmp;
+
+	//! vertices (edges) of every processor
+	const openfpm::vector<size_t> & blocks;
+
+	/*! \brief constructor
+	 *
+	 * \param g graph
+	 * \param file HDF5 file
+	 * \param plist_id transfer property list
+	 * \param tot total number of vertices (edges)
+	 * \param off offset of this processor
+	 * \param ids vertices (edges) to write in order
+	 * \param cmp compression
+	 * \param blocks vertices (edges) of every processor
+	 *
+	 */
+	h5_graph_write_prop(const Graph & g, hid_t file, hid_t plist_id, hsize_t tot, hsize_t off, const openfpm::vector<size_t> & ids,
+			            const h5_compression & cmp, const openfpm::vector<size_t> & blocks)
+	:g(g),file(file),plist_id(plist_id),tot(tot),off(off),ids(ids),cmp(cmp),blocks(blocks)
+	{}
+
+	//! It write the property
+	template<typename T> void operator()(T& t) const
+	{
+		typedef typename std::conditional<is_vertex,typename Graph::V_type,typename Graph::E_type>::type obj;
+		typedef typename boost::mpl::at<typename obj::type,boost::mpl::int_<T::value>>::type ptype;
+
+		const Graph & g = this->g;
+		const openfpm::vector<size_t> & ids = this->ids;
+
+		std::string name = std::string((is_vertex)?"vertex_prp_":"edge_prp_") + std::to_string(T::value);
+
+		if (is_vertex == true)
+		{
+			h5_prop_rows<ptype>::write(file,name,tot,off,ids.size(),
+					[&](size_t i){return (const void *)&g.vertex(ids.get(i)).template get<T::value>();},plist_id,cmp,&blocks);
+		}
+		else
+		{
+			h5_prop_rows<ptype>::write(file,name,tot,off,ids.size(),
+					[&](size_t i){return (const void *)&g.edge(ids.get(i)).template get<T::value>();},plist_id,cmp,&blocks);
+		}
+	}
+};
+
+/*! \brief It save a graph in HDF5 in CSR format
+ *
+ * Every processor contribute its local graph, the file contain a single global CSR
+ *
+ * * row_ptr (number of vertices + 1) start of the edges of every vertex in col_index
+ * * col_index (number of edges) global id of the target vertex
+ * * vertex_prp_N and edge_prp_N typed dataset for every property (edges ordered like col_index)
+ * * metadata number of vertices and edges written by every processor
+ *
+ * The local graph of every processor must not have edges to vertices of other processors,
+ * the global id of a vertex is the local id plus the number of vertices of the previous processors
+ *
+ */
+template <>
+class HDF5_writer<GRAPH_DIST>
+{
+	//! compression of the datasets
+	h5_compression cmp;
+
+	//! tuning of the file access
+	h5_io_options opt;
+
+public:
+
+	/*! \brief Compress the datasets with deflate (chunked datasets)
+	 *
+	 * The chunks are aligned to the blocks written by the processors. In parallel it
+	 * require HDF5 1.10.2 or later, with older versions the datasets are not compressed
+	 *
+	 * \param level deflate level (0 no compression, 1-9)
+	 * \param shuffle apply the shuffle filter before deflate
+	 *
+	 */
+	void setCompression(int level, bool shuffle = true)
+	{
+		cmp = h5_compression(level,shuffle);
+	}
+
+	/*! \brief Set the MPI-IO hints, the alignment and the metadata options of the file
+	 *
+	 * \param opt tuning of the file access
+	 *
+	 */
+	void setIOOptions(const h5_io_options & opt)
+	{
+		this->opt = opt;
+	}
+
+	/*! \brief Save the graph
+	 *
+	 * The edges must connect vertices of the same processor, a graph with an edge whose
+	 * target is not a local vertex is rejected (on all processors) and nothing is written
+	 *
+	 * \param filename file
+	 * \param g local graph
+	 *
+	 */
+	template<typename Graph>
+	inline void save(const std::string & filename, const Graph & g) const
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+		int mpi_rank = v_cl.getProcessUnitID();
+		int mpi_size = v_cl.getProcessingUnits();
+
+		// Create the local CSR
+
+		size_t n_v = g.getNVertex();
+
+		openfpm::vector<long long int> row_ptr;
+		row_ptr.resize(n_v+1);
+
+		for (size_t i = 0 ; i < row_ptr.size() ; i++)
+		{row_ptr.get(i) = 0;}
+
+		size_t n_remote = 0;
+
+		auto it = g.getEdgeIterator();
+
+		while (it.isNext())
+		{
+			row_ptr.get(it.source()+1)++;
+
+			if ((size_t)it.target() >= n_v)
+			{n_remote++;}
+
+			++it;
+		}
+
+		// the file store only edges inside the block of a processor
+
+		size_t n_remote_tot = n_remote;
+		v_cl.sum(n_remote_tot);
+		v_cl.execute();
+
+		if (n_remote_tot != 0)
+		{
+			if (n_remote != 0)
+			{std::cerr << __FILE__ << ":" << __LINE__ << " Error: " << n_remote << " edges point to vertices that are not local, the graph cannot be saved in " << filename << std::endl;}
+
+			return;
+		}
+
+		for (size_t i = 0 ; i < n_v ; i++)
+		{row_ptr.get(i+1) += row_ptr.get(i);}
+
+		size_t n_e = row_ptr.get(n_v);
+
+		openfpm::vector<long long int> col_index;
+		openfpm::vector<size_t> e_ids;
+		openfpm::vector<size_t> v_ids;
+		col_index.resize(n_e);
+		e_ids.resize(n_e);
+		v_ids.resize(n_v);
+
+		for (size_t i = 0 ; i < n_v ; i++)
+		{v_ids.get(i) = i;}
+
+		openfpm::vector<long long int> pos;
+		pos.resize(n_v);
+
+		for (size_t i = 0 ; i < n_v ; i++)
+		{pos.get(i) = row_ptr.get(i);}
+
+		auto it2 = g.getEdgeIterator();
+
+		while (it2.isNext())
+		{
+			size_t k = pos.get(it2.source())++;
+
+			col_index.get(k) = it2.target();
+			e_ids.get(k) = it2.get();
+
+			++it2;
+		}
+
+		// Get the vertices and edges of the other processors
+
+		openfpm::vector<size_t> v_others;
+		openfpm::vector<size_t> e_others;
+
+		io_prof_scope p_gather("hdf5_allgather");
+
+		v_cl.allGather(n_v,v_others);
+		v_cl.execute();
+
+		v_cl.allGather(n_e,e_others);
+		v_cl.execute();
+
+		p_gather.stop(2*mpi_size*sizeof(size_t));
+
+		size_t v_tot = 0;
+		size_t e_tot = 0;
+		size_t v_off = 0;
+		size_t e_off = 0;
+
+		for (int i = 0 ; i < mpi_size ; i++)
+		{
+			if (i < mpi_rank)
+			{
+				v_off += v_others.get(i);
+				e_off += e_others.get(i);
+			}
+
+			v_tot += v_others.get(i);
+			e_tot += e_others.get(i);
+		}
+
+		// To global ids
+
+		for (size_t i = 0 ; i < row_ptr.size() ; i++)
+		{row_ptr.get(i) += e_off;}
+
+		for (size_t i = 0 ; i < col_index.size() ; i++)
+		{col_index.get(i) += v_off;}
+
+		// Set up file access property list with parallel I/O access
+
+		io_prof_scope p_create("hdf5_create");
+
+		size_t bytes = (v_tot + 1 + e_tot) * sizeof(long long int) + v_tot * sizeof(typename Graph::V_type) + e_tot * sizeof(typename Graph::E_type);
+		hid_t plist_id = h5_create_fapl(v_cl.getMPIComm(),opt,bytes);
+
+		// Create a new file collectively and release property list identifier.
+		hid_t file = H5Fcreate (filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, plist_id);
+		H5Pclose(plist_id);
+
+		if (file < 0)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error: cannot create the file " << filename << std::endl;
+			return;
+		}
+
+		//Create property list for collective dataset write.
+		plist_id = H5Pcreate(H5P_DATASET_XFER);
+		H5Pset_dxpl_mpio(plist_id, H5FD_MPIO_COLLECTIVE);
+
+		// metadata (number of vertices and edges of every processor)
+
+		hsize_t fdim2[2] = {(size_t)mpi_size,2};
+		hid_t file_dataspace_id_2 = H5Screate_simple(2, fdim2, NULL);
+		hid_t file_dataset_2 = H5Dcreate (file, "metadata", H5T_NATIVE_LLONG, file_dataspace_id_2, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+
+		openfpm::vector<long long int> metadata;
+		metadata.resize(2*mpi_size);
+
+		for (int i = 0; i < mpi_size; i++)
+		{
+			metadata.get(2*i) = v_others.get(i);
+			metadata.get(2*i+1) = e_others.get(i);
+		}
+
+		H5Dwrite(file_dataset_2, H5T_NATIVE_LLONG, H5S_ALL, H5S_ALL, plist_id, metadata.getPointer());
+
+		H5Dclose(file_dataset_2);
+		H5Sclose(file_dataspace_id_2);
+
+		p_create.stop();
+
+		io_prof_scope p_write("hdf5_write");
+
+		// CSR, the last processor write also the closing row pointer
+
+		size_t n_row = (mpi_rank == mpi_size - 1)?n_v+1:n_v;
+
+		h5_write_1d(file,"row_ptr",H5T_NATIVE_LLONG,v_tot+1,v_off,n_row,row_ptr.getPointer(),plist_id,cmp,&v_others);
+		h5_write_1d(file,"col_index",H5T_NATIVE_LLONG,e_tot,e_off,n_e,col_index.getPointer(),plist_id,cmp,&e_others);
+
+		// Properties
+
+		h5_graph_write_prop<Graph,true> wv(g,file,plist_id,v_tot,v_off,v_ids,cmp,v_others);
+		boost::mpl::for_each_ref< boost::mpl::range_c<int,0,Graph::V_type::max_prop> >(wv);
+
+		h5_graph_write_prop<Graph,false> we(g,file,plist_id,e_tot,e_off,e_ids,cmp,e_others);
+		boost::mpl::for_each_ref< boost::mpl::range_c<int,0,Graph::E_type::max_prop> >(we);
+
+		p_write.stop((n_row + n_e) * sizeof(long long int) + n_v * sizeof(typename Graph::V_type) + n_e * sizeof(typename Graph::E_type));
+
+		io_prof_scope p_flush("hdf5_flush");
+
+		H5Pclose(plist_id);
+		H5Fclose(file);
+
+		p_flush.stop();
+	}
+};
+
+#endif /* OPENFPM_IO_SRC_HDF5_WR_HDF5_WRITER_GRAPH_HPP_ */
@@ -11,6 +11,7 @@
 #include "HDF5_wr.hpp"
 
 #include "hdf5.h"
+#include "timer.hpp"
 
 BOOST_AUTO_TEST_SUITE( vd_hdf5_chckpnt_rstrt_test_io )
 
@@ -111,6 +112,1369 @@ BOOST_AUTO_TEST_CASE( vector_dist_hdf5_load_test )
 
 }
 
+/*! Stress test of the chunked vector_dist checkpoint
+ *
+ * The processors have very different sizes (some are empty) and the maximum transfer is reduced
+ * to a few KB, so every processor do a different number of writes/reads. To stress it with many
+ * processors on a workstation run it oversubscribed, for example
+ *
+ * mpirun --oversubscribe -np 64 ./io --run_test=vd_hdf5_chckpnt_rstrt_test_io/vector_dist_hdf5_chunked_stress_test
+ *
+ */
+BOOST_AUTO_TEST_CASE( vector_dist_hdf5_chunked_stress_test )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	size_t rank = v_cl.getProcessUnitID();
+	size_t n_part = (rank % 5 == 4)?0:(rank % 4 + 1)*10000;
+
+	openfpm::vector<Point<3,float>> vpos;
+	openfpm::vector<aggregate<float[dim],size_t>> vprp;
+
+	for (size_t i = 0 ; i < n_part ; i++)
+	{
+		Point<3,float> p;
+
+		p.get(0) = i;
+		p.get(1) = rank;
+		p.get(2) = i+17;
+
+		vpos.add(p);
+
+		vprp.add();
+		vprp.template get<0>(vprp.size()-1)[0] = p.get(0) + 100.0;
+		vprp.template get<0>(vprp.size()-1)[1] = p.get(1) + 200.0;
+		vprp.template get<0>(vprp.size()-1)[2] = p.get(2) + 300.0;
+		vprp.template get<1>(vprp.size()-1) = rank*1000000 + i;
+	}
+
+	timer t_save;
+	t_save.start();
+
+	HDF5_writer<VECTOR_DIST> h5;
+	h5.setMaxIOBytes(4096);
+	h5.save("vector_dist_stress.h5",vpos,vprp);
+
+	t_save.stop();
+
+	timer t_load;
+	t_load.start();
+
+	HDF5_reader<VECTOR_DIST> h5r;
+	h5r.setMaxIOBytes(3000);
+
+	openfpm::vector<Point<3,float>> vpos2;
+	openfpm::vector<aggregate<float[dim],size_t>> vprp2;
+
+	size_t g_m = 0;
+	bool ret = h5r.load("vector_dist_stress.h5",vpos2,vprp2,g_m);
+
+	t_load.stop();
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	// Same number of processors, every processor get back its particles
+
+	BOOST_REQUIRE_EQUAL(vpos2.size(),n_part);
+	BOOST_REQUIRE_EQUAL(vprp2.size(),n_part);
+
+	bool check = true;
+	for (size_t i = 0 ; i < n_part ; i++)
+	{
+		check &= (vpos.get(i) == vpos2.get(i));
+		check &= (vprp.template get<0>(i)[0] == vprp2.template get<0>(i)[0]);
+		check &= (vprp.template get<0>(i)[1] == vprp2.template get<0>(i)[1]);
+		check &= (vprp.template get<0>(i)[2] == vprp2.template get<0>(i)[2]);
+		check &= (vprp.template get<1>(i) == vprp2.template get<1>(i));
+	}
+
+	BOOST_REQUIRE_EQUAL(check,true);
+
+	// the typed datasets (columns) are also written and read in chunks, the processors
+	// issue a different number of transfers
+
+	h5.save("vector_dist_stress_columns.h5",vpos,vprp,HDF5_COLUMNS);
+
+	vpos2.clear();
+	vprp2.clear();
+
+	ret = h5r.load("vector_dist_stress_columns.h5",vpos2,vprp2,g_m);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	BOOST_REQUIRE_EQUAL(vpos2.size(),n_part);
+	BOOST_REQUIRE_EQUAL(vprp2.size(),n_part);
+
+	for (size_t i = 0 ; i < n_part ; i++)
+	{
+		check &= (vpos.get(i) == vpos2.get(i));
+		check &= (vprp.template get<0>(i)[0] == vprp2.template get<0>(i)[0]);
+		check &= (vprp.template get<0>(i)[2] == vprp2.template get<0>(i)[2]);
+		check &= (vprp.template get<1>(i) == vprp2.template get<1>(i));
+	}
+
+	BOOST_REQUIRE_EQUAL(check,true);
+
+	size_t tot = n_part;
+	double ts = t_save.getwct();
+	double tl = t_load.getwct();
+	v_cl.sum(tot);
+	v_cl.max(ts);
+	v_cl.max(tl);
+	v_cl.execute();
+
+	if (rank == 0)
+	{
+		double mb = tot * (sizeof(Point<3,float>) + sizeof(aggregate<float[dim],size_t>)) / 1024.0 / 1024.0;
+		std::cout << "vector_dist HDF5 chunked stress: " << v_cl.getProcessingUnits() << " processors " << mb << " MB"
+				  << " save " << ts << " s (" << mb / ts << " MB/s)"
+				  << " load " << tl << " s (" << mb / tl << " MB/s)" << std::endl;
+	}
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_hdf5_save_columns_test )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	openfpm::vector<Point<3,float>> vpos;
+	openfpm::vector<aggregate<float[dim],double,int>> vprp;
+
+	for (size_t i = 0 ; i < 1024 ; i++)
+	{
+		Point<3,float> p;
+
+		p.get(0) = i;
+		p.get(1) = i+13;
+		p.get(2) = i+17;
+
+		vpos.add(p);
+
+		vprp.add();
+		vprp.template get<0>(vprp.size()-1)[0] = p.get(0) + 100.0;
+		vprp.template get<0>(vprp.size()-1)[1] = p.get(1) + 200.0;
+		vprp.template get<0>(vprp.size()-1)[2] = p.get(2) + 300.0;
+		vprp.template get<1>(vprp.size()-1) = 0.5*i;
+		vprp.template get<2>(vprp.size()-1) = -(int)i;
+	}
+
+	HDF5_writer<VECTOR_DIST> h5;
+	h5.save("vector_dist_columns.h5",vpos,vprp,HDF5_COLUMNS);
+
+	// Every field is a typed dataset with one row for every particle
+
+	hid_t file = H5Fopen("vector_dist_columns.h5", H5F_ACC_RDONLY, H5P_DEFAULT);
+	BOOST_REQUIRE(file >= 0);
+
+	hsize_t dims[2];
+	hid_t dataset = H5Dopen(file, "position", H5P_DEFAULT);
+	hid_t space = H5Dget_space(dataset);
+	BOOST_REQUIRE_EQUAL(H5Sget_simple_extent_dims(space,dims,NULL),2);
+	BOOST_REQUIRE_EQUAL(dims[0],1024ul*v_cl.getProcessingUnits());
+	BOOST_REQUIRE_EQUAL(dims[1],3ul);
+	hid_t tp = H5Dget_type(dataset);
+	BOOST_REQUIRE_EQUAL(H5Tget_class(tp),H5T_FLOAT);
+	H5Tclose(tp);
+	H5Sclose(space);
+	H5Dclose(dataset);
+
+	dataset = H5Dopen(file, "property_2", H5P_DEFAULT);
+	space = H5Dget_space(dataset);
+	BOOST_REQUIRE_EQUAL(H5Sget_simple_extent_dims(space,dims,NULL),1);
+	tp = H5Dget_type(dataset);
+	BOOST_REQUIRE_EQUAL(H5Tget_class(tp),H5T_INTEGER);
+	H5Tclose(tp);
+	H5Sclose(space);
+	H5Dclose(dataset);
+
+	H5Fclose(file);
+
+	HDF5_reader<VECTOR_DIST> h5r;
+
+	openfpm::vector<Point<3,float>> vpos2;
+	openfpm::vector<aggregate<float[dim],double,int>> vprp2;
+
+	size_t g_m = 0;
+	bool ret = h5r.load("vector_dist_columns.h5",vpos2,vprp2,g_m);
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+	BOOST_REQUIRE_EQUAL(1024ul,vpos2.size());
+	BOOST_REQUIRE_EQUAL(1024ul,vprp2.size());
+	BOOST_REQUIRE_EQUAL(1024ul,g_m);
+
+	bool check = true;
+	for (size_t i = 0 ; i < vpos.size() ; i++)
+	{
+		check &= (vpos.get(i) == vpos2.get(i));
+		check &= (vprp.template get<0>(i)[0] == vprp2.template get<0>(i)[0]);
+		check &= (vprp.template get<0>(i)[1] == vprp2.template get<0>(i)[1]);
+		check &= (vprp.template get<0>(i)[2] == vprp2.template get<0>(i)[2]);
+		check &= (vprp.template get<1>(i) == vprp2.template get<1>(i));
+		check &= (vprp.template get<2>(i) == vprp2.template get<2>(i));
+	}
+
+	BOOST_REQUIRE_EQUAL(check,true);
+}
+
+/*! \brief Fill the particles used by the save/load tests
+ *
+ * \param vpos positions
+ * \param vprp properties
+ * \param n number of particles
+ *
+ */
+template<typename vpos_type, typename vprp_type>
+void h5_test_fill_particles(vpos_type & vpos, vprp_type & vprp, size_t n)
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	for (size_t i = 0 ; i < n ; i++)
+	{
+		Point<3,float> p;
+
+		p.get(0) = i;
+		p.get(1) = v_cl.getProcessUnitID();
+		p.get(2) = 2.0;
+
+		vpos.add(p);
+
+		vprp.add();
+		vprp.template get<0>(vprp.size()-1)[0] = 0.0;
+		vprp.template get<0>(vprp.size()-1)[1] = 1.0;
+		vprp.template get<0>(vprp.size()-1)[2] = i;
+		vprp.template get<1>(vprp.size()-1) = 0.5*i;
+		vprp.template get<2>(vprp.size()-1) = v_cl.getProcessUnitID();
+	}
+}
+
+/*! \brief Load a file saved from h5_test_fill_particles and check that every processor get back its particles
+ *
+ * \param h5r reader
+ * \param file file to load
+ * \param vpos saved positions
+ * \param vprp saved properties
+ *
+ */
+template<typename vpos_type, typename vprp_type>
+void h5_test_check_load(HDF5_reader<VECTOR_DIST> & h5r, const std::string & file, const vpos_type & vpos, const vprp_type & vprp)
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	vpos_type vpos2;
+	vprp_type vprp2;
+
+	size_t g_m = 0;
+	bool ret = h5r.load(file,vpos2,vprp2,g_m);
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+	BOOST_REQUIRE_EQUAL(vpos.size(),vpos2.size());
+
+	// g_m is the number of particles loaded by this processor
+
+	BOOST_REQUIRE_EQUAL(g_m,vpos2.size());
+
+	size_t g_tot = g_m;
+	v_cl.sum(g_tot);
+	v_cl.execute();
+
+	BOOST_REQUIRE_EQUAL(g_tot,vpos.size()*v_cl.getProcessingUnits());
+
+	bool check = true;
+	for (size_t i = 0 ; i < vpos.size() ; i++)
+	{
+		check &= (vpos.get(i) == vpos2.get(i));
+		check &= (vprp.template get<0>(i)[2] == vprp2.template get<0>(i)[2]);
+		check &= (vprp.template get<1>(i) == vprp2.template get<1>(i));
+		check &= (vprp.template get<2>(i) == vprp2.template get<2>(i));
+	}
+
+	BOOST_REQUIRE_EQUAL(check,true);
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_hdf5_compressed_test )
+{
+	openfpm::vector<Point<3,float>> vpos;
+	openfpm::vector<aggregate<float[dim],double,int>> vprp;
+
+	h5_test_fill_particles(vpos,vprp,4096);
+
+	hdf5_vd_layout layouts[2] = {HDF5_PACKED,HDF5_COLUMNS};
+	const char * dsets[2] = {"vector_dist","position"};
+
+	for (size_t l = 0 ; l < 2 ; l++)
+	{
+		HDF5_writer<VECTOR_DIST> h5;
+		h5.setCompression(6);
+		h5.save("vector_dist_compressed.h5",vpos,vprp,layouts[l]);
+
+		// The dataset must be chunked and deflated
+
+		hid_t file = H5Fopen("vector_dist_compressed.h5", H5F_ACC_RDONLY, H5P_DEFAULT);
+		BOOST_REQUIRE(file >= 0);
+
+		hid_t dataset = H5Dopen(file, dsets[l], H5P_DEFAULT);
+		hid_t dcpl = H5Dget_create_plist(dataset);
+
+		BOOST_REQUIRE_EQUAL(H5Pget_layout(dcpl),H5D_CHUNKED);
+
+		bool deflate = false;
+		int n_filter = H5Pget_nfilters(dcpl);
+		for (int i = 0 ; i < n_filter ; i++)
+		{
+			unsigned int flags;
+			size_t nelmts = 0;
+			deflate |= (H5Pget_filter2(dcpl,i,&flags,&nelmts,NULL,0,NULL,NULL) == H5Z_FILTER_DEFLATE);
+		}
+
+		BOOST_REQUIRE_EQUAL(deflate,true);
+
+		H5Pclose(dcpl);
+		H5Dclose(dataset);
+		H5Fclose(file);
+
+		HDF5_reader<VECTOR_DIST> h5r;
+		h5_test_check_load(h5r,"vector_dist_compressed.h5",vpos,vprp);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( hdf5_block_balance_test )
+{
+	// two large blocks and many small ones on two processors
+
+	long long int sizes[8] = {100,1,1,1,1,100,1,1};
+
+	openfpm::vector<size_t> first;
+	h5_block_balance(sizes,8,2,first);
+
+	BOOST_REQUIRE_EQUAL(first.size(),3ul);
+	BOOST_REQUIRE_EQUAL(first.get(0),0ul);
+	BOOST_REQUIRE_EQUAL(first.get(1),4ul);
+	BOOST_REQUIRE_EQUAL(first.get(2),8ul);
+
+	// same number of processors, every processor get its block
+
+	h5_block_balance(sizes,8,8,first);
+
+	for (size_t i = 0 ; i < first.size() ; i++)
+	{BOOST_REQUIRE_EQUAL(first.get(i),i);}
+
+	// more processors than blocks
+
+	h5_block_balance(sizes,2,4,first);
+
+	BOOST_REQUIRE_EQUAL(first.get(0),0ul);
+	BOOST_REQUIRE_EQUAL(first.get(4),2ul);
+
+	for (size_t i = 0 ; i < 4 ; i++)
+	{BOOST_REQUIRE(first.get(i) <= first.get(i+1));}
+
+	// rows are split evenly
+
+	size_t off;
+	size_t n;
+	h5_row_balance(sizes,8,1,3,off,n);
+
+	BOOST_REQUIRE_EQUAL(off,69ul);
+	BOOST_REQUIRE_EQUAL(n,69ul);
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_hdf5_spatial_load_test )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	size_t rank = v_cl.getProcessUnitID();
+	size_t n_proc = v_cl.getProcessingUnits();
+
+	// every processor save particles in the slab [rank,rank+1) along x
+
+	openfpm::vector<Point<3,float>> vpos;
+	openfpm::vector<aggregate<float[dim],size_t>> vprp;
+
+	for (size_t i = 0 ; i < 1000 ; i++)
+	{
+		Point<3,float> p;
+
+		p.get(0) = rank + (i % 10) / 10.0 + 0.05;
+		p.get(1) = (i / 10 % 10) / 10.0;
+		p.get(2) = (i / 100) / 10.0;
+
+		vpos.add(p);
+
+		vprp.add();
+		vprp.template get<0>(i)[0] = p.get(0);
+		vprp.template get<0>(i)[1] = p.get(1);
+		vprp.template get<0>(i)[2] = p.get(2);
+		vprp.template get<1>(i) = rank;
+	}
+
+	hdf5_vd_layout layouts[2] = {HDF5_PACKED,HDF5_COLUMNS};
+
+	for (size_t l = 0 ; l < 2 ; l++)
+	{
+		HDF5_writer<VECTOR_DIST> h5;
+		h5.save("vector_dist_spatial.h5",vpos,vprp,layouts[l]);
+
+		// the bounding box of every block is saved
+
+		hid_t file = H5Fopen("vector_dist_spatial.h5", H5F_ACC_RDONLY, H5P_DEFAULT);
+		BOOST_REQUIRE(file >= 0);
+
+		openfpm::vector<double> bbox;
+		bbox.resize(6*n_proc);
+		hsize_t row_dims[1] = {6};
+		BOOST_REQUIRE_EQUAL(h5_read_rows(file,"block_bbox",H5T_NATIVE_DOUBLE,0,n_proc,1,row_dims,bbox.getPointer(),H5P_DEFAULT),true);
+		H5Fclose(file);
+
+		BOOST_REQUIRE_CLOSE(bbox.get(6*rank),rank + 0.05,0.001);
+		BOOST_REQUIRE_CLOSE(bbox.get(6*rank+3),rank + 0.95,0.001);
+		BOOST_REQUIRE_CLOSE(bbox.get(6*rank+4),0.9,0.001);
+
+		// the sub-domain of the slab saved by the next processor, every processor
+		// get the particles of the next one
+
+		size_t next = (rank + 1) % n_proc;
+
+		openfpm::vector<Box<3,float>> sub_domains;
+		Box<3,float> bx;
+
+		for (size_t d = 0 ; d < 3 ; d++)
+		{
+			bx.setLow(d,(d == 0)?next:0.0);
+			bx.setHigh(d,(d == 0)?next+1.0:1.0);
+		}
+
+		sub_domains.add(bx);
+
+		HDF5_reader<VECTOR_DIST> h5r;
+
+		openfpm::vector<Point<3,float>> vpos2;
+		openfpm::vector<aggregate<float[dim],size_t>> vprp2;
+
+		size_t g_m = 0;
+		bool ret = h5r.load("vector_dist_spatial.h5",vpos2,vprp2,g_m,sub_domains);
+
+		BOOST_REQUIRE_EQUAL(ret,true);
+		BOOST_REQUIRE_EQUAL(vpos2.size(),1000ul);
+
+		bool check = true;
+		for (size_t i = 0 ; i < vpos2.size() ; i++)
+		{
+			check &= (vprp2.template get<1>(i) == next);
+			check &= bx.isInside(vpos2.get(i));
+			check &= (vprp2.template get<0>(i)[0] == vpos2.template get<0>(i)[0]);
+		}
+
+		BOOST_REQUIRE_EQUAL(check,true);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_hdf5_partial_load_test )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	openfpm::vector<Point<3,float>> vpos;
+	openfpm::vector<aggregate<float[dim],double,int>> vprp;
+
+	for (size_t i = 0 ; i < 1000 ; i++)
+	{
+		Point<3,float> p;
+
+		p.get(0) = (i % 10) / 10.0;
+		p.get(1) = (i / 10 % 10) / 10.0;
+		p.get(2) = (i / 100) / 10.0;
+
+		vpos.add(p);
+
+		vprp.add();
+		vprp.template get<0>(i)[0] = 1.0;
+		vprp.template get<0>(i)[1] = 2.0;
+		vprp.template get<0>(i)[2] = 3.0;
+		vprp.template get<1>(i) = 0.5*i;
+		vprp.template get<2>(i) = i + 1;
+	}
+
+	hdf5_vd_layout layouts[2] = {HDF5_PACKED,HDF5_COLUMNS};
+
+	for (size_t l = 0 ; l < 2 ; l++)
+	{
+		HDF5_writer<VECTOR_DIST> h5;
+		h5.save("vector_dist_partial.h5",vpos,vprp,layouts[l]);
+
+		// only the property 1, the others are left to the default value
+
+		openfpm::vector<size_t> prp;
+		prp.add(1);
+
+		HDF5_reader<VECTOR_DIST> h5r;
+
+		openfpm::vector<Point<3,float>> vpos2;
+		openfpm::vector<aggregate<float[dim],double,int>> vprp2;
+
+		size_t g_m = 0;
+		bool ret = h5r.load_partial("vector_dist_partial.h5",vpos2,vprp2,g_m,prp);
+
+		BOOST_REQUIRE_EQUAL(ret,true);
+		BOOST_REQUIRE_EQUAL(vpos2.size(),vpos.size());
+
+		bool check = true;
+		for (size_t i = 0 ; i < vpos2.size() ; i++)
+		{
+			check &= (vpos.get(i) == vpos2.get(i));
+			check &= (vprp2.template get<0>(i)[1] == 0.0);
+			check &= (vprp2.template get<1>(i) == vprp.template get<1>(i));
+			check &= (vprp2.template get<2>(i) == 0);
+		}
+
+		BOOST_REQUIRE_EQUAL(check,true);
+
+		// only the particles in the region, every processor load the particles of all the
+		// processors in its region
+
+		Box<3,float> bx;
+
+		for (size_t d = 0 ; d < 3 ; d++)
+		{
+			bx.setLow(d,0.0);
+			bx.setHigh(d,(d == 0)?0.45:1.0);
+		}
+
+		prp.add(2);
+
+		ret = h5r.load_partial("vector_dist_partial.h5",vpos2,vprp2,g_m,prp,bx);
+
+		BOOST_REQUIRE_EQUAL(ret,true);
+		BOOST_REQUIRE_EQUAL(vpos2.size(),500ul*v_cl.getProcessingUnits());
+		BOOST_REQUIRE_EQUAL(g_m,vpos2.size());
+
+		check = true;
+		for (size_t i = 0 ; i < vpos2.size() ; i++)
+		{
+			check &= bx.isInside(vpos2.get(i));
+			check &= (vprp2.template get<0>(i)[0] == 0.0);
+			check &= (vprp2.template get<2>(i) != 0);
+		}
+
+		BOOST_REQUIRE_EQUAL(check,true);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_hdf5_file_group_test )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	openfpm::vector<Point<3,float>> vpos;
+	openfpm::vector<aggregate<float[dim],double,int>> vprp;
+
+	h5_test_fill_particles(vpos,vprp,1000);
+
+	hdf5_vd_layout layouts[2] = {HDF5_PACKED,HDF5_COLUMNS};
+
+	// one file for every processor and one file for every two processors
+
+	size_t n_group[2] = {1,2};
+
+	for (size_t l = 0 ; l < 2 ; l++)
+	{
+		for (size_t k = 0 ; k < 2 ; k++)
+		{
+			HDF5_writer<VECTOR_DIST> h5;
+			h5.setFileGroup(n_group[k]);
+			h5.save("vector_dist_group.h5",vpos,vprp,layouts[l]);
+
+			// the index has the number of processors of every group and the number of files
+
+			hid_t file = H5Fopen("vector_dist_group.h5", H5F_ACC_RDONLY, H5P_DEFAULT);
+			BOOST_REQUIRE(file >= 0);
+
+			long long int file_group[2];
+			hid_t dataset = H5Dopen(file, "file_group", H5P_DEFAULT);
+			H5Dread(dataset, H5T_NATIVE_LLONG, H5S_ALL, H5S_ALL, H5P_DEFAULT, file_group);
+			H5Dclose(dataset);
+			H5Fclose(file);
+
+			size_t n_file = (v_cl.getProcessingUnits() + n_group[k] - 1) / n_group[k];
+
+			BOOST_REQUIRE_EQUAL(file_group[0],(long long int)n_group[k]);
+			BOOST_REQUIRE_EQUAL(file_group[1],(long long int)n_file);
+
+			HDF5_reader<VECTOR_DIST> h5r;
+			h5_test_check_load(h5r,"vector_dist_group.h5",vpos,vprp);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_hdf5_io_options_test )
+{
+	openfpm::vector<Point<3,float>> vpos;
+	openfpm::vector<aggregate<float[dim],double,int>> vprp;
+
+	h5_test_fill_particles(vpos,vprp,1000);
+
+	h5_io_options opt;
+	opt.cb_buffer_size = 4*1024*1024;
+	opt.alignment = 4096;
+	opt.meta_block_size = 8192;
+	opt.coll_metadata = true;
+
+	HDF5_writer<VECTOR_DIST> h5;
+	h5.setIOOptions(opt);
+	h5.save("vector_dist_options.h5",vpos,vprp,HDF5_COLUMNS);
+
+	// the datasets are aligned
+
+	hid_t file = H5Fopen("vector_dist_options.h5", H5F_ACC_RDONLY, H5P_DEFAULT);
+	BOOST_REQUIRE(file >= 0);
+
+	hid_t dataset = H5Dopen(file, "property_1", H5P_DEFAULT);
+	haddr_t addr = H5Dget_offset(dataset);
+	H5Dclose(dataset);
+	H5Fclose(file);
+
+	BOOST_REQUIRE(addr != HADDR_UNDEF);
+	BOOST_REQUIRE_EQUAL(addr % 4096,0ul);
+
+	HDF5_reader<VECTOR_DIST> h5r;
+	h5r.setIOOptions(opt);
+
+	h5_test_check_load(h5r,"vector_dist_options.h5",vpos,vprp);
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_hdf5_io_profiler_test )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	openfpm::vector<Point<3,float>> vpos;
+	openfpm::vector<aggregate<float[dim],double,int>> vprp;
+
+	h5_test_fill_particles(vpos,vprp,1000);
+
+	io_profiler & prof = get_io_profiler();
+	prof.clear();
+	prof.enable(true);
+
+	HDF5_writer<VECTOR_DIST> h5;
+	h5.save("vector_dist_prof.h5",vpos,vprp);
+
+	HDF5_reader<VECTOR_DIST> h5r;
+	h5_test_check_load(h5r,"vector_dist_prof.h5",vpos,vprp);
+
+	prof.enable(false);
+
+	openfpm::vector<io_phase> phases;
+	prof.getPhases(phases);
+
+	size_t pack = 0;
+	size_t write = 0;
+	size_t read = 0;
+
+	for (size_t i = 0 ; i < phases.size() ; i++)
+	{
+		BOOST_REQUIRE(phases.get(i).time >= 0.0);
+
+		if (phases.get(i).phase == "hdf5_pack")		{pack = phases.get(i).bytes;}
+		if (phases.get(i).phase == "hdf5_write")	{write = phases.get(i).bytes;}
+		if (phases.get(i).phase == "hdf5_read")		{read += phases.get(i).bytes;}
+	}
+
+	BOOST_REQUIRE(pack != 0);
+	BOOST_REQUIRE_EQUAL(pack,write);
+	BOOST_REQUIRE(read != 0);
+
+	// the summary is the same on all the processors
+
+	openfpm::vector<io_phase_summary> summary;
+	prof.getSummary(summary);
+
+	BOOST_REQUIRE_EQUAL(summary.size(),phases.size());
+
+	for (size_t i = 0 ; i < summary.size() ; i++)
+	{
+		BOOST_REQUIRE(summary.get(i).time_min <= summary.get(i).time_avg);
+		BOOST_REQUIRE(summary.get(i).time_avg <= summary.get(i).time_max);
+		BOOST_REQUIRE(summary.get(i).bytes_min <= summary.get(i).bytes_max);
+	}
+
+	// the events recorded while disabled are discarded
+
+	size_t n_ev = prof.getEvents().size();
+	h5.save("vector_dist_prof.h5",vpos,vprp);
+	BOOST_REQUIRE_EQUAL(prof.getEvents().size(),n_ev);
+
+	BOOST_REQUIRE_EQUAL(prof.writeJSON("vector_dist_prof"),true);
+	BOOST_REQUIRE_EQUAL(prof.writeChromeTrace("vector_dist_prof"),true);
+
+	std::ifstream ifs("vector_dist_prof_" + std::to_string(v_cl.getProcessUnitID()) + ".trace.json");
+	BOOST_REQUIRE_EQUAL(ifs.is_open(),true);
+
+	prof.clear();
+	BOOST_REQUIRE_EQUAL(prof.getEvents().size(),0ul);
+}
+
+BOOST_AUTO_TEST_CASE( io_profiler_file_test )
+{
+	io_profiler & prof = get_io_profiler();
+	prof.clear();
+	prof.enable(true);
+
+	std::string header = "x,y\n";
+	std::string data = "1,2\n";
+
+	io_prof_scope p_encode("csv_encode");
+	BOOST_REQUIRE_EQUAL(io_prof_write_file("io_prof_file.csv",p_encode,"csv_flush",{header,data}),true);
+
+	io_prof_scope p_encode2("csv_encode");
+	BOOST_REQUIRE_EQUAL(io_prof_write_file("no_such_dir/io_prof_file.csv",p_encode2,"csv_flush",{header,data}),false);
+
+	// a stream that cannot be written record zero bytes
+
+	io_prof_scope p_encode3("vtk_encode");
+
+	std::ofstream ofs("/dev/full");
+	ofs << std::string(1024*1024,'a');
+
+	BOOST_REQUIRE_EQUAL(io_prof_close(ofs,p_encode3,"vtk_flush"),false);
+
+	prof.enable(false);
+
+	const openfpm::vector<io_event> & ev = prof.getEvents();
+
+	BOOST_REQUIRE(ev.size() >= 4ul);
+	BOOST_REQUIRE_EQUAL(ev.get(0).phase,std::string("csv_encode"));
+	BOOST_REQUIRE_EQUAL(ev.get(0).bytes,8ul);
+	BOOST_REQUIRE_EQUAL(ev.get(1).phase,std::string("csv_flush"));
+	BOOST_REQUIRE_EQUAL(ev.get(1).bytes,8ul);
+
+	for (size_t i = 0 ; i < ev.size() ; i++)
+	{BOOST_REQUIRE(ev.get(i).bytes <= 1024ul*1024ul);}
+
+	prof.clear();
+}
+
+BOOST_AUTO_TEST_CASE( graph_hdf5_save_load_test )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	typedef Graph_CSR<aggregate<float,size_t[3]>,aggregate<double,int>> graph_type;
+
+	graph_type g;
+
+	size_t rank = v_cl.getProcessUnitID();
+
+	// Every processor create a ring with a chord every 10 vertices
+
+	for (size_t i = 0 ; i < 100 ; i++)
+	{
+		g.addVertex();
+		g.vertex(i).template get<0>() = rank*1000.0 + i;
+		g.vertex(i).template get<1>()[0] = i;
+		g.vertex(i).template get<1>()[1] = 2*i;
+		g.vertex(i).template get<1>()[2] = rank;
+	}
+
+	for (size_t i = 0 ; i < 100 ; i++)
+	{
+		g.addEdge(i,(i+1)%100);
+		g.edge(g.getNEdge()-1).template get<0>() = 0.5*i;
+		g.edge(g.getNEdge()-1).template get<1>() = -(int)i;
+
+		if (i % 10 == 0)
+		{
+			g.addEdge(i,(i+50)%100);
+			g.edge(g.getNEdge()-1).template get<0>() = 1000.0 + i;
+			g.edge(g.getNEdge()-1).template get<1>() = i;
+		}
+	}
+
+	HDF5_writer<GRAPH_DIST> h5;
+	h5.save("graph.h5",g);
+
+	graph_type g2;
+
+	HDF5_reader<GRAPH_DIST> h5r;
+	bool ret = h5r.load("graph.h5",g2);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	// Same number of processors, every processor get back its graph
+
+	BOOST_REQUIRE_EQUAL(g2.getNVertex(),100ul);
+	BOOST_REQUIRE_EQUAL(g2.getNEdge(),110ul);
+
+	bool check = true;
+
+	for (size_t i = 0 ; i < 100 ; i++)
+	{
+		check &= (g2.vertex(i).template get<0>() == rank*1000.0f + i);
+		check &= (g2.vertex(i).template get<1>()[0] == i);
+		check &= (g2.vertex(i).template get<1>()[1] == 2*i);
+		check &= (g2.vertex(i).template get<1>()[2] == rank);
+	}
+
+	auto it = g2.getEdgeIterator();
+
+	while (it.isNext())
+	{
+		size_t s = it.source();
+		size_t t = it.target();
+
+		if (t == (s+1)%100)
+		{
+			check &= (g2.edge(it.get()).template get<0>() == 0.5*s);
+			check &= (g2.edge(it.get()).template get<1>() == -(int)s);
+		}
+		else
+		{
+			check &= (t == (s+50)%100 && s % 10 == 0);
+			check &= (g2.edge(it.get()).template get<0>() == 1000.0 + s);
+			check &= (g2.edge(it.get()).template get<1>() == (int)s);
+		}
+
+		++it;
+	}
+
+	BOOST_REQUIRE_EQUAL(check,true);
+}
+
+//! local grid used by the grid_dist tests
+typedef grid_cpu<2,aggregate<float,double[2]>> h5_test_grid;
+
+/*! \brief Create n local grids with a ghost of one point
+ *
+ * The domain of the grid i is 8 x (4+i) points, the grids of every processor have a different origin
+ *
+ * \param lg local grids
+ * \param gb boxes of the local grids
+ * \param n number of local grids
+ *
+ */
+inline void h5_test_fill_grids(openfpm::vector<h5_test_grid> & lg, openfpm::vector<GBoxes<2>> & gb, size_t n)
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	size_t rank = v_cl.getProcessUnitID();
+
+	for (size_t i = 0 ; i < n ; i++)
+	{
+		size_t sz[2] = {8+2,4+i+2};
+
+		h5_test_grid g(sz);
+		g.setMemory();
+
+		GBoxes<2> b;
+
+		for (size_t d = 0 ; d < 2 ; d++)
+		{
+			b.GDbox.setLow(d,0);
+			b.GDbox.setHigh(d,sz[d]-1);
+			b.Dbox.setLow(d,1);
+			b.Dbox.setHigh(d,sz[d]-2);
+		}
+
+		b.origin.get(0) = -1;
+		b.origin.get(1) = rank*1000 + i*100 - 1;
+		b.k = i;
+
+		auto it = g.getIterator();
+
+		while (it.isNext())
+		{
+			auto key = it.get();
+
+			g.template get<0>(key) = rank*1000.0 + i*100.0 + key.get(0) + 10.0*key.get(1);
+			g.template get<1>(key)[0] = i;
+			g.template get<1>(key)[1] = rank;
+
+			++it;
+		}
+
+		lg.add();
+		lg.last().swap(g);
+		gb.add(b);
+	}
+}
+
+/*! \brief Check that the loaded local grids are equal to the saved ones
+ *
+ * \param lg saved local grids
+ * \param gb saved boxes
+ * \param lg2 loaded local grids
+ * \param gb2 loaded boxes
+ *
+ */
+inline void h5_test_check_grids(const openfpm::vector<h5_test_grid> & lg, const openfpm::vector<GBoxes<2>> & gb,
+		                        const openfpm::vector<h5_test_grid> & lg2, openfpm::vector<GBoxes<2>> & gb2)
+{
+	BOOST_REQUIRE_EQUAL(lg2.size(),lg.size());
+	BOOST_REQUIRE_EQUAL(gb2.size(),gb.size());
+
+	bool check = true;
+
+	for (size_t i = 0 ; i < lg.size() ; i++)
+	{
+		check &= (gb2.get(i) == gb.get(i));
+		check &= (gb2.get(i).k == gb.get(i).k);
+
+		BOOST_REQUIRE_EQUAL(lg2.get(i).size(),lg.get(i).size());
+
+		auto it = lg.get(i).getIterator();
+
+		while (it.isNext())
+		{
+			auto key = it.get();
+
+			check &= (lg2.get(i).template get<0>(key) == lg.get(i).template get<0>(key));
+			check &= (lg2.get(i).template get<1>(key)[0] == lg.get(i).template get<1>(key)[0]);
+			check &= (lg2.get(i).template get<1>(key)[1] == lg.get(i).template get<1>(key)[1]);
+
+			++it;
+		}
+	}
+
+	BOOST_REQUIRE_EQUAL(check,true);
+}
+
+/*! \brief Number of elements of a dataset in a file (0 if the dataset does not exist)
+ *
+ * \param filename file
+ * \param name dataset
+ *
+ * \return the number of elements
+ *
+ */
+inline size_t h5_test_dataset_size(const std::string & filename, const std::string & name)
+{
+	hid_t file = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+	BOOST_REQUIRE(file >= 0);
+
+	size_t n = 0;
+
+	if (H5Lexists(file, name.c_str(), H5P_DEFAULT) > 0)
+	{
+		hid_t dataset = H5Dopen(file, name.c_str(), H5P_DEFAULT);
+		hid_t space = H5Dget_space(dataset);
+		n = H5Sget_select_npoints(space);
+		H5Sclose(space);
+		H5Dclose(dataset);
+	}
+
+	H5Fclose(file);
+
+	return n;
+}
+
+BOOST_AUTO_TEST_CASE( grid_dist_hdf5_delta_test )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	openfpm::vector<h5_test_grid> lg;
+	openfpm::vector<GBoxes<2>> gb;
+
+	h5_test_fill_grids(lg,gb,4);
+
+	HDF5_writer<GRID_DIST> h5;
+	h5.setPatchHash(true);
+	h5.save("grid_dist_base.h5",lg,gb);
+
+	// change two patches
+
+	grid_key_dx<2> key;
+	key.set_d(0,3);
+	key.set_d(1,2);
+
+	lg.get(1).template get<0>(key) = -1.0;
+	lg.get(3).template get<1>(key)[1] = -2.0;
+
+	h5.save_delta("grid_dist_delta.h5","grid_dist_base.h5",lg,gb);
+
+	// only the changed patches are saved
+
+	BOOST_REQUIRE(h5_test_dataset_size("grid_dist_delta.h5","base") != 0);
+	BOOST_REQUIRE_EQUAL(h5_test_dataset_size("grid_dist_delta.h5","delta_index"),2*v_cl.getProcessingUnits());
+
+	HDF5_reader<GRID_DIST> h5r;
+
+	openfpm::vector<h5_test_grid> lg2;
+	openfpm::vector<GBoxes<2>> gb2;
+
+	bool ret = h5r.load("grid_dist_delta.h5",lg2,gb2);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	h5_test_check_grids(lg,gb,lg2,gb2);
+}
+
+BOOST_AUTO_TEST_CASE( grid_dist_hdf5_delta_mismatch_test )
+{
+	openfpm::vector<h5_test_grid> lg;
+	openfpm::vector<GBoxes<2>> gb;
+
+	h5_test_fill_grids(lg,gb,4);
+
+	HDF5_writer<GRID_DIST> h5;
+	h5.setPatchHash(true);
+	h5.save("grid_dist_base_m.h5",lg,gb);
+
+	// with a different number of local grids a full checkpoint is saved
+
+	openfpm::vector<h5_test_grid> lg5;
+	openfpm::vector<GBoxes<2>> gb5;
+
+	h5_test_fill_grids(lg5,gb5,5);
+
+	h5.save_delta("grid_dist_delta_m.h5","grid_dist_base_m.h5",lg5,gb5);
+
+	BOOST_REQUIRE_EQUAL(h5_test_dataset_size("grid_dist_delta_m.h5","base"),0ul);
+	BOOST_REQUIRE_EQUAL(h5_test_dataset_size("grid_dist_delta_m.h5","delta_index"),0ul);
+	BOOST_REQUIRE_EQUAL(h5_test_dataset_size("grid_dist_delta_m.h5","patch_count"),0ul);
+
+	HDF5_reader<GRID_DIST> h5r;
+
+	openfpm::vector<h5_test_grid> lg2;
+	openfpm::vector<GBoxes<2>> gb2;
+
+	bool ret = h5r.load("grid_dist_delta_m.h5",lg2,gb2);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	h5_test_check_grids(lg5,gb5,lg2,gb2);
+
+	// a delta is not applied to a base that changed after the delta has been saved
+
+	grid_key_dx<2> key;
+	key.set_d(0,1);
+	key.set_d(1,1);
+
+	lg.get(3).template get<0>(key) = -1.0;
+
+	h5.save_delta("grid_dist_delta_m.h5","grid_dist_base_m.h5",lg,gb);
+	BOOST_REQUIRE(h5_test_dataset_size("grid_dist_delta_m.h5","base") != 0);
+
+	openfpm::vector<h5_test_grid> lg3;
+	openfpm::vector<GBoxes<2>> gb3;
+
+	h5_test_fill_grids(lg3,gb3,3);
+	h5.save("grid_dist_base_m.h5",lg3,gb3);
+
+	openfpm::vector<h5_test_grid> lg4;
+	openfpm::vector<GBoxes<2>> gb4;
+
+	ret = h5r.load("grid_dist_delta_m.h5",lg4,gb4);
+	BOOST_REQUIRE_EQUAL(ret,false);
+	BOOST_REQUIRE_EQUAL(lg4.size(),0ul);
+	BOOST_REQUIRE_EQUAL(gb4.size(),0ul);
+}
+
+/*! \brief Value of a point of the global grid (x + 100*y + 10000*z)
+ *
+ * \param key point of the local grid
+ * \param b boxes of the local grid
+ *
+ * \return the value
+ *
+ */
+template<unsigned int dim>
+inline float h5_test_global_value(const grid_key_dx<dim> & key, const GBoxes<dim> & b)
+{
+	float v = 0.0;
+	float m = 1.0;
+
+	for (size_t d = 0 ; d < dim ; d++)
+	{
+		v += (key.get(d) + b.origin.get(d))*m;
+		m *= 100.0;
+	}
+
+	return v;
+}
+
+/*! \brief Add a local grid with the domain [low,high] in global coordinates and a ghost
+ *
+ * \param lg local grids
+ * \param gb boxes of the local grids
+ * \param low first point of the domain
+ * \param high last point of the domain
+ * \param ghost size of the ghost
+ * \param fill fill the grid with h5_test_global_value (otherwise zero)
+ *
+ */
+template<unsigned int dim>
+inline void h5_test_add_global_grid(openfpm::vector<grid_cpu<dim,aggregate<float,double[2]>>> & lg, openfpm::vector<GBoxes<dim>> & gb,
+		                            const long int (& low)[dim], const long int (& high)[dim], long int ghost, bool fill)
+{
+	size_t sz[dim];
+
+	GBoxes<dim> b;
+
+	for (size_t d = 0 ; d < dim ; d++)
+	{
+		sz[d] = high[d] - low[d] + 1 + 2*ghost;
+
+		b.GDbox.setLow(d,0);
+		b.GDbox.setHigh(d,sz[d]-1);
+		b.Dbox.setLow(d,ghost);
+		b.Dbox.setHigh(d,sz[d]-1-ghost);
+		b.origin.get(d) = low[d] - ghost;
+	}
+
+	b.k = lg.size();
+
+	grid_cpu<dim,aggregate<float,double[2]>> g(sz);
+	g.setMemory();
+
+	auto it = g.getIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		g.template get<0>(key) = (fill == true)?h5_test_global_value(key,b):0.0;
+		g.template get<1>(key)[0] = (fill == true)?key.get(0) + b.origin.get(0):0.0;
+		g.template get<1>(key)[1] = (fill == true)?key.get(1) + b.origin.get(1):0.0;
+
+		++it;
+	}
+
+	lg.add();
+	lg.last().swap(g);
+	gb.add(b);
+}
+
+/*! \brief Check that the domain of the local grids contain h5_test_global_value and the ghost zero
+ *
+ * \param lg local grids
+ * \param gb boxes of the local grids
+ *
+ * \return true if the grids are correct
+ *
+ */
+template<unsigned int dim>
+inline bool h5_test_check_global_grids(const openfpm::vector<grid_cpu<dim,aggregate<float,double[2]>>> & lg, const openfpm::vector<GBoxes<dim>> & gb)
+{
+	bool check = true;
+
+	for (size_t i = 0 ; i < lg.size() ; i++)
+	{
+		auto it = lg.get(i).getIterator();
+
+		while (it.isNext())
+		{
+			auto key = it.get();
+
+			bool domain = true;
+
+			for (size_t d = 0 ; d < dim ; d++)
+			{domain &= (key.get(d) >= gb.get(i).Dbox.getLow(d) && key.get(d) <= gb.get(i).Dbox.getHigh(d));}
+
+			float v = (domain == true)?h5_test_global_value(key,gb.get(i)):0.0;
+			double x = (domain == true)?key.get(0) + gb.get(i).origin.get(0):0.0;
+			double y = (domain == true)?key.get(1) + gb.get(i).origin.get(1):0.0;
+
+			check &= (lg.get(i).template get<0>(key) == v);
+			check &= (lg.get(i).template get<1>(key)[0] == x);
+			check &= (lg.get(i).template get<1>(key)[1] == y);
+
+			++it;
+		}
+	}
+
+	return check;
+}
+
+/*! \brief Read a global dataset of a file saved with HDF5_GRID_GLOBAL
+ *
+ * \param filename file
+ * \param name dataset
+ * \param dims dimensions of the dataset
+ * \param buf values of the dataset
+ *
+ * \return the rank of the dataset
+ *
+ */
+template<typename T>
+inline int h5_test_read_global(const std::string & filename, const std::string & name, hsize_t * dims, std::vector<T> & buf)
+{
+	hid_t file = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+	BOOST_REQUIRE(file >= 0);
+
+	hid_t dataset = H5Dopen(file, name.c_str(), H5P_DEFAULT);
+	hid_t space = H5Dget_space(dataset);
+	int rank = H5Sget_simple_extent_dims(space,dims,NULL);
+	buf.resize(H5Sget_select_npoints(space));
+	H5Sclose(space);
+
+	hid_t tp = h5_type<T>::create();
+	H5Dread(dataset, tp, H5S_ALL, H5S_ALL, H5P_DEFAULT, buf.data());
+	H5Tclose(tp);
+
+	H5Dclose(dataset);
+	H5Fclose(file);
+
+	return rank;
+}
+
+BOOST_AUTO_TEST_CASE( grid_dist_hdf5_global_test )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	long int rank = v_cl.getProcessUnitID();
+	long int n_proc = v_cl.getProcessingUnits();
+
+	// every processor has the rows [6*rank,6*rank+5] of a 12 x 6*n_proc grid, split in two local grids
+
+	openfpm::vector<grid_cpu<2,aggregate<float,double[2]>>> lg;
+	openfpm::vector<GBoxes<2>> gb;
+
+	long int low_0[2] = {0,6*rank};
+	long int high_0[2] = {4,6*rank+5};
+	long int low_1[2] = {5,6*rank};
+	long int high_1[2] = {11,6*rank+5};
+
+	h5_test_add_global_grid<2>(lg,gb,low_0,high_0,1,true);
+	h5_test_add_global_grid<2>(lg,gb,low_1,high_1,1,true);
+
+	HDF5_writer<GRID_DIST> h5;
+	h5.save("grid_dist_global.h5",lg,gb,HDF5_GRID_GLOBAL);
+
+	// the datasets have the axes in reverse order, x is the fastest index
+
+	hsize_t dims[H5S_MAX_RANK];
+	std::vector<float> v;
+
+	BOOST_REQUIRE_EQUAL(h5_test_read_global("grid_dist_global.h5","grid_prp_0",dims,v),2);
+	BOOST_REQUIRE_EQUAL(dims[0],(hsize_t)(6*n_proc));
+	BOOST_REQUIRE_EQUAL(dims[1],12ul);
+
+	std::vector<double> xy;
+
+	BOOST_REQUIRE_EQUAL(h5_test_read_global("grid_dist_global.h5","grid_prp_1",dims,xy),3);
+	BOOST_REQUIRE_EQUAL(dims[2],2ul);
+
+	bool check = true;
+
+	for (long int y = 0 ; y < 6*n_proc ; y++)
+	{
+		for (long int x = 0 ; x < 12 ; x++)
+		{
+			check &= (v[y*12+x] == x + 100.0*y);
+			check &= (xy[(y*12+x)*2] == x);
+			check &= (xy[(y*12+x)*2+1] == y);
+		}
+	}
+
+	BOOST_REQUIRE_EQUAL(check,true);
+
+	// read back on a different decomposition, the box cross the grids and the processors
+
+	openfpm::vector<grid_cpu<2,aggregate<float,double[2]>>> lg2;
+	openfpm::vector<GBoxes<2>> gb2;
+
+	long int low_2[2] = {3,6*rank+2};
+	long int high_2[2] = {8,std::min(6*rank+9,6*n_proc-1)};
+
+	h5_test_add_global_grid<2>(lg2,gb2,low_2,high_2,2,false);
+
+	HDF5_reader<GRID_DIST> h5r;
+
+	bool ret = h5r.load_global("grid_dist_global.h5",lg2,gb2);
+	BOOST_REQUIRE_EQUAL(ret,true);
+	BOOST_REQUIRE_EQUAL(h5_test_check_global_grids(lg2,gb2),true);
+
+	// load create a grid without ghost for every saved domain
+
+	openfpm::vector<grid_cpu<2,aggregate<float,double[2]>>> lg3;
+	openfpm::vector<GBoxes<2>> gb3;
+
+	ret = h5r.load("grid_dist_global.h5",lg3,gb3);
+	BOOST_REQUIRE_EQUAL(ret,true);
+	BOOST_REQUIRE_EQUAL(lg3.size(),2ul);
+	BOOST_REQUIRE_EQUAL(h5_test_check_global_grids(lg3,gb3),true);
+}
+
+BOOST_AUTO_TEST_CASE( grid_dist_hdf5_global_3d_test )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	long int rank = v_cl.getProcessUnitID();
+	long int n_proc = v_cl.getProcessingUnits();
+
+	// every processor has the planes [2*rank,2*rank+1] of a 4 x 3 x 2*n_proc grid
+
+	openfpm::vector<grid_cpu<3,aggregate<float,double[2]>>> lg;
+	openfpm::vector<GBoxes<3>> gb;
+
+	long int low[3] = {0,0,2*rank};
+	long int high[3] = {3,2,2*rank+1};
+
+	h5_test_add_global_grid<3>(lg,gb,low,high,1,true);
+
+	HDF5_writer<GRID_DIST> h5;
+	h5.save("grid_dist_global_3d.h5",lg,gb,HDF5_GRID_GLOBAL);
+
+	hsize_t dims[H5S_MAX_RANK];
+	std::vector<float> v;
+
+	BOOST_REQUIRE_EQUAL(h5_test_read_global("grid_dist_global_3d.h5","grid_prp_0",dims,v),3);
+	BOOST_REQUIRE_EQUAL(dims[0],(hsize_t)(2*n_proc));
+	BOOST_REQUIRE_EQUAL(dims[1],3ul);
+	BOOST_REQUIRE_EQUAL(dims[2],4ul);
+
+	bool check = true;
+
+	for (long int z = 0 ; z < 2*n_proc ; z++)
+	{
+		for (long int y = 0 ; y < 3 ; y++)
+		{
+			for (long int x = 0 ; x < 4 ; x++)
+			{check &= (v[(z*3+y)*4+x] == x + 100.0*y + 10000.0*z);}
+		}
+	}
+
+	BOOST_REQUIRE_EQUAL(check,true);
+
+	// read a box that cross the planes of two processors
+
+	openfpm::vector<grid_cpu<3,aggregate<float,double[2]>>> lg2;
+	openfpm::vector<GBoxes<3>> gb2;
+
+	long int low_2[3] = {1,1,2*rank+1};
+	long int high_2[3] = {3,2,std::min(2*rank+2,2*n_proc-1)};
+
+	h5_test_add_global_grid<3>(lg2,gb2,low_2,high_2,1,false);
+
+	HDF5_reader<GRID_DIST> h5r;
+
+	bool ret = h5r.load_global("grid_dist_global_3d.h5",lg2,gb2);
+	BOOST_REQUIRE_EQUAL(ret,true);
+	BOOST_REQUIRE_EQUAL(h5_test_check_global_grids(lg2,gb2),true);
+}
+
+/*! Stress test of the chunked grid_dist checkpoint
+ *
+ * The processors have a different number of local grids (some none) and the maximum transfer
+ * is reduced to less than a local grid, so every processor read its block in a different
+ * number of chunks
+ *
+ */
+BOOST_AUTO_TEST_CASE( grid_dist_hdf5_chunked_test )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	openfpm::vector<h5_test_grid> lg;
+	openfpm::vector<GBoxes<2>> gb;
+
+	h5_test_fill_grids(lg,gb,(v_cl.getProcessUnitID() + 3) % 5);
+
+	HDF5_writer<GRID_DIST> h5;
+	h5.setMaxIOBytes(1000);
+	h5.save("grid_dist_chunked.h5",lg,gb);
+
+	HDF5_reader<GRID_DIST> h5r;
+	h5r.setMaxIOBytes(700);
+
+	openfpm::vector<h5_test_grid> lg2;
+	openfpm::vector<GBoxes<2>> gb2;
+
+	bool ret = h5r.load("grid_dist_chunked.h5",lg2,gb2);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	h5_test_check_grids(lg,gb,lg2,gb2);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 
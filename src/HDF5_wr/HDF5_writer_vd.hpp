@@ -11,19 +11,378 @@
 #include "Packer_Unpacker/Pack_selector.hpp"
 #include "Packer_Unpacker/Packer.hpp"
 #include "Packer_Unpacker/Unpacker.hpp"
+#include "HDF5_util.hpp"
+
+/*! \brief Layout of the vector_dist checkpoint
+ *
+ */
+enum hdf5_vd_layout
+{
+	//! positions and properties packed in a single byte dataset vector_dist
+	HDF5_PACKED,
+	//! positions and every property in its own typed dataset (position, property_N), written without copy
+	HDF5_COLUMNS
+};
+
+/*! \brief this class is a functor for "for_each" algorithm
+ *
+ * For each property of the vector it check if it can be stored in a typed dataset
+ *
+ * \tparam vector_type vector of positions or properties
+ *
+ */
+template<typename vector_type>
+struct h5_vd_check_column
+{
+	//! true if all the properties can be stored in a typed dataset
+	bool valid = true;
+
+	//! first property that cannot be stored
+	int prp = -1;
+
+	//! It check the property
+	template<typename T> void operator()(T& t)
+	{
+		typedef typename boost::mpl::at<typename vector_type::value_type::type,boost::mpl::int_<T::value>>::type ptype;
+
+		if (h5_prop_rows<ptype>::is_valid == false && valid == true)
+		{
+			valid = false;
+			prp = T::value;
+		}
+	}
+};
+
+/*! \brief this class is a functor for "for_each" algorithm
+ *
+ * For each property of the vector it write the typed dataset prefix + property id
+ * (or name if the vector has a single property)
+ *
+ * \tparam vector_type vector of positions or properties
+ *
+ */
+template<typename vector_type>
+struct h5_vd_write_column
+{
+	//! vector
+	const vector_type & v;
+
+	//! HDF5 file
+	hid_t file;
+
+	//! transfer property list
+	hid_t plist_id;
+
+	//! total number of particles
+	hsize_t tot;
+
+	//! offset of this processor
+	hsize_t off;
+
+	//! dataset name
+	std::string name;
+
+	//! compression
+	const h5_compression & cmp;
+
+	//! particles of every processor
+	const openfpm::vector<size_t> & blocks;
+
+	//! maximum bytes for a single transfer
+	size_t max_io = HDF5_MAX_IO_BYTES;
+
+	/*! \brief constructor
+	 *
+	 * \param v vector
+	 * \param file HDF5 file
+	 * \param plist_id transfer property list
+	 * \param tot total number of particles
+	 * \param off offset of this processor
+	 * \param name dataset name (property_ for property_0 property_1 ...)
+	 * \param cmp compression
+	 * \param blocks particles of every processor
+	 *
+	 */
+	h5_vd_write_column(const vector_type & v, hid_t file, hid_t plist_id, hsize_t tot, hsize_t off, const std::string & name,
+			           const h5_compression & cmp, const openfpm::vector<size_t> & blocks)
+	:v(v),file(file),plist_id(plist_id),tot(tot),off(off),name(name),cmp(cmp),blocks(blocks)
+	{}
+
+	//! It write the property
+	template<typename T> void operator()(T& t) const
+	{
+		typedef typename boost::mpl::at<typename vector_type::value_type::type,boost::mpl::int_<T::value>>::type ptype;
+
+		const vector_type & v = this->v;
+
+		std::string dname = (name.size() != 0 && name.back() == '_')?name + std::to_string(T::value):name;
+
+		// write directly from the memory of the vector, the property of the particle i
+		// is at a fixed stride from the one of the particle 0
+
+		size_t n = v.size();
+		const void * base = (n == 0)?NULL:(const void *)&v.template get<T::value>(0);
+		size_t stride = (n < 2)?sizeof(ptype):(const char *)&v.template get<T::value>(1) - (const char *)base;
+
+		h5_prop_rows<ptype>::write_strided(file,dname,tot,off,n,base,stride,plist_id,cmp,&blocks,max_io);
+	}
+};
 
 template <>
 class HDF5_writer<VECTOR_DIST>
 {
+	//! maximum number of bytes written by a single H5Dwrite
+	size_t max_io = HDF5_MAX_IO_BYTES;
+
+	//! compression of the datasets
+	h5_compression cmp;
+
+	//! processors that write the same file (0 single shared file)
+	size_t n_group = 0;
+
+	//! tuning of the file access
+	h5_io_options opt;
+
+	/*! \brief Save the bounding box of the particles of every processor
+	 *
+	 * block_bbox (processors x 2*dim) low and high corner of the particles saved by every
+	 * processor (low > high for an empty block), it is used on restart to read every block
+	 * on the processor that own its region
+	 *
+	 * \param file HDF5 file
+	 * \param plist_id transfer property list
+	 * \param v_pos positions
+	 * \param grp group of processors that write the file
+	 *
+	 */
+	template<typename vector_pos_type>
+	inline void save_bbox(hid_t file, hid_t plist_id, const vector_pos_type & v_pos, const h5_file_group & grp) const
+	{
+		const unsigned int dim = vector_pos_type::value_type::dims;
+
+		double bbox[2*dim];
+
+		for (size_t d = 0 ; d < dim ; d++)
+		{
+			bbox[d] = std::numeric_limits<double>::max();
+			bbox[dim+d] = -std::numeric_limits<double>::max();
+		}
+
+		for (size_t i = 0 ; i < v_pos.size() ; i++)
+		{
+			for (size_t d = 0 ; d < dim ; d++)
+			{
+				bbox[d] = std::min(bbox[d],(double)v_pos.template get<0>(i)[d]);
+				bbox[dim+d] = std::max(bbox[dim+d],(double)v_pos.template get<0>(i)[d]);
+			}
+		}
+
+		hsize_t row_dims[1] = {2*dim};
+		h5_write_rows(file,"block_bbox",H5T_NATIVE_DOUBLE,grp.size,grp.rank,1,1,row_dims,bbox,plist_id);
+	}
+
+	/*! \brief Save the positions and every property in its own typed dataset
+	 *
+	 * * position (particles x dim) positions
+	 * * property_N (particles x extents of the property) property N
+	 * * metadata number of particles of every processor
+	 *
+	 * \param filename file
+	 * \param v_pos positions
+	 * \param v_prp properties
+	 * \param grp group of processors that write the file
+	 *
+	 */
+	template<typename vector_pos_type, typename vector_prp_type>
+	inline void save_columns(const std::string & filename,
+			                 const vector_pos_type & v_pos,
+							 const vector_prp_type & v_prp,
+							 const h5_file_group & grp) const
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+		int mpi_rank = grp.rank;
+		int mpi_size = grp.size;
+
+		io_prof_scope p_gather("hdf5_allgather");
+
+		size_t n = v_pos.size();
+		openfpm::vector<size_t> sz_others;
+		v_cl.allGather(n,sz_others);
+		v_cl.execute();
+
+		p_gather.stop(sz_others.size()*sizeof(size_t));
+
+		grp.slice(sz_others);
+
+		size_t tot = 0;
+		size_t off = 0;
+
+		for (int i = 0 ; i < mpi_size ; i++)
+		{
+			if (i < mpi_rank)
+			{off += sz_others.get(i);}
+
+			tot += sz_others.get(i);
+		}
+
+		// Set up file access property list with parallel I/O access
+
+		io_prof_scope p_create("hdf5_create");
+
+		size_t bytes = tot * (sizeof(typename vector_pos_type::value_type) + sizeof(typename vector_prp_type::value_type));
+		hid_t plist_id = h5_create_fapl(grp.comm,opt,bytes);
+
+		// Create a new file collectively and release property list identifier.
+		hid_t file = H5Fcreate (grp.file(filename).c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, plist_id);
+		H5Pclose(plist_id);
+
+		if (file < 0)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error: cannot create the file " << filename << std::endl;
+			return;
+		}
+
+		//Create property list for collective dataset write.
+		plist_id = H5Pcreate(H5P_DATASET_XFER);
+		H5Pset_dxpl_mpio(plist_id, H5FD_MPIO_COLLECTIVE);
+
+		openfpm::vector<long long int> metadata;
+		metadata.resize(mpi_size);
+
+		for (int i = 0; i < mpi_size; i++)
+		{metadata.get(i) = sz_others.get(i);}
+
+		hsize_t fdim2[1] = {(size_t)mpi_size};
+		hid_t file_dataspace_id_2 = H5Screate_simple(1, fdim2, NULL);
+		hid_t file_dataset_2 = H5Dcreate (file, "metadata", H5T_NATIVE_LLONG, file_dataspace_id_2, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+
+		H5Dwrite(file_dataset_2, H5T_NATIVE_LLONG, H5S_ALL, H5S_ALL, plist_id, metadata.getPointer());
+
+		H5Dclose(file_dataset_2);
+		H5Sclose(file_dataspace_id_2);
+
+		p_create.stop();
+
+		io_prof_scope p_write("hdf5_write");
+
+		h5_vd_write_column<vector_pos_type> wpos(v_pos,file,plist_id,tot,off,"position",cmp,sz_others);
+		wpos.max_io = max_io;
+		boost::mpl::for_each_ref< boost::mpl::range_c<int,0,1> >(wpos);
+
+		h5_vd_write_column<vector_prp_type> wprp(v_prp,file,plist_id,tot,off,"property_",cmp,sz_others);
+		wprp.max_io = max_io;
+		boost::mpl::for_each_ref< boost::mpl::range_c<int,0,vector_prp_type::value_type::max_prop> >(wprp);
+
+		save_bbox(file,plist_id,v_pos,grp);
+
+		p_write.stop(n * (sizeof(typename vector_pos_type::value_type) + sizeof(typename vector_prp_type::value_type)));
+
+		io_prof_scope p_flush("hdf5_flush");
+
+		H5Pclose(plist_id);
+		H5Fclose(file);
+
+		p_flush.stop();
+
+		h5_write_index(filename,grp);
+	}
+
 public:
 
+	/*! \brief Set the maximum number of bytes written by a single H5Dwrite
+	 *
+	 * The default is 2GB (the limit of MPI-IO), smaller values are useful only to test
+	 *
+	 * \param max_io maximum number of bytes
+	 *
+	 */
+	void setMaxIOBytes(size_t max_io)
+	{
+		this->max_io = (max_io == 0)?1:std::min(max_io,(size_t)HDF5_MAX_IO_BYTES);
+	}
+
+	/*! \brief Compress the datasets with deflate (chunked datasets)
+	 *
+	 * The chunks are aligned to the blocks written by the processors. In parallel it
+	 * require HDF5 1.10.2 or later, with older versions the datasets are not compressed
+	 *
+	 * \param level deflate level (0 no compression, 1-9)
+	 * \param shuffle apply the shuffle filter before deflate
+	 *
+	 */
+	void setCompression(int level, bool shuffle = true)
+	{
+		cmp = h5_compression(level,shuffle);
+	}
+
+	/*! \brief Save one file for every group of processors instead of a single shared file
+	 *
+	 * Every group of n_proc consecutive processors write the file filename.N (N index of the
+	 * group) and filename become a small index of the files, that can be loaded like a single
+	 * file by any number of processors. With n_proc equal to the processors of a node the
+	 * checkpoint has one file for every node, with 1 one file for every processor
+	 *
+	 * \param n_proc processors of every group (0 single shared file, default)
+	 *
+	 */
+	void setFileGroup(size_t n_proc)
+	{
+		n_group = n_proc;
+	}
+
+	/*! \brief Set the MPI-IO hints, the alignment and the metadata options of the file
+	 *
+	 * \param opt tuning of the file access
+	 *
+	 */
+	void setIOOptions(const h5_io_options & opt)
+	{
+		this->opt = opt;
+	}
+
+	/*! \brief Save the positions and the properties
+	 *
+	 * With HDF5_COLUMNS the positions and every property are stored in their own typed dataset,
+	 * if a property cannot be stored in a typed dataset (for example it is a vector)
+	 * the packed layout is used. The typed datasets are written directly from the memory of the
+	 * vectors, so no pack buffer of the size of the checkpoint is allocated
+	 *
+	 * \param filename file
+	 * \param v_pos positions
+	 * \param v_prp properties
+	 * \param layout layout of the file
+	 *
+	 */
 	template<typename vector_pos_type, typename vector_prp_type>
 	inline void save(const std::string & filename,
 			         const vector_pos_type & v_pos,
-					 const vector_prp_type & v_prp) const
+					 const vector_prp_type & v_prp,
+					 hdf5_vd_layout layout = HDF5_PACKED) const
 	{
+		h5_file_group grp(n_group);
+
+		if (layout == HDF5_COLUMNS)
+		{
+			h5_vd_check_column<vector_pos_type> cpos;
+			boost::mpl::for_each_ref< boost::mpl::range_c<int,0,1> >(cpos);
+
+			h5_vd_check_column<vector_prp_type> cprp;
+			boost::mpl::for_each_ref< boost::mpl::range_c<int,0,vector_prp_type::value_type::max_prop> >(cprp);
+
+			if (cpos.valid == true && cprp.valid == true)
+			{
+				save_columns(filename,v_pos,v_prp,grp);
+				return;
+			}
+
+			std::cerr << __FILE__ << ":" << __LINE__ << " Warning: the property " << cprp.prp << " cannot be stored in a typed dataset, using the packed layout" << std::endl;
+		}
+
 		Vcluster<> & v_cl = create_vcluster();
 
+		io_prof_scope p_pack("hdf5_pack");
+
 		//Pack_request vector
 		size_t req = 0;
 
@@ -46,26 +405,18 @@ public:
 		Packer<typename std::remove_reference<decltype(v_pos)>::type,HeapMemory>::pack(mem,v_pos,sts);
 		Packer<typename std::remove_reference<decltype(v_prp)>::type,HeapMemory>::pack(mem,v_prp,sts);
 
+		p_pack.stop(pmem.size());
+
 		/*****************************************************************
 		 * Create a new file with default creation and access properties.*
 		 * Then create a dataset and write data to it and close the file *
 		 * and dataset.                                                  *
 		 *****************************************************************/
 
-		int mpi_rank = v_cl.getProcessUnitID();
-		int mpi_size = v_cl.getProcessingUnits();
-
-		MPI_Comm comm = v_cl.getMPIComm();
-		MPI_Info info  = MPI_INFO_NULL;
-
-		// Set up file access property list with parallel I/O access
-
-		hid_t plist_id = H5Pcreate(H5P_FILE_ACCESS);
-		H5Pset_fapl_mpio(plist_id, comm, info);
+		int mpi_rank = grp.rank;
+		int mpi_size = grp.size;
 
-		// Create a new file collectively and release property list identifier.
-		hid_t file = H5Fcreate (filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, plist_id);
-		H5Pclose(plist_id);
+		io_prof_scope p_gather("hdf5_allgather");
 
 		size_t sz = pmem.size();
 		//std::cout << "Pmem.size: " << pmem.size() << std::endl;
@@ -73,11 +424,25 @@ public:
 		v_cl.allGather(sz,sz_others);
 		v_cl.execute();
 
+		p_gather.stop(sz_others.size()*sizeof(size_t));
+
+		grp.slice(sz_others);
+
 		size_t sum = 0;
 
 		for (size_t i = 0; i < sz_others.size(); i++)
 			sum += sz_others.get(i);
 
+		// Set up file access property list with parallel I/O access
+
+		io_prof_scope p_create("hdf5_create");
+
+		hid_t plist_id = h5_create_fapl(grp.comm,opt,sum);
+
+		// Create a new file collectively and release property list identifier.
+		hid_t file = H5Fcreate (grp.file(filename).c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, plist_id);
+		H5Pclose(plist_id);
+
 		//Size for data space in file
 		hsize_t fdim[1] = {sum};
 
@@ -90,74 +455,69 @@ public:
 		//Create data space in file
 		hid_t file_dataspace_id_2 = H5Screate_simple(1, fdim2, NULL);
 
-		//Size for data space in memory
-		hsize_t mdim[1] = {pmem.size()};
-
-		//Create data space in memory
-		hid_t mem_dataspace_id = H5Screate_simple(1, mdim, NULL);
-
-		//Create data set in file
-		hid_t file_dataset = H5Dcreate (file, "vector_dist", H5T_NATIVE_CHAR, file_dataspace_id, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+		//Create data set in file (chunked and compressed if requested)
+		hid_t dcpl_id = h5_compression_dcpl(cmp,sum,0,NULL,1,sz_others);
+		hid_t file_dataset = H5Dcreate (file, "vector_dist", H5T_NATIVE_CHAR, file_dataspace_id, H5P_DEFAULT, dcpl_id, H5P_DEFAULT);
+		h5_close_dcpl(dcpl_id);
 
-		//Create data set 2 in file
-		hid_t file_dataset_2 = H5Dcreate (file, "metadata", H5T_NATIVE_INT, file_dataspace_id_2, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+		//Create data set 2 in file (64 bit sizes)
+		hid_t file_dataset_2 = H5Dcreate (file, "metadata", H5T_NATIVE_LLONG, file_dataspace_id_2, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
 
-		//H5Pclose(plist_id);
 		H5Sclose(file_dataspace_id);
 		H5Sclose(file_dataspace_id_2);
 
-		hsize_t block[1] = {pmem.size()};
+		p_create.stop();
 
-		//hsize_t stride[1] = {1};
-
-		hsize_t count[1] = {1};
-
-		hsize_t offset[1] = {0};
+		hsize_t offset = 0;
 
 		for (int i = 0; i < mpi_rank; i++)
-		{
-			if (mpi_rank == 0)
-			{
-				/* coverity[dead_error_line] */
-				offset[0] = 0;
-			}
-			else
-			{offset[0] += sz_others.get(i);}
-		}
+		{offset += sz_others.get(i);}
 
-		int metadata[mpi_size];
+		// metadata can be large with many processors, keep it on the heap
 
-		for (int i = 0; i < mpi_size; i++)
-			metadata[i] = sz_others.get(i);
+		openfpm::vector<long long int> metadata;
+		metadata.resize(mpi_size);
 
-		//Select hyperslab in the file.
-		file_dataspace_id = H5Dget_space(file_dataset);
-		H5Sselect_hyperslab(file_dataspace_id, H5S_SELECT_SET, offset, NULL, count, block);
+		// every processor must do the same number of collective writes
 
-		file_dataspace_id_2 = H5Dget_space(file_dataset_2);
+		size_t n_chunk = 0;
 
+		for (int i = 0; i < mpi_size; i++)
+		{
+			metadata.get(i) = sz_others.get(i);
+			n_chunk = std::max(n_chunk,h5_n_chunks(sz_others.get(i),max_io));
+		}
 
 		//Create property list for collective dataset write.
 		plist_id = H5Pcreate(H5P_DATASET_XFER);
 		H5Pset_dxpl_mpio(plist_id, H5FD_MPIO_COLLECTIVE);
 
-		//Write a data set to a file
-		H5Dwrite(file_dataset, H5T_NATIVE_CHAR, mem_dataspace_id, file_dataspace_id, plist_id, (const char *)pmem.getPointer());
+		io_prof_scope p_write("hdf5_write");
+
+		// We slipt the write in chunk of max_io (2GB) maximum
+		h5_write_bytes(file_dataset,offset,pmem.size(),n_chunk,(const char *)pmem.getPointer(),plist_id,max_io);
 
 		//Write a data set 2 to a file
-		H5Dwrite(file_dataset_2, H5T_NATIVE_INT, H5S_ALL, file_dataspace_id_2, plist_id, metadata);
+		H5Dwrite(file_dataset_2, H5T_NATIVE_LLONG, H5S_ALL, H5S_ALL, plist_id, metadata.getPointer());
+
+		save_bbox(file,plist_id,v_pos,grp);
 
+		p_write.stop(pmem.size());
+
+		io_prof_scope p_flush("hdf5_flush");
 
 		//Close/release resources.
 		H5Dclose(file_dataset);
-		H5Sclose(file_dataspace_id);
 		H5Dclose(file_dataset_2);
-		H5Sclose(file_dataspace_id_2);
-		H5Sclose(mem_dataspace_id);
 		H5Pclose(plist_id);
 		H5Fclose(file);
+
+		p_flush.stop();
+
 		mem.decRef();
 		delete &mem;
+
+		h5_write_index(filename,grp);
 	}
 
 	/*! \brief Return the equivalent HDF5 type for T
@@ -14,6 +14,7 @@
 #include <boost/fusion/include/for_each.hpp>
 #include <fstream>
 #include "util/common.hpp"
+#include "util/io_profiler.hpp"
 
 /*! \brief Get the type Old
  *
@@ -128,7 +129,21 @@ public:
 enum file_type
 {
 	BINARY,
-	ASCII
+	ASCII,
+	//! raw binary in the AppendedData section (only for the XML image writers)
+	APPENDED
+};
+
+/*! \brief It specify where the grid properties are located in the VTK output
+ *
+ */
+
+enum vtk_data_location
+{
+	//! the properties are defined on the nodes
+	POINT_DATA,
+	//! every node is the center of a cell and the properties are defined on the cells
+	CELL_DATA
 };
 
 #define VTK_GRAPH 1
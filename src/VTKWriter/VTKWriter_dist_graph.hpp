@@ -8,7 +8,9 @@
 #ifndef VTKWRITER_DIST_GRAPH_HPP_
 #define VTKWRITER_DIST_GRAPH_HPP_
 
+#include <unordered_map>
 #include "VCluster/VCluster.hpp"
+#include "VTKWriter_xml_util.hpp"
 
 /*! Property data store for scalar and vector
  *
@@ -1122,6 +1124,288 @@ class VTKWriter<Graph, DIST_GRAPH>
 		return e_out;
 	}
 
+	/*! \brief Send the messages in send to the processors prc (empty messages are skipped)
+	 *
+	 * \param send one message for each processor in prc
+	 * \param prc processors
+	 * \param recv received messages (concatenated)
+	 * \param prc_recv processors from where the messages come
+	 * \param sz_recv size of each received message
+	 *
+	 */
+	void exchange(openfpm::vector<openfpm::vector<size_t>> & send,
+				  openfpm::vector<size_t> & prc,
+				  openfpm::vector<size_t> & recv,
+				  openfpm::vector<size_t> & prc_recv,
+				  openfpm::vector<size_t> & sz_recv)
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+		openfpm::vector<openfpm::vector<size_t>> send_nz;
+		openfpm::vector<size_t> prc_nz;
+
+		for (size_t i = 0 ; i < send.size() ; i++)
+		{
+			if (send.get(i).size() == 0)
+			{continue;}
+
+			send_nz.add(send.get(i));
+			prc_nz.add(prc.get(i));
+		}
+
+		recv.clear();
+		prc_recv.clear();
+		sz_recv.clear();
+
+		v_cl.SSendRecv(send_nz,recv,prc_nz,prc_recv,sz_recv);
+	}
+
+	/*! \brief Resolve the targets of the edges that are not in this processor
+	 *
+	 * Every processor register its vertices (id, gid, global index) in a directory distributed
+	 * by id modulo the number of processors, the targets that are not local are requested to
+	 * the directory. No processor store more than its part of the graph
+	 *
+	 * \param n_own number of vertices owned by this processor
+	 * \param offset global index of the first vertex of this processor
+	 * \param loc map from id to local index of the owned vertices
+	 * \param remote filled with id -> (gid, global index) of the remote targets
+	 *
+	 */
+	void resolve_remote_targets(size_t n_own,
+								size_t offset,
+								const std::unordered_map<size_t,size_t> & loc,
+								std::unordered_map<size_t,std::pair<size_t,size_t>> & remote)
+	{
+		Vcluster<> & v_cl = create_vcluster();
+		size_t n_proc = v_cl.getProcessingUnits();
+
+		openfpm::vector<size_t> prc;
+		openfpm::vector<openfpm::vector<size_t>> send;
+		openfpm::vector<size_t> recv;
+		openfpm::vector<size_t> prc_recv;
+		openfpm::vector<size_t> sz_recv;
+
+		for (size_t i = 0 ; i < n_proc ; i++)
+		{prc.add(i);}
+
+		// register the owned vertices in the directory
+
+		send.resize(n_proc);
+
+		for (size_t i = 0 ; i < n_own ; i++)
+		{
+			size_t id = g.getVertexId(i);
+			openfpm::vector<size_t> & msg = send.get(id % n_proc);
+
+			msg.add(id);
+			msg.add(g.getVertexGlobalId(i));
+			msg.add(offset + i);
+		}
+
+		exchange(send,prc,recv,prc_recv,sz_recv);
+
+		std::unordered_map<size_t,std::pair<size_t,size_t>> dir;
+
+		for (size_t k = 0 ; k + 2 < recv.size() ; k += 3)
+		{dir[recv.get(k)] = std::pair<size_t,size_t>(recv.get(k+1),recv.get(k+2));}
+
+		// request the targets that are not local
+
+		openfpm::vector<openfpm::vector<size_t>> req;
+		req.resize(n_proc);
+
+		auto it = g.getEdgeIterator();
+
+		while (it.isNext())
+		{
+			size_t trg = it.target();
+
+			if ((size_t)it.source() < n_own && loc.find(trg) == loc.end() && remote.find(trg) == remote.end())
+			{
+				remote[trg] = std::pair<size_t,size_t>(0,0);
+				req.get(trg % n_proc).add(trg);
+			}
+
+			++it;
+		}
+
+		exchange(req,prc,recv,prc_recv,sz_recv);
+
+		// answer with gid and global index
+
+		openfpm::vector<openfpm::vector<size_t>> ans;
+		openfpm::vector<size_t> prc_ans = prc_recv;
+		ans.resize(prc_recv.size());
+
+		size_t k = 0;
+
+		for (size_t j = 0 ; j < prc_recv.size() ; j++)
+		{
+			for (size_t s = 0 ; s < sz_recv.get(j) ; s++, k++)
+			{
+				auto f = dir.find(recv.get(k));
+
+				if (f == dir.end())
+				{
+					std::cerr << __FILE__ << ":" << __LINE__ << " error the vertex with id " << recv.get(k) << " does not exist\n";
+					ans.get(j).add(0);
+					ans.get(j).add(0);
+					continue;
+				}
+
+				ans.get(j).add(f->second.first);
+				ans.get(j).add(f->second.second);
+			}
+		}
+
+		exchange(ans,prc_ans,recv,prc_recv,sz_recv);
+
+		k = 0;
+
+		for (size_t j = 0 ; j < prc_recv.size() ; j++)
+		{
+			const openfpm::vector<size_t> & asked = req.get(prc_recv.get(j));
+
+			for (size_t s = 0 ; s < sz_recv.get(j) / 2 ; s++, k += 2)
+			{remote[asked.get(s)] = std::pair<size_t,size_t>(recv.get(k),recv.get(k+1));}
+		}
+	}
+
+	/*! \brief Write the piece of this processor (.vtp)
+	 *
+	 * The piece contain the owned vertices, the edges that start from them and a copy
+	 * (marked in vtkGhostType) of the remote targets
+	 *
+	 * \tparam prp which properties to output
+	 *
+	 * \param file path where to write
+	 * \param n_own number of owned vertices
+	 * \param offset global index of the first vertex of this processor
+	 * \param remote id -> (gid, global index) of the remote targets
+	 * \param v_arrs filled with the vertex data arrays
+	 * \param e_arrs filled with the edge data arrays
+	 * \param ft file type
+	 *
+	 * \return true if the file has been written
+	 *
+	 */
+	template<int prp> bool write_piece(const std::string & file,
+									   size_t n_own,
+									   size_t offset,
+									   const std::unordered_map<size_t,std::pair<size_t,size_t>> & remote,
+									   openfpm::vector<vtk_xml_data_array> & v_arrs,
+									   openfpm::vector<vtk_xml_data_array> & e_arrs,
+									   file_type ft)
+	{
+		io_prof_scope p_encode("vtk_encode");
+
+		vtk_xml_data_array points;
+		vtk_xml_data_array ids;
+		vtk_xml_data_array gids;
+		vtk_xml_data_array gidx;
+		vtk_xml_data_array ghost;
+		vtk_xml_data_array connectivity;
+		vtk_xml_data_array offsets;
+
+		vtk_xml_graph_points(points,g,ft);
+		vtk_xml_graph_fill<prp>(v_arrs,e_arrs,g,ft,n_own);
+
+		ids.template init<size_t>("id",1,ft);
+		gids.template init<size_t>("gid",1,ft);
+		gidx.template init<size_t>("global_index",1,ft);
+		ghost.template init<unsigned char>("vtkGhostType",1,ft);
+
+		for (size_t i = 0 ; i < g.getNVertex() ; i++)
+		{
+			size_t id = g.getVertexId(i);
+
+			ids.add(id);
+
+			if (i < n_own)
+			{
+				gids.add((size_t)g.getVertexGlobalId(i));
+				gidx.add(offset + i);
+				ghost.add((unsigned char)0);
+			}
+			else
+			{
+				auto f = remote.find(id);
+
+				gids.add((size_t)g.getVertexGlobalId(i));
+				gidx.add((f == remote.end())?(size_t)0:f->second.second);
+
+				// duplicate point
+				ghost.add((unsigned char)1);
+			}
+		}
+
+		openfpm::vector<long int> conn;
+		openfpm::vector<long int> off;
+
+		auto it = g.getEdgeIterator();
+
+		while (it.isNext())
+		{
+			if ((size_t)it.source() < n_own)
+			{
+				conn.add(it.source());
+				conn.add(g.nodeById(it.target()));
+				off.add(conn.size());
+			}
+
+			++it;
+		}
+
+		connectivity.template init<long int>("connectivity",1,ft);
+		offsets.template init<long int>("offsets",1,ft);
+
+		if (off.size() != 0)
+		{
+			connectivity.add_block(&conn.get(0),conn.size());
+			offsets.add_block(&off.get(0),off.size());
+		}
+
+		std::ofstream ofs(file);
+
+		// Check if the file is open
+		if (ofs.is_open() == false)
+		{
+			std::cerr << "Error cannot create the VTK file: " + file + "\n";
+			return false;
+		}
+
+		std::string appended;
+
+		ofs << "<VTKFile type=\"PolyData\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\">\n";
+		ofs << "  <PolyData>\n";
+		ofs << "    <Piece NumberOfPoints=\"" << g.getNVertex() << "\" NumberOfVerts=\"0\" NumberOfLines=\"" << off.size()
+			<< "\" NumberOfStrips=\"0\" NumberOfPolys=\"0\">\n";
+		ofs << "      <PointData>\n";
+		ids.write(ofs,"        ",appended);
+		gids.write(ofs,"        ",appended);
+		gidx.write(ofs,"        ",appended);
+		ghost.write(ofs,"        ",appended);
+		vtk_xml_write_arrays(ofs,v_arrs,"        ",appended);
+		ofs << "      </PointData>\n";
+		ofs << "      <CellData>\n";
+		vtk_xml_write_arrays(ofs,e_arrs,"        ",appended);
+		ofs << "      </CellData>\n";
+		ofs << "      <Points>\n";
+		points.write(ofs,"        ",appended);
+		ofs << "      </Points>\n";
+		ofs << "      <Lines>\n";
+		connectivity.write(ofs,"        ",appended);
+		offsets.write(ofs,"        ",appended);
+		ofs << "      </Lines>\n";
+		ofs << "    </Piece>\n";
+		ofs << "  </PolyData>\n";
+		vtk_xml_write_appended(ofs,appended);
+		ofs << "</VTKFile>\n";
+
+		return io_prof_close(ofs,p_encode,"vtk_flush");
+	}
+
 public:
 
 	/*!
@@ -1164,8 +1448,12 @@ public:
 
 		g.sync();
 
+		bool ret = true;
+
 		if (v_cl.getProcessUnitID() == 0)
 		{
+			io_prof_scope p_encode("vtk_encode");
+
 			// Check that the Vertex type define x y and z attributes
 
 			if (has_attributes<typename Graph::V_type>::value == false)
@@ -1263,26 +1551,119 @@ public:
 				boost::mpl::for_each<boost::mpl::range_c<int, prp, prp> >(ep);
 
 			// write the file
-			std::ofstream ofs(file);
-
-			// Check if the file is open
-			if (ofs.is_open() == false)
-			{
-				std::cerr << "Error cannot create the VTK file: " + file;
-			}
+			ret = io_prof_write_file(file,p_encode,"vtk_flush",{vtk_header,point_prop_header,point_list,vertex_prop_header,vertex_list,edge_prop_header,
+			                                                    edge_list,point_data_header,point_ids,point_data,cell_data_header,cell_data});
+		}
 
-			ofs << vtk_header << point_prop_header << point_list << vertex_prop_header << vertex_list << edge_prop_header << edge_list << point_data_header << point_ids << point_data << cell_data_header << cell_data;
+		g.deleteGhosts();
 
-			// Close the file
+		return ret;
+	}
 
-			ofs.close();
+	/*! \brief Write the graph in parallel without gathering it
+	 *
+	 * Must be called by all processors. Every processor write its vertices and the edges that
+	 * start from them in file_<rank>.vtp (VTK XML PolyData), the remote targets of the edges are
+	 * fetched as ghost and written as duplicated points. The vertices are numbered globally
+	 * (global_index) with a prefix scan of the number of vertices of each processor.
+	 * Processor 0 write file.pvtp that collect all the pieces
+	 *
+	 * \tparam prp which properties to output [default = -1 (all)]
+	 *
+	 * \param file path where to write (without extension)
+	 * \param ft specify if it is a BINARY, APPENDED or ASCII file [default = BINARY]
+	 *
+	 * \return true if it succeed
+	 *
+	 */
+	template<int prp = -1> bool write_pvtp(std::string file, file_type ft = file_type::BINARY)
+	{
+		// Check that the Vertex type define x y and z attributes
 
+		if (has_attributes<typename Graph::V_type>::value == false)
+		{
+			std::cerr << "Error writing a graph: Vertex must has defines x,y,z properties" << "\n";
+			return false;
 		}
 
+		Vcluster<> & v_cl = create_vcluster();
+
+		g.deleteGhosts();
+
+		size_t n_own = g.getNVertex();
+
+		// prefix scan of the number of vertices
+
+		openfpm::vector<size_t> n_vtx;
+		v_cl.allGather(n_own,n_vtx);
+		v_cl.execute();
+
+		size_t offset = 0;
+
+		for (size_t i = 0 ; i < v_cl.getProcessUnitID() ; i++)
+		{offset += n_vtx.get(i);}
+
+		std::unordered_map<size_t,size_t> loc;
+
+		for (size_t i = 0 ; i < n_own ; i++)
+		{loc[g.getVertexId(i)] = i;}
+
+		std::unordered_map<size_t,std::pair<size_t,size_t>> remote;
+		resolve_remote_targets(n_own,offset,loc,remote);
+
+		// get the remote targets as ghost
+
+		for (auto & r : remote)
+		{g.reqVertex(r.second.first);}
+
+		g.sync();
+
+		openfpm::vector<vtk_xml_data_array> v_arrs;
+		openfpm::vector<vtk_xml_data_array> e_arrs;
+
+		bool ret = write_piece<prp>(file + "_" + std::to_string(v_cl.getProcessUnitID()) + ".vtp",n_own,offset,remote,v_arrs,e_arrs,ft);
+
 		g.deleteGhosts();
 
-		// Completed succefully
-		return true;
+		if (v_cl.getProcessUnitID() != 0)
+		{return ret;}
+
+		std::ofstream ofs(file + ".pvtp");
+
+		// Check if the file is open
+		if (ofs.is_open() == false)
+		{
+			std::cerr << "Error cannot create the VTK file: " + file + ".pvtp\n";
+			return false;
+		}
+
+		std::string base = vtk_xml_basename(file);
+
+		ofs << "<VTKFile type=\"PPolyData\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\">\n";
+		ofs << "  <PPolyData GhostLevel=\"1\">\n";
+		ofs << "    <PPointData>\n";
+		ofs << "      <PDataArray type=\"UInt64\" Name=\"id\"/>\n";
+		ofs << "      <PDataArray type=\"UInt64\" Name=\"gid\"/>\n";
+		ofs << "      <PDataArray type=\"UInt64\" Name=\"global_index\"/>\n";
+		ofs << "      <PDataArray type=\"UInt8\" Name=\"vtkGhostType\"/>\n";
+		vtk_xml_write_parrays(ofs,v_arrs,"      ");
+		ofs << "    </PPointData>\n";
+		ofs << "    <PCellData>\n";
+		vtk_xml_write_parrays(ofs,e_arrs,"      ");
+		ofs << "    </PCellData>\n";
+		ofs << "    <PPoints>\n";
+		ofs << "      <PDataArray type=\"" << getTypeNew<typename Graph::V_type::s_type>() << "\" NumberOfComponents=\"3\"/>\n";
+		ofs << "    </PPoints>\n";
+
+		for (size_t i = 0 ; i < v_cl.getProcessingUnits() ; i++)
+		{ofs << "    <Piece Source=\"" << base << "_" << i << ".vtp\"/>\n";}
+
+		ofs << "  </PPolyData>\n";
+		ofs << "</VTKFile>\n";
+
+		ofs.close();
+
+		return ret;
 	}
 };
 
@@ -8,6 +8,9 @@
 #ifndef VTKWRITER_GRAPH_HPP_
 #define VTKWRITER_GRAPH_HPP_
 
+#include <climits>
+#include "VTKWriter_xml_util.hpp"
+
 /*! Property data store for scalar and vector
  *
  */
@@ -907,6 +910,245 @@ struct prop_out_edge
 	}
 };
 
+/*! \brief Return the name of the property i of T for the XML output
+ *
+ * \tparam T vertex or edge type
+ * \tparam has_attr true if T define the attributes names
+ *
+ */
+template<typename T, bool has_attr>
+struct vtk_xml_graph_attr_name
+{
+	/*! \brief Get the name of the property
+	 *
+	 * \param i property id
+	 *
+	 * \return the name of the property
+	 *
+	 */
+	static std::string get(size_t i)
+	{
+		return T::attributes::name[i];
+	}
+};
+
+/*! \brief Return the name of the property i of T for the XML output
+ *
+ * Case where T does not define the attributes names
+ *
+ */
+template<typename T>
+struct vtk_xml_graph_attr_name<T,false>
+{
+	/*! \brief Get the name of the property
+	 *
+	 * \param i property id
+	 *
+	 * \return the name of the property
+	 *
+	 */
+	static std::string get(size_t i)
+	{
+		return std::string("attr" + std::to_string(i));
+	}
+};
+
+/*! \brief this class is a functor for "for_each" algorithm
+ *
+ * For each vertex property it fill a data array with the property of all the vertices
+ * (column-wise, one property at time)
+ *
+ * \tparam Graph graph we are processing
+ *
+ */
+template<typename Graph>
+struct vtk_xml_graph_vertex_column
+{
+	//! arrays one for each property
+	openfpm::vector<vtk_xml_data_array> & arrs;
+
+	//! Graph that we are processing
+	const Graph & g;
+
+	//! file type
+	file_type ft;
+
+	/*! \brief constructor
+	 *
+	 * \param arrs data arrays
+	 * \param g graph to output
+	 * \param ft file type
+	 *
+	 */
+	vtk_xml_graph_vertex_column(openfpm::vector<vtk_xml_data_array> & arrs, const Graph & g, file_type ft)
+	:arrs(arrs),g(g),ft(ft)
+	{}
+
+	//! It fill the data array of the property T
+	template<typename T> void operator()(T& t) const
+	{
+		typedef typename boost::mpl::at<typename Graph::V_type::type,boost::mpl::int_<T::value>>::type ptype;
+		typedef vtk_xml_prop<ptype> xprop;
+
+		if (xprop::writable == false)
+		{return;}
+
+		vtk_xml_data_array & arr = arrs.get(T::value);
+
+		arr.template init<typename xprop::base>(vtk_xml_graph_attr_name<typename Graph::V_type,has_attributes<typename Graph::V_type>::value>::get(T::value),xprop::n_comp,ft);
+		arr.template reserve<typename xprop::base>(g.getNVertex()*xprop::n_comp);
+
+		auto it = g.getVertexIterator();
+
+		while (it.isNext())
+		{
+			xprop::add(arr,g.vertex(it.get()).template get<T::value>());
+
+			++it;
+		}
+	}
+};
+
+/*! \brief this class is a functor for "for_each" algorithm
+ *
+ * For each edge property it fill a data array with the property of all the edges
+ * (column-wise, one property at time)
+ *
+ * \tparam Graph graph we are processing
+ *
+ */
+template<typename Graph>
+struct vtk_xml_graph_edge_column
+{
+	//! arrays one for each property
+	openfpm::vector<vtk_xml_data_array> & arrs;
+
+	//! Graph that we are processing
+	const Graph & g;
+
+	//! file type
+	file_type ft;
+
+	//! only the edges with source vertex smaller than n_src are written
+	size_t n_src;
+
+	/*! \brief constructor
+	 *
+	 * \param arrs data arrays
+	 * \param g graph to output
+	 * \param ft file type
+	 * \param n_src only the edges with source vertex smaller than n_src are written
+	 *
+	 */
+	vtk_xml_graph_edge_column(openfpm::vector<vtk_xml_data_array> & arrs, const Graph & g, file_type ft, size_t n_src)
+	:arrs(arrs),g(g),ft(ft),n_src(n_src)
+	{}
+
+	//! It fill the data array of the property T
+	template<typename T> void operator()(T& t) const
+	{
+		typedef typename boost::mpl::at<typename Graph::E_type::type,boost::mpl::int_<T::value>>::type ptype;
+		typedef vtk_xml_prop<ptype> xprop;
+
+		if (xprop::writable == false)
+		{return;}
+
+		vtk_xml_data_array & arr = arrs.get(T::value);
+
+		arr.template init<typename xprop::base>(vtk_xml_graph_attr_name<typename Graph::E_type,has_attributes<typename Graph::E_type>::value>::get(T::value),xprop::n_comp,ft);
+		arr.template reserve<typename xprop::base>(g.getNEdge()*xprop::n_comp);
+
+		// same order used for the connectivity
+
+		auto it = g.getEdgeIterator();
+
+		while (it.isNext())
+		{
+			if ((size_t)it.source() < n_src)
+			{xprop::add(arr,g.edge(it.get()).template get<T::value>());}
+
+			++it;
+		}
+	}
+};
+
+/*! \brief Fill the point and the cell data arrays of a graph (column-wise)
+ *
+ * \tparam prp property to write (-1 all)
+ * \tparam Graph graph type
+ *
+ * \param v_arrs vertex data arrays (one for each vertex property)
+ * \param e_arrs edge data arrays (one for each edge property)
+ * \param g graph
+ * \param ft file type
+ * \param n_src only the edges with source vertex smaller than n_src are written [default = all]
+ *
+ */
+template<int prp, typename Graph>
+void vtk_xml_graph_fill(openfpm::vector<vtk_xml_data_array> & v_arrs,
+						openfpm::vector<vtk_xml_data_array> & e_arrs,
+						const Graph & g,
+						file_type ft,
+						size_t n_src = (size_t)-1)
+{
+	v_arrs.clear();
+	v_arrs.resize(Graph::V_type::max_prop);
+	e_arrs.clear();
+	e_arrs.resize(Graph::E_type::max_prop);
+
+	vtk_xml_graph_vertex_column<Graph> vc(v_arrs,g,ft);
+	vtk_xml_graph_edge_column<Graph> ec(e_arrs,g,ft,n_src);
+
+	if (prp == -1)
+	{
+		boost::mpl::for_each< boost::mpl::range_c<int,0,Graph::V_type::max_prop> >(vc);
+		boost::mpl::for_each< boost::mpl::range_c<int,0,Graph::E_type::max_prop> >(ec);
+	}
+	else
+	{
+		boost::mpl::for_each< boost::mpl::range_c<int,(prp < 0)?0:prp,(prp < 0)?0:prp+1> >(vc);
+		boost::mpl::for_each< boost::mpl::range_c<int,(prp < 0)?0:prp,(prp < 0)?0:prp+1> >(ec);
+	}
+}
+
+/*! \brief Fill the Points data array with the position of the vertices
+ *
+ * The position is taken from the x,y,z attributes like the legacy writer
+ *
+ * \tparam Graph graph type
+ *
+ * \param points data array
+ * \param g graph
+ * \param ft file type
+ *
+ */
+template<typename Graph>
+void vtk_xml_graph_points(vtk_xml_data_array & points, const Graph & g, file_type ft)
+{
+	typedef typename Graph::V_type::s_type s_type;
+
+	points.template init<s_type>("Points",3,ft);
+	points.template reserve<s_type>(3*g.getNVertex());
+
+	std::string dummy;
+
+	auto it = g.getVertexIterator();
+
+	while (it.isNext())
+	{
+		s_type x[3] = { 0, 0, 0 };
+
+		auto obj = g.vertex(it.get());
+
+		vtk_vertex_node<Graph, true> vn(dummy, obj, x);
+		boost::mpl::for_each<boost::mpl::range_c<int, 0, Graph::V_type::max_prop > >(vn);
+
+		points.add_block(x,3);
+
+		++it;
+	}
+}
+
 /*!
  *
  * It write a VTK format file in case for a graph
@@ -1102,6 +1344,50 @@ class VTKWriter<Graph, VTK_GRAPH>
 		return e_out;
 	}
 
+	/*! \brief Fill the connectivity and the offsets of the lines (one line for each edge)
+	 *
+	 * source and target of the edges are collected in a contiguous buffer and added
+	 * in one block
+	 *
+	 * \tparam idx_type type of the indexes (int or long int)
+	 *
+	 * \param connectivity data array for the connectivity
+	 * \param offsets data array for the offsets
+	 * \param ft file type
+	 *
+	 */
+	template<typename idx_type> void get_lines_xml(vtk_xml_data_array & connectivity, vtk_xml_data_array & offsets, file_type ft)
+	{
+		openfpm::vector<idx_type> conn;
+		openfpm::vector<idx_type> off;
+
+		conn.resize(2*g.getNEdge());
+		off.resize(g.getNEdge());
+
+		size_t n = 0;
+
+		auto it = g.getEdgeIterator();
+
+		while (it.isNext())
+		{
+			conn.get(2*n) = it.source();
+			conn.get(2*n+1) = it.target();
+			off.get(n) = 2*(n+1);
+
+			n++;
+			++it;
+		}
+
+		connectivity.template init<idx_type>("connectivity",1,ft);
+		offsets.template init<idx_type>("offsets",1,ft);
+
+		if (n != 0)
+		{
+			connectivity.add_block(&conn.get(0),2*n);
+			offsets.add_block(&off.get(0),n);
+		}
+	}
+
 public:
 
 	/*!
@@ -1129,6 +1415,8 @@ public:
 	 */
 	template<int prp = -1> bool write(std::string file, std::string graph_name = "Graph", file_type ft = file_type::ASCII)
 	{
+		io_prof_scope p_encode("vtk_encode");
+
 		// Check that the Vertex type define x y and z attributes
 
 		if (has_attributes<typename Graph::V_type>::value == false)
@@ -1221,22 +1509,84 @@ public:
 			boost::mpl::for_each<boost::mpl::range_c<int, prp, prp> >(ep);
 
 		// write the file
-		std::ofstream ofs(file);
+		return io_prof_write_file(file,p_encode,"vtk_flush",{vtk_header,point_prop_header,point_list,vertex_prop_header,vertex_list,edge_prop_header,
+		                                                     edge_list,point_data_header,point_data,cell_data_header,cell_data});
+	}
 
-		// Check if the file is open
-		if (ofs.is_open() == false)
+	/*! \brief It write a VTK XML PolyData file (.vtp) from a graph
+	 *
+	 * Every edge is a line, vertex properties are written as PointData and edge properties
+	 * as CellData. The properties are written column-wise and the connectivity is collected
+	 * in a contiguous Int32 array (Int64 if the graph has more than 2^31 vertices)
+	 *
+	 * \tparam prp which properties to output [default = -1 (all)]
+	 *
+	 * \param file path where to write
+	 * \param ft specify if it is a BINARY, APPENDED or ASCII file [default = BINARY]
+	 *
+	 * \return true if it write correctly
+	 *
+	 */
+	template<int prp = -1> bool write_xml(std::string file, file_type ft = file_type::BINARY)
+	{
+		io_prof_scope p_encode("vtk_encode");
+
+		// Check that the Vertex type define x y and z attributes
+
+		if (has_attributes<typename Graph::V_type>::value == false)
 		{
-			std::cerr << "Error cannot create the VTK file: " + file;
+			std::cerr << "Error writing a graph: Vertex must has defines x,y,z properties" << "\n";
+			return false;
 		}
 
-		ofs << vtk_header << point_prop_header << point_list << vertex_prop_header << vertex_list << edge_prop_header << edge_list << point_data_header << point_data << cell_data_header << cell_data;
+		openfpm::vector<vtk_xml_data_array> v_arrs;
+		openfpm::vector<vtk_xml_data_array> e_arrs;
+		vtk_xml_data_array points;
+		vtk_xml_data_array connectivity;
+		vtk_xml_data_array offsets;
+
+		vtk_xml_graph_points(points,g,ft);
+		vtk_xml_graph_fill<prp>(v_arrs,e_arrs,g,ft);
 
-		// Close the file
+		if (g.getNVertex() <= (size_t)INT_MAX && 2*g.getNEdge() <= (size_t)INT_MAX)
+		{get_lines_xml<int>(connectivity,offsets,ft);}
+		else
+		{get_lines_xml<long int>(connectivity,offsets,ft);}
+
+		std::ofstream ofs(file);
 
-		ofs.close();
+		// Check if the file is open
+		if (ofs.is_open() == false)
+		{
+			std::cerr << "Error cannot create the VTK file: " + file + "\n";
+			return false;
+		}
 
-		// Completed succefully
-		return true;
+		std::string appended;
+
+		ofs << "<VTKFile type=\"PolyData\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\">\n";
+		ofs << "  <PolyData>\n";
+		ofs << "    <Piece NumberOfPoints=\"" << g.getNVertex() << "\" NumberOfVerts=\"0\" NumberOfLines=\"" << g.getNEdge()
+			<< "\" NumberOfStrips=\"0\" NumberOfPolys=\"0\">\n";
+		ofs << "      <PointData>\n";
+		vtk_xml_write_arrays(ofs,v_arrs,"        ",appended);
+		ofs << "      </PointData>\n";
+		ofs << "      <CellData>\n";
+		vtk_xml_write_arrays(ofs,e_arrs,"        ",appended);
+		ofs << "      </CellData>\n";
+		ofs << "      <Points>\n";
+		points.write(ofs,"        ",appended);
+		ofs << "      </Points>\n";
+		ofs << "      <Lines>\n";
+		connectivity.write(ofs,"        ",appended);
+		offsets.write(ofs,"        ",appended);
+		ofs << "      </Lines>\n";
+		ofs << "    </Piece>\n";
+		ofs << "  </PolyData>\n";
+		vtk_xml_write_appended(ofs,appended);
+		ofs << "</VTKFile>\n";
+
+		return io_prof_close(ofs,p_encode,"vtk_flush");
 	}
 };
 
@@ -9,9 +9,16 @@
 #define VTKWRITER_GRIDS_HPP_
 
 #include <boost/mpl/pair.hpp>
+#include <algorithm>
+#include <unordered_map>
 #include "VTKWriter_grids_util.hpp"
+#include "VTKWriter_xml_util.hpp"
 #include "is_vtk_writable.hpp"
 
+#ifndef DISABLE_MPI_WRITTERS
+#include "VCluster/VCluster.hpp"
+#endif
+
 /*! \brief It store one grid
  *
  * \tparam Grid type of grid
@@ -43,6 +50,27 @@ public:
 
 
 
+/*! \brief Part of a grid written as a piece of a VTK ImageData
+ *
+ * \tparam dim dimensionality of the grid
+ *
+ */
+template<unsigned int dim>
+struct vtk_image_piece
+{
+	//! id of the grid
+	size_t g_id;
+
+	//! extent of the piece in the image (point indexes)
+	Box<3,long int> ext;
+
+	//! first point of the grid in the piece
+	grid_key_dx<dim> start;
+
+	//! last point of the grid in the piece
+	grid_key_dx<dim> stop;
+};
+
 /*! \brief this class is a functor for "for_each" algorithm
  *
  * This class is a functor for "for_each" algorithm. For each
@@ -318,6 +346,378 @@ class VTKWriter<pair,VECTOR_GRIDS>
 		return v_out;
 	}
 
+	/*! \brief Check if a grid has the given spacing
+	 *
+	 * \param e grid
+	 * \param spacing spacing
+	 *
+	 * \return true if the spacing match
+	 *
+	 */
+	static bool has_spacing(const ele_g<typename pair::first,typename pair::second> & e,
+							const Point<pair::first::dims,typename pair::second> & spacing)
+	{
+		for (size_t k = 0 ; k < pair::first::dims ; k++)
+		{
+			if (fabs(e.spacing.get(k) - spacing.get(k)) > 1e-6 * std::max(fabs(e.spacing.get(k)),fabs(spacing.get(k))))
+			{return false;}
+		}
+
+		return true;
+	}
+
+	/*! \brief Create the piece of an image that contain the domain part of a grid
+	 *
+	 * \param i grid id
+	 * \param origin origin of the image
+	 * \param spacing spacing of the image
+	 *
+	 * \return the image piece
+	 *
+	 */
+	vtk_image_piece<pair::first::dims> get_domain_piece(size_t i,
+			                                            const Point<pair::first::dims,typename pair::second> & origin,
+			                                            const Point<pair::first::dims,typename pair::second> & spacing)
+	{
+		auto & e = vg.get(i);
+
+		vtk_image_piece<pair::first::dims> pc;
+		pc.g_id = i;
+
+		for (size_t k = 0 ; k < 3 ; k++)
+		{
+			if (k >= pair::first::dims)
+			{
+				pc.ext.setLow(k,0);
+				pc.ext.setHigh(k,0);
+				continue;
+			}
+
+			long int sh = lround((e.offset.get(k) - origin.get(k)) / spacing.get(k));
+
+			pc.ext.setLow(k,sh + (long int)e.dom.getLow(k));
+			pc.ext.setHigh(k,sh + (long int)e.dom.getHigh(k));
+
+			pc.start.set_d(k,e.dom.getLow(k));
+			pc.stop.set_d(k,e.dom.getHigh(k));
+		}
+
+		return pc;
+	}
+
+	/*! \brief Find the part of the grids that lie on the plane x_d = c
+	 *
+	 * The plane is snapped to the nearest grid node, only the grids with the given spacing are considered
+	 *
+	 * \param d direction normal to the plane
+	 * \param c position of the plane
+	 * \param origin origin of the image
+	 * \param spacing spacing of the image
+	 * \param pieces parts of the grids that lie on the plane
+	 *
+	 */
+	void get_slice_pieces(size_t d,
+						  typename pair::second c,
+						  const Point<pair::first::dims,typename pair::second> & origin,
+						  const Point<pair::first::dims,typename pair::second> & spacing,
+						  openfpm::vector<vtk_image_piece<pair::first::dims>> & pieces)
+	{
+		for (size_t i = 0 ; i < vg.size() ; i++)
+		{
+			auto & e = vg.get(i);
+
+			if (has_spacing(e,spacing) == false)
+			{continue;}
+
+			long int p = lround((c - e.offset.get(d)) / e.spacing.get(d));
+
+			if (p < (long int)e.dom.getLow(d) || p > (long int)e.dom.getHigh(d))
+			{continue;}
+
+			vtk_image_piece<pair::first::dims> pc = get_domain_piece(i,origin,spacing);
+
+			long int sh = lround((e.offset.get(d) - origin.get(d)) / spacing.get(d));
+
+			pc.ext.setLow(d,sh + p);
+			pc.ext.setHigh(d,sh + p);
+			pc.start.set_d(d,p);
+			pc.stop.set_d(d,p);
+
+			pieces.add(pc);
+		}
+	}
+
+	/*! \brief Convert the node pieces into cell pieces
+	 *
+	 * Every node become the center of a cell, so the image origin is shifted by half
+	 * spacing and the extent of each piece is one larger
+	 *
+	 * \param origin origin of the image (shifted in place)
+	 * \param spacing spacing of the image
+	 * \param pieces pieces (modified in place)
+	 *
+	 */
+	void to_cell_pieces(Point<pair::first::dims,typename pair::second> & origin,
+						const Point<pair::first::dims,typename pair::second> & spacing,
+						openfpm::vector<vtk_image_piece<pair::first::dims>> & pieces)
+	{
+		for (size_t k = 0 ; k < pair::first::dims ; k++)
+		{origin.get(k) -= spacing.get(k) / 2;}
+
+		for (size_t i = 0 ; i < pieces.size() ; i++)
+		{
+			for (size_t k = 0 ; k < pair::first::dims ; k++)
+			{pieces.get(i).ext.setHigh(k,pieces.get(i).ext.getHigh(k) + 1);}
+		}
+	}
+
+	/*! \brief Write the pieces of an ImageData
+	 *
+	 * \tparam prp property to write (-1 all)
+	 *
+	 * \param out stream where to write
+	 * \param pieces pieces to write
+	 * \param prop_names properties names
+	 * \param ft file type
+	 * \param loc write the properties as PointData or CellData
+	 * \param appended buffer of the AppendedData section
+	 *
+	 */
+	template<int prp> void write_image_pieces(std::ostream & out,
+											  const openfpm::vector<vtk_image_piece<pair::first::dims>> & pieces,
+											  const openfpm::vector<std::string> & prop_names,
+											  file_type ft,
+											  vtk_data_location loc,
+											  std::string & appended)
+	{
+		openfpm::vector<vtk_xml_data_array> arrs;
+
+		const char * data_tag = (loc == vtk_data_location::CELL_DATA)?"CellData":"PointData";
+
+		for (size_t i = 0 ; i < pieces.size() ; i++)
+		{
+			auto & pc = pieces.get(i);
+
+			vtk_xml_grid_fill<prp,ele_g<typename pair::first,typename pair::second>>(arrs,vg.get(pc.g_id).g,pc.start,pc.stop,prop_names,"",ft);
+
+			out << "    <Piece Extent=\"" << vtk_extent_string(pc.ext) << "\">\n";
+			out << "      <" << data_tag << ">\n";
+			vtk_xml_write_arrays(out,arrs,"        ",appended);
+			out << "      </" << data_tag << ">\n";
+			out << "    </Piece>\n";
+		}
+	}
+
+	/*! \brief Write an ImageData file with the given pieces
+	 *
+	 * \tparam prp property to write (-1 all)
+	 *
+	 * \param file output file
+	 * \param origin origin of the image
+	 * \param spacing spacing of the image
+	 * \param pieces pieces to write
+	 * \param prop_names properties names
+	 * \param ft file type
+	 * \param loc write the properties as PointData or CellData
+	 *
+	 * \return true if the file has been written
+	 *
+	 */
+	template<int prp> bool write_image_file(const std::string & file,
+											const Point<pair::first::dims,typename pair::second> & origin,
+											const Point<pair::first::dims,typename pair::second> & spacing,
+											const openfpm::vector<vtk_image_piece<pair::first::dims>> & pieces,
+											const openfpm::vector<std::string> & prop_names,
+											file_type ft,
+											vtk_data_location loc = vtk_data_location::POINT_DATA)
+	{
+		io_prof_scope p_encode("vtk_encode");
+
+		std::ofstream ofs(file);
+
+		// Check if the file is open
+		if (ofs.is_open() == false)
+		{
+			std::cerr << "Error cannot create the VTK file: " + file + "\n";
+			return false;
+		}
+
+		openfpm::vector<Box<3,long int>> ext;
+		for (size_t i = 0 ; i < pieces.size() ; i++)
+		{ext.add(pieces.get(i).ext);}
+
+		ofs << "<VTKFile type=\"ImageData\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\">\n";
+		ofs << "  <ImageData WholeExtent=\"" << vtk_extent_string(vtk_whole_extent(ext)) << "\"";
+		vtk_image_geometry(ofs,origin,spacing);
+		ofs << ">\n";
+
+		std::string appended;
+		write_image_pieces<prp>(ofs,pieces,prop_names,ft,loc,appended);
+
+		ofs << "  </ImageData>\n";
+		vtk_xml_write_appended(ofs,appended);
+		ofs << "</VTKFile>\n";
+
+		return io_prof_close(ofs,p_encode,"vtk_flush");
+	}
+
+	/*! \brief Get the domain part of all the grids with the given spacing
+	 *
+	 * \param origin origin of the image
+	 * \param spacing spacing of the image
+	 * \param pieces domain parts
+	 *
+	 */
+	void get_domain_pieces(const Point<pair::first::dims,typename pair::second> & origin,
+						   const Point<pair::first::dims,typename pair::second> & spacing,
+						   openfpm::vector<vtk_image_piece<pair::first::dims>> & pieces)
+	{
+		for (size_t i = 0 ; i < vg.size() ; i++)
+		{
+			if (has_spacing(vg.get(i),spacing) == true)
+			{pieces.add(get_domain_piece(i,origin,spacing));}
+		}
+	}
+
+#ifndef DISABLE_MPI_WRITTERS
+
+	/*! \brief Calculate origin and spacing of the image across all processors
+	 *
+	 * The image origin is the smallest offset, the spacing is the one of the grids
+	 *
+	 * \param org origin of the image
+	 * \param spc spacing of the image
+	 *
+	 */
+	void get_global_geometry(Point<pair::first::dims,typename pair::second> & org,
+							 Point<pair::first::dims,typename pair::second> & spc)
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+		typename pair::second origin[pair::first::dims];
+		typename pair::second spacing[pair::first::dims];
+
+		for (size_t k = 0 ; k < pair::first::dims ; k++)
+		{
+			origin[k] = std::numeric_limits<typename pair::second>::max();
+			spacing[k] = 0;
+
+			for (size_t i = 0 ; i < vg.size() ; i++)
+			{
+				origin[k] = std::min(origin[k],vg.get(i).offset.get(k));
+				spacing[k] = std::max(spacing[k],vg.get(i).spacing.get(k));
+			}
+
+			v_cl.min(origin[k]);
+			v_cl.max(spacing[k]);
+		}
+		v_cl.execute();
+
+		org = Point<pair::first::dims,typename pair::second>(origin);
+		spc = Point<pair::first::dims,typename pair::second>(spacing);
+	}
+
+	/*! \brief Write the pieces of each processor and the .pvti that collect them
+	 *
+	 * Every piece is written in its own file file_<rank>_<piece>.vti with its own extent,
+	 * so grids that are not adjacent do not produce a single image covering the holes
+	 * between them. Processor 0 write file.pvti that list all the pieces
+	 *
+	 * \tparam prp property to write (-1 all)
+	 *
+	 * \param file path where to write (without extension)
+	 * \param org origin of the image
+	 * \param spc spacing of the image
+	 * \param pieces pieces of this processor
+	 * \param prop_names properties names
+	 * \param ft file type
+	 * \param loc write the properties as PointData or CellData
+	 *
+	 * \return true if the files has been written
+	 *
+	 */
+	template<int prp> bool write_pimage_files(const std::string & file,
+											  const Point<pair::first::dims,typename pair::second> & org,
+											  const Point<pair::first::dims,typename pair::second> & spc,
+											  const openfpm::vector<vtk_image_piece<pair::first::dims>> & pieces,
+											  const openfpm::vector<std::string> & prop_names,
+											  file_type ft,
+											  vtk_data_location loc)
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+		bool ret = true;
+
+		openfpm::vector<Box<3,long int>> ext;
+
+		for (size_t i = 0 ; i < pieces.size() ; i++)
+		{
+			openfpm::vector<vtk_image_piece<pair::first::dims>> pc;
+			pc.add(pieces.get(i));
+
+			std::string pfile = file + "_" + std::to_string(v_cl.getProcessUnitID()) + "_" + std::to_string(i) + ".vti";
+			ret &= write_image_file<prp>(pfile,org,spc,pc,prop_names,ft,loc);
+
+			ext.add(pieces.get(i).ext);
+		}
+
+		// Gather the extents of the pieces of all processors on processor 0
+
+		openfpm::vector<Box<3,long int>> ext_all;
+		openfpm::vector<size_t> prc;
+		openfpm::vector<size_t> sz;
+
+		v_cl.SGather(ext,ext_all,prc,sz,0);
+
+		if (v_cl.getProcessUnitID() != 0)
+		{return ret;}
+
+		std::ofstream ofs(file + ".pvti");
+
+		// Check if the file is open
+		if (ofs.is_open() == false)
+		{
+			std::cerr << "Error cannot create the VTK file: " + file + ".pvti\n";
+			return false;
+		}
+
+		Box<3,long int> gwh = vtk_whole_extent(ext_all);
+
+		ofs << "<VTKFile type=\"PImageData\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\">\n";
+		ofs << "  <PImageData WholeExtent=\"" << vtk_extent_string(gwh) << "\" GhostLevel=\"0\"";
+		vtk_image_geometry(ofs,org,spc);
+		ofs << ">\n";
+
+		openfpm::vector<vtk_xml_data_array> arrs;
+		vtk_xml_init_arrays<prp,ele_g<typename pair::first,typename pair::second>>(arrs,prop_names,"",ft);
+
+		const char * data_tag = (loc == vtk_data_location::CELL_DATA)?"PCellData":"PPointData";
+
+		ofs << "    <" << data_tag << ">\n";
+		vtk_xml_write_parrays(ofs,arrs,"      ");
+		ofs << "    </" << data_tag << ">\n";
+
+		std::string base = vtk_xml_basename(file);
+
+		// the pieces are received ordered by processor
+
+		size_t k = 0;
+		for (size_t i = 0 ; i < prc.size() ; i++)
+		{
+			for (size_t j = 0 ; j < sz.get(i) ; j++, k++)
+			{ofs << "    <Piece Extent=\"" << vtk_extent_string(ext_all.get(k)) << "\" Source=\"" << base << "_" << prc.get(i) << "_" << j << ".vti\"/>\n";}
+		}
+
+		ofs << "  </PImageData>\n";
+		ofs << "</VTKFile>\n";
+
+		ofs.close();
+
+		return ret;
+	}
+
+#endif
+
 public:
 
 	/*!
@@ -363,6 +763,8 @@ public:
 									  std::string f_name = "grids",
 									  file_type ft = file_type::ASCII)
 	{
+		io_prof_scope p_encode("vtk_encode");
+
 		// Header for the vtk
 		std::string vtk_header;
 		// Point list of the VTK
@@ -422,22 +824,566 @@ public:
 
 
 		// write the file
+		return io_prof_write_file(file,p_encode,"vtk_flush",{vtk_header,point_prop_header,point_list,vertex_prop_header,
+		                                                     vertex_list,point_data_header,point_data});
+	}
+
+	/*! \brief Write the domain part of the grids as VTK ImageData
+	 *
+	 * All the grids with the same spacing of the first grid are written as pieces
+	 * of one image (.vti). With CELL_DATA every node is the center of a cell, the
+	 * properties are written as CellData and the image extent is one larger
+	 *
+	 * \tparam prp property to write [default = -1 (all)]
+	 *
+	 * \param file path where to write (.vti)
+	 * \param prop_names properties name (can also be a vector of size 0)
+	 * \param ft specify if it is a BINARY, APPENDED or ASCII file [default = BINARY]
+	 * \param loc write the properties as POINT_DATA or CELL_DATA [default = POINT_DATA]
+	 *
+	 * \return true if the function write successfully
+	 *
+	 */
+	template<int prp = -1> bool write_image(std::string file,
+											const openfpm::vector<std::string> & prop_names,
+											file_type ft = file_type::BINARY,
+											vtk_data_location loc = vtk_data_location::POINT_DATA)
+	{
+		openfpm::vector<vtk_image_piece<pair::first::dims>> pieces;
+
+		Point<pair::first::dims,typename pair::second> origin;
+		Point<pair::first::dims,typename pair::second> spacing;
+
+		if (vg.size() != 0)
+		{
+			origin = vg.get(0).offset;
+			spacing = vg.get(0).spacing;
+
+			get_domain_pieces(origin,spacing,pieces);
+		}
+
+		if (loc == vtk_data_location::CELL_DATA)
+		{to_cell_pieces(origin,spacing,pieces);}
+
+		return write_image_file<prp>(file,origin,spacing,pieces,prop_names,ft,loc);
+	}
+
+	/*! \brief Write the nodes of the grids that lie on an axis-aligned plane
+	 *
+	 * The plane x_d = c is snapped to the nearest grid node and written as a 2D
+	 * VTK ImageData (.vti), one piece for each grid that intersect the plane. Only the
+	 * grids with the same spacing of the first grid are written. With CELL_DATA the
+	 * layer of cells that contain the plane is written
+	 *
+	 * \tparam prp property to write [default = -1 (all)]
+	 *
+	 * \param file path where to write (.vti)
+	 * \param prop_names properties name (can also be a vector of size 0)
+	 * \param d direction normal to the plane (0 = x, 1 = y, 2 = z)
+	 * \param c position of the plane
+	 * \param ft specify if it is a BINARY, APPENDED or ASCII file [default = BINARY]
+	 * \param loc write the properties as POINT_DATA or CELL_DATA [default = POINT_DATA]
+	 *
+	 * \return true if the function write successfully
+	 *
+	 */
+	template<int prp = -1> bool write_slice(std::string file,
+											const openfpm::vector<std::string> & prop_names,
+											size_t d,
+											typename pair::second c,
+											file_type ft = file_type::BINARY,
+											vtk_data_location loc = vtk_data_location::POINT_DATA)
+	{
+		if (d >= pair::first::dims)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error the direction of the slice must be smaller than the dimensionality\n";
+			return false;
+		}
+
+		openfpm::vector<vtk_image_piece<pair::first::dims>> pieces;
+
+		Point<pair::first::dims,typename pair::second> origin;
+		Point<pair::first::dims,typename pair::second> spacing;
+
+		if (vg.size() != 0)
+		{
+			origin = vg.get(0).offset;
+			spacing = vg.get(0).spacing;
+
+			get_slice_pieces(d,c,origin,spacing,pieces);
+		}
+
+		if (loc == vtk_data_location::CELL_DATA)
+		{to_cell_pieces(origin,spacing,pieces);}
+
+		return write_image_file<prp>(file,origin,spacing,pieces,prop_names,ft,loc);
+	}
+
+	/*! \brief Write only the active blocks of the grids as an unstructured set of voxels
+	 *
+	 * The domain of every grid (with the same spacing of the first grid) is divided in blocks of
+	 * block_sz nodes per direction. A block is written only if at least one of its nodes is active.
+	 * The nodes of the active blocks are written once as points (nodes shared between blocks and
+	 * between grids are not duplicated) together with their properties, and every group of 2^dim
+	 * nodes that are all written define a voxel (pixel in 2D, line in 1D). The output size scale
+	 * with the number of active blocks and not with the size of the grids
+	 *
+	 * \tparam prp property to write [default = -1 (all)]
+	 * \tparam Active type of the activity mask
+	 *
+	 * \param file path where to write (.vtu)
+	 * \param prop_names properties name (can also be a vector of size 0)
+	 * \param block_sz number of nodes of a block in each direction
+	 * \param active callable bool(size_t grid_id, const grid_key_dx<dims> & key) that return true
+	 *        if the node is active. A per-block occupancy can be checked from the key
+	 * \param ft specify if it is a BINARY, APPENDED or ASCII file [default = BINARY]
+	 *
+	 * \return true if the function write successfully
+	 *
+	 */
+	template<int prp = -1, typename Active> bool write_sparse(std::string file,
+															  const openfpm::vector<std::string> & prop_names,
+															  size_t block_sz,
+															  Active active,
+															  file_type ft = file_type::BINARY)
+	{
+		typedef typename pair::first grid_type;
+		typedef std::array<long int,grid_type::dims> lattice_point;
+
+		io_prof_scope p_encode("vtk_encode");
+
+		if (block_sz == 0)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error the block size must be greater than zero\n";
+			return false;
+		}
+
+		Point<grid_type::dims,typename pair::second> origin;
+		Point<grid_type::dims,typename pair::second> spacing;
+
+		if (vg.size() != 0)
+		{
+			origin = vg.get(0).offset;
+			spacing = vg.get(0).spacing;
+		}
+
+		openfpm::vector<vtk_xml_data_array> arrs;
+		vtk_xml_init_arrays<prp,ele_g<grid_type,typename pair::second>>(arrs,prop_names,"",ft);
+
+		std::unordered_map<lattice_point,size_t,vtk_lattice_hash<grid_type::dims>> map;
+		openfpm::vector<lattice_point> pnt;
+
+		for (size_t i = 0 ; i < vg.size() ; i++)
+		{
+			auto & e = vg.get(i);
+
+			if (has_spacing(e,spacing) == false)
+			{continue;}
+
+			long int sh[grid_type::dims];
+			size_t n_blk[grid_type::dims];
+
+			for (size_t k = 0 ; k < grid_type::dims ; k++)
+			{
+				sh[k] = lround((e.offset.get(k) - origin.get(k)) / spacing.get(k));
+				n_blk[k] = (e.dom.getHigh(k) - e.dom.getLow(k)) / block_sz + 1;
+			}
+
+			grid_sm<grid_type::dims,void> gb(n_blk);
+			auto bit = gb.getIterator();
+
+			while (bit.isNext())
+			{
+				auto b = bit.get();
+
+				grid_key_dx<grid_type::dims> start;
+				grid_key_dx<grid_type::dims> stop;
+
+				for (size_t k = 0 ; k < grid_type::dims ; k++)
+				{
+					start.set_d(k,e.dom.getLow(k) + b.get(k)*block_sz);
+					stop.set_d(k,std::min(e.dom.getLow(k) + (b.get(k)+1)*block_sz - 1,e.dom.getHigh(k)));
+				}
+
+				// Check if the block is active
+
+				bool is_active = false;
+
+				auto it = e.g.getSubIterator(start,stop);
+				while (it.isNext() && is_active == false)
+				{
+					is_active = active(i,it.get());
+					++it;
+				}
+
+				if (is_active == true)
+				{
+					auto it2 = e.g.getSubIterator(start,stop);
+
+					while (it2.isNext())
+					{
+						auto key = it2.get();
+
+						lattice_point lp;
+						for (size_t k = 0 ; k < grid_type::dims ; k++)
+						{lp[k] = sh[k] + key.get(k);}
+
+						if (map.find(lp) == map.end())
+						{
+							map[lp] = pnt.size();
+							pnt.add(lp);
+
+							vtk_xml_grid_add_point<grid_type,decltype(key)> ap(arrs,e.g,key);
+
+							if (prp == -1)
+							{boost::mpl::for_each< boost::mpl::range_c<int,0, grid_type::value_type::max_prop> >(ap);}
+							else
+							{boost::mpl::for_each< boost::mpl::range_c<int,(prp < 0)?0:prp, (prp < 0)?0:prp+1> >(ap);}
+						}
+
+						++it2;
+					}
+				}
+
+				++bit;
+			}
+		}
+
+		// Points
+
+		vtk_xml_data_array points;
+		points.template init<typename pair::second>("Points",3,ft);
+
+		for (size_t i = 0 ; i < pnt.size() ; i++)
+		{
+			for (size_t k = 0 ; k < 3 ; k++)
+			{
+				typename pair::second x = (k < grid_type::dims)?origin.get(k) + pnt.get(i)[k] * spacing.get(k):0;
+				points.add(x);
+			}
+		}
+
+		// Voxels (the corners are ordered with x running fastest like VTK_VOXEL and VTK_PIXEL)
+
+		const size_t n_corner = 1 << grid_type::dims;
+		const unsigned char cell_type = (grid_type::dims == 1)?3:((grid_type::dims == 2)?8:11);
+
+		vtk_xml_data_array connectivity;
+		vtk_xml_data_array offsets;
+		vtk_xml_data_array types;
+
+		connectivity.template init<long int>("connectivity",1,ft);
+		offsets.template init<long int>("offsets",1,ft);
+		types.template init<unsigned char>("types",1,ft);
+
+		size_t n_cell = 0;
+		long int ids[1 << grid_type::dims];
+
+		for (size_t i = 0 ; i < pnt.size() ; i++)
+		{
+			bool complete = true;
+
+			for (size_t c = 0 ; c < n_corner && complete == true ; c++)
+			{
+				lattice_point lp = pnt.get(i);
+				for (size_t k = 0 ; k < grid_type::dims ; k++)
+				{lp[k] += (c >> k) & 1;}
+
+				auto f = map.find(lp);
+
+				if (f == map.end())
+				{complete = false;}
+				else
+				{ids[c] = f->second;}
+			}
+
+			if (complete == false)
+			{continue;}
+
+			for (size_t c = 0 ; c < n_corner ; c++)
+			{connectivity.add(ids[c]);}
+
+			n_cell++;
+			offsets.add((long int)(n_cell*n_corner));
+			types.add(cell_type);
+		}
+
 		std::ofstream ofs(file);
 
 		// Check if the file is open
 		if (ofs.is_open() == false)
-		{std::cerr << "Error cannot create the VTK file: " + file + "\n";}
+		{
+			std::cerr << "Error cannot create the VTK file: " + file + "\n";
+			return false;
+		}
+
+		ofs << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\">\n";
+		ofs << "  <UnstructuredGrid>\n";
+		ofs << "    <Piece NumberOfPoints=\"" << pnt.size() << "\" NumberOfCells=\"" << n_cell << "\">\n";
+		std::string appended;
+
+		ofs << "      <PointData>\n";
+		vtk_xml_write_arrays(ofs,arrs,"        ",appended);
+		ofs << "      </PointData>\n";
+		ofs << "      <Points>\n";
+		points.write(ofs,"        ",appended);
+		ofs << "      </Points>\n";
+		ofs << "      <Cells>\n";
+		connectivity.write(ofs,"        ",appended);
+		offsets.write(ofs,"        ",appended);
+		types.write(ofs,"        ",appended);
+		ofs << "      </Cells>\n";
+		ofs << "    </Piece>\n";
+		ofs << "  </UnstructuredGrid>\n";
+		vtk_xml_write_appended(ofs,appended);
+		ofs << "</VTKFile>\n";
+
+		return io_prof_close(ofs,p_encode,"vtk_flush");
+	}
+
+	/*! \brief Write the grids as an overlapping AMR dataset
+	 *
+	 * The grids are grouped by spacing into levels (the coarsest is level 0). For each grid the
+	 * domain part is written as a block file_<level>_<index>.vti, the file file.vthb
+	 * describe the hierarchy (vtkOverlappingAMR) and can be opened directly with ParaView
+	 *
+	 * \tparam prp property to write [default = -1 (all)]
+	 *
+	 * \param file path where to write (without extension)
+	 * \param prop_names properties name (can also be a vector of size 0)
+	 * \param ft specify if it is a BINARY, APPENDED or ASCII file [default = BINARY]
+	 *
+	 * \return true if the function write successfully
+	 *
+	 */
+	template<int prp = -1> bool write_amr(std::string file,
+										  const openfpm::vector<std::string> & prop_names,
+										  file_type ft = file_type::BINARY)
+	{
+		typedef Point<pair::first::dims,typename pair::second> point_type;
+
+		// Group the grids by spacing
+
+		openfpm::vector<point_type> lvl_spacing;
+		openfpm::vector<openfpm::vector<size_t>> lvl_grids;
+
+		for (size_t i = 0 ; i < vg.size() ; i++)
+		{
+			size_t l = 0;
+			for ( ; l < lvl_spacing.size() ; l++)
+			{
+				if (has_spacing(vg.get(i),lvl_spacing.get(l)) == true)
+				{break;}
+			}
+
+			if (l == lvl_spacing.size())
+			{
+				lvl_spacing.add(vg.get(i).spacing);
+				lvl_grids.add();
+			}
+
+			lvl_grids.get(l).add(i);
+		}
+
+		// Order the levels from the coarsest to the finest (largest cell first), levels with the
+		// same cell volume (anisotropic refinement) are ordered by the spacing of every dimension
+
+		std::vector<size_t> lvl_ord;
+		for (size_t l = 0 ; l < lvl_spacing.size() ; l++)
+		{lvl_ord.push_back(l);}
+
+		auto coarser = [&](size_t a, size_t b)
+		{
+			double va = 1.0;
+			double vb = 1.0;
+
+			for (size_t k = 0 ; k < pair::first::dims ; k++)
+			{
+				va *= lvl_spacing.get(a).get(k);
+				vb *= lvl_spacing.get(b).get(k);
+			}
+
+			if (fabs(va - vb) > 1e-6 * std::max(fabs(va),fabs(vb)))
+			{return va > vb;}
+
+			for (size_t k = 0 ; k < pair::first::dims ; k++)
+			{
+				if (lvl_spacing.get(a).get(k) != lvl_spacing.get(b).get(k))
+				{return lvl_spacing.get(a).get(k) > lvl_spacing.get(b).get(k);}
+			}
+
+			return false;
+		};
+
+		std::sort(lvl_ord.begin(),lvl_ord.end(),coarser);
+
+		// The origin of the hierarchy is the lower corner of all the domains
+
+		point_type origin;
+
+		for (size_t k = 0 ; k < pair::first::dims ; k++)
+		{
+			for (size_t i = 0 ; i < vg.size() ; i++)
+			{
+				typename pair::second lw = vg.get(i).offset.get(k) + vg.get(i).dom.getLow(k) * vg.get(i).spacing.get(k);
+
+				if (i == 0 || lw < origin.get(k))
+				{origin.get(k) = lw;}
+			}
+		}
+
+		std::ofstream ofs(file + ".vthb");
+
+		// Check if the file is open
+		if (ofs.is_open() == false)
+		{
+			std::cerr << "Error cannot create the VTK file: " + file + ".vthb\n";
+			return false;
+		}
 
-		ofs << vtk_header << point_prop_header << point_list <<
-				vertex_prop_header << vertex_list << point_data_header << point_data;
+		std::string base = vtk_xml_basename(file);
+		const char * grid_desc[] = {"X","XY","XYZ"};
+
+		if (std::is_same<typename pair::second,float>::value == true)
+		{ofs << std::setprecision(7);}
+		else
+		{ofs << std::setprecision(16);}
+
+		ofs << "<VTKFile type=\"vtkOverlappingAMR\" version=\"1.1\" byte_order=\"LittleEndian\" header_type=\"UInt64\">\n";
+		ofs << "  <vtkOverlappingAMR origin=\"";
+		for (size_t k = 0 ; k < 3 ; k++)
+		{ofs << ((k < pair::first::dims)?origin.get(k):0) << ((k != 2)?" ":"");}
+		ofs << "\" grid_description=\"" << grid_desc[(pair::first::dims > 3)?2:pair::first::dims-1] << "\">\n";
+
+		bool ret = true;
+
+		for (size_t l = 0 ; l < lvl_ord.size() ; l++)
+		{
+			const point_type & spacing = lvl_spacing.get(lvl_ord[l]);
+			const openfpm::vector<size_t> & grids = lvl_grids.get(lvl_ord[l]);
 
-		// Close the file
+			ofs << "    <Block level=\"" << l << "\" spacing=\"";
+			for (size_t k = 0 ; k < 3 ; k++)
+			{ofs << ((k < pair::first::dims)?spacing.get(k):1) << ((k != 2)?" ":"");}
+			ofs << "\">\n";
+
+			for (size_t j = 0 ; j < grids.size() ; j++)
+			{
+				openfpm::vector<vtk_image_piece<pair::first::dims>> pieces;
+				pieces.add(get_domain_piece(grids.get(j),origin,spacing));
+
+				std::string block = "_" + std::to_string(l) + "_" + std::to_string(j) + ".vti";
+
+				ret &= write_image_file<prp>(file + block,origin,spacing,pieces,prop_names,ft);
+
+				// the AMR box is defined on cells
+
+				const Box<3,long int> & ext = pieces.get(0).ext;
+
+				ofs << "      <DataSet index=\"" << j << "\" amr_box=\"";
+				for (size_t k = 0 ; k < 3 ; k++)
+				{ofs << ext.getLow(k) << " " << ext.getHigh(k) - 1 << ((k != 2)?" ":"");}
+				ofs << "\" file=\"" << base << block << "\"/>\n";
+			}
+
+			ofs << "    </Block>\n";
+		}
+
+		ofs << "  </vtkOverlappingAMR>\n";
+		ofs << "</VTKFile>\n";
 
 		ofs.close();
 
-		// Completed succefully
-		return true;
+		return ret;
 	}
+
+#ifndef DISABLE_MPI_WRITTERS
+
+	/*! \brief Write the domain part of the distributed grids as VTK ImageData
+	 *
+	 * Parallel version of write_image (must be called by all processors). Every processor
+	 * write each of its grids in file_<rank>_<grid>.vti, processor 0 write the file file.pvti that list
+	 * all the pieces. All the grids must be defined on the same lattice (like the local
+	 * grids of a grid_dist)
+	 *
+	 * \tparam prp property to write [default = -1 (all)]
+	 *
+	 * \param file path where to write (without extension)
+	 * \param prop_names properties name (can also be a vector of size 0)
+	 * \param ft specify if it is a BINARY, APPENDED or ASCII file [default = BINARY]
+	 * \param loc write the properties as POINT_DATA or CELL_DATA [default = POINT_DATA]
+	 *
+	 * \return true if the function write successfully
+	 *
+	 */
+	template<int prp = -1> bool write_pimage(std::string file,
+											 const openfpm::vector<std::string> & prop_names,
+											 file_type ft = file_type::BINARY,
+											 vtk_data_location loc = vtk_data_location::POINT_DATA)
+	{
+		Point<pair::first::dims,typename pair::second> org;
+		Point<pair::first::dims,typename pair::second> spc;
+
+		get_global_geometry(org,spc);
+
+		openfpm::vector<vtk_image_piece<pair::first::dims>> pieces;
+
+		get_domain_pieces(org,spc,pieces);
+
+		if (loc == vtk_data_location::CELL_DATA)
+		{to_cell_pieces(org,spc,pieces);}
+
+		return write_pimage_files<prp>(file,org,spc,pieces,prop_names,ft,loc);
+	}
+
+	/*! \brief Write the nodes of the distributed grids that lie on an axis-aligned plane
+	 *
+	 * Parallel version of write_slice (must be called by all processors). Only the processors
+	 * that intersect the plane write one file file_<rank>_<grid>.vti per grid, processor 0 write the file
+	 * file.pvti that collect all the pieces. All the grids must be defined on the
+	 * same lattice (like the local grids of a grid_dist)
+	 *
+	 * \tparam prp property to write [default = -1 (all)]
+	 *
+	 * \param file path where to write (without extension)
+	 * \param prop_names properties name (can also be a vector of size 0)
+	 * \param d direction normal to the plane (0 = x, 1 = y, 2 = z)
+	 * \param c position of the plane
+	 * \param ft specify if it is a BINARY, APPENDED or ASCII file [default = BINARY]
+	 * \param loc write the properties as POINT_DATA or CELL_DATA [default = POINT_DATA]
+	 *
+	 * \return true if the function write successfully
+	 *
+	 */
+	template<int prp = -1> bool write_pslice(std::string file,
+											 const openfpm::vector<std::string> & prop_names,
+											 size_t d,
+											 typename pair::second c,
+											 file_type ft = file_type::BINARY,
+											 vtk_data_location loc = vtk_data_location::POINT_DATA)
+	{
+		if (d >= pair::first::dims)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error the direction of the slice must be smaller than the dimensionality\n";
+			return false;
+		}
+
+		Point<pair::first::dims,typename pair::second> org;
+		Point<pair::first::dims,typename pair::second> spc;
+
+		get_global_geometry(org,spc);
+
+		openfpm::vector<vtk_image_piece<pair::first::dims>> pieces;
+
+		get_slice_pieces(d,c,org,spc,pieces);
+
+		if (loc == vtk_data_location::CELL_DATA)
+		{to_cell_pieces(org,spc,pieces);}
+
+		return write_pimage_files<prp>(file,org,spc,pieces,prop_names,ft,loc);
+	}
+
+#endif
 };
 
 
@@ -11,6 +11,7 @@
 
 #include <boost/mpl/pair.hpp>
 #include "VTKWriter_grids_util.hpp"
+#include "VTKWriter_xml_util.hpp"
 #include "util/util_debug.hpp"
 #include "util/convert.hpp"
 
@@ -105,8 +106,18 @@ public:
 	//! grid type
 	typedef Grid value_type;
 
-	//! constructor
-	ele_g_st(){};
+	//! constructor, an element without grids has zero offset and unit spacing
+	ele_g_st()
+	{
+		offset.zero();
+		spacing.one();
+
+		for (size_t k = 0 ; k < Grid::dims ; k++)
+		{
+			dom.setLow(k,0);
+			dom.setHigh(k,0);
+		}
+	};
 
 	/*! \brief convert a staggered grid property into a string
 	 *
@@ -594,6 +605,174 @@ class VTKWriter<pair,VECTOR_ST_GRIDS>
 		vg.get(id).g.last().grids.add(&g);
 	}
 
+	/*! \brief Origin of the image of a combination
+	 *
+	 * The grids of the combination cmb are shifted by spacing/2 * (1 + cmb) from the
+	 * sub-domain offset
+	 *
+	 * \param i sub-domain
+	 * \param cmb combination
+	 *
+	 * \return the position of the first point of the grid
+	 *
+	 */
+	Point<pair::first::dims,typename pair::second> get_cmb_origin(size_t i, const comb<pair::first::dims> & cmb)
+	{
+		Point<pair::first::dims,typename pair::second> middle = vg.get(i).spacing / 2;
+		Point<pair::first::dims,typename pair::second> one;
+		one.one();
+		one = one + toPoint<pair::first::dims,typename pair::second>::convert(cmb);
+
+		return pmul(middle,one) + vg.get(i).offset;
+	}
+
+	/*! \brief Write all the grids of a combination as an ImageData
+	 *
+	 * Every sub-domain is a piece, every fused grid write its properties with the post-fix _k.
+ * All the pieces write the same arrays (as many as the largest number of fused grids), a
+ * piece with less fused grids write zero in the missing ones
+	 *
+	 * \tparam prp property to write (-1 all)
+	 *
+	 * \param file output file
+	 * \param cmb combination
+	 * \param prop_names properties names
+	 * \param ft file type
+	 *
+	 * \return true if the file has been written
+	 *
+	 */
+	template<int prp> bool write_cmb_image(const std::string & file,
+										   const comb<pair::first::dims> & cmb,
+										   const openfpm::vector<std::string> & prop_names,
+										   file_type ft)
+	{
+		typedef ele_g_st<typename pair::first,typename pair::second> ele_type;
+
+		io_prof_scope p_encode("vtk_encode");
+
+		openfpm::vector<size_t> sub;
+		openfpm::vector<size_t> pos;
+		openfpm::vector<Box<3,long int>> ext;
+		openfpm::vector<grid_key_dx<pair::first::dims>> start;
+		openfpm::vector<grid_key_dx<pair::first::dims>> stop;
+
+		Point<pair::first::dims,typename pair::second> origin;
+		Point<pair::first::dims,typename pair::second> spacing;
+
+		for (size_t i = 0 ; i < vg.size() ; i++)
+		{
+			for (size_t j = 0 ; j < vg.get(i).g.size() ; j++)
+			{
+				if (!(vg.get(i).g.get(j).cmb == cmb) || vg.get(i).g.get(j).grids.size() == 0)
+				{continue;}
+
+				if (sub.size() == 0)
+				{
+					origin = get_cmb_origin(i,cmb);
+					spacing = vg.get(i).spacing;
+				}
+
+				// Only the domain part, clipped to the staggered grid size
+
+				auto & g0 = *vg.get(i).g.get(j).grids.get(0);
+				Point<pair::first::dims,typename pair::second> org = get_cmb_origin(i,cmb);
+
+				Box<3,long int> bx;
+				grid_key_dx<pair::first::dims> k_start;
+				grid_key_dx<pair::first::dims> k_stop;
+
+				for (size_t k = 0 ; k < 3 ; k++)
+				{
+					if (k >= pair::first::dims)
+					{
+						bx.setLow(k,0);
+						bx.setHigh(k,0);
+						continue;
+					}
+
+					long int sh = lround((org.get(k) - origin.get(k)) / spacing.get(k));
+					long int hi = std::min((long int)vg.get(i).dom.getHigh(k),(long int)g0.getGrid().size(k) - 1);
+
+					k_start.set_d(k,vg.get(i).dom.getLow(k));
+					k_stop.set_d(k,hi);
+
+					bx.setLow(k,sh + (long int)vg.get(i).dom.getLow(k));
+					bx.setHigh(k,sh + hi);
+				}
+
+				sub.add(i);
+				pos.add(j);
+				ext.add(bx);
+				start.add(k_start);
+				stop.add(k_stop);
+			}
+		}
+
+		// origin and spacing come from the first grid of the combination
+
+		if (sub.size() == 0)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error: there are no grids to write in " << file << std::endl;
+			return false;
+		}
+
+		std::ofstream ofs(file);
+
+		// Check if the file is open
+		if (ofs.is_open() == false)
+		{
+			std::cerr << "Error cannot create the VTK file: " + file + "\n";
+			return false;
+		}
+
+		ofs << "<VTKFile type=\"ImageData\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\">\n";
+		ofs << "  <ImageData WholeExtent=\"" << vtk_extent_string(vtk_whole_extent(ext)) << "\"";
+		vtk_image_geometry(ofs,origin,spacing);
+		ofs << ">\n";
+
+		std::string appended;
+		openfpm::vector<vtk_xml_data_array> arrs;
+
+		size_t n_fused = 0;
+		for (size_t p = 0 ; p < sub.size() ; p++)
+		{n_fused = std::max(n_fused,vg.get(sub.get(p)).g.get(pos.get(p)).grids.size());}
+
+		for (size_t p = 0 ; p < sub.size() ; p++)
+		{
+			auto & cg = vg.get(sub.get(p)).g.get(pos.get(p));
+
+			ofs << "    <Piece Extent=\"" << vtk_extent_string(ext.get(p)) << "\">\n";
+			ofs << "      <PointData>\n";
+
+			for (size_t k = 0 ; k < n_fused ; k++)
+			{
+				std::string postfix = (n_fused > 1)?"_" + std::to_string(k):"";
+
+				if (k < cg.grids.size())
+				{vtk_xml_grid_fill<prp,ele_type>(arrs,*cg.grids.get(k),start.get(p),stop.get(p),prop_names,postfix,ft);}
+				else
+				{
+					vtk_xml_grid_fill<prp,ele_type>(arrs,*cg.grids.get(0),start.get(p),stop.get(p),prop_names,postfix,ft);
+
+					for (size_t j = 0 ; j < arrs.size() ; j++)
+					{arrs.get(j).zero();}
+				}
+
+				vtk_xml_write_arrays(ofs,arrs,"        ",appended);
+			}
+
+			ofs << "      </PointData>\n";
+			ofs << "    </Piece>\n";
+		}
+
+		ofs << "  </ImageData>\n";
+		vtk_xml_write_appended(ofs,appended);
+		ofs << "</VTKFile>\n";
+
+		return io_prof_close(ofs,p_encode,"vtk_flush");
+	}
+
 public:
 
 	/*!
@@ -649,6 +828,8 @@ public:
 			                          std::string g_name = "grids",
 									  file_type ft = file_type::ASCII)
 	{
+		io_prof_scope p_encode("vtk_encode");
+
 		// Header for the vtk
 		std::string vtk_header;
 		// Point list of the VTK
@@ -705,21 +886,60 @@ public:
 
 
 		// write the file
-		std::ofstream ofs(file);
+		return io_prof_write_file(file,p_encode,"vtk_flush",{vtk_header,point_prop_header,point_list,vertex_prop_header,
+		                                                     vertex_list,point_data_header,point_data});
+	}
 
-		// Check if the file is open
-		if (ofs.is_open() == false)
-		{std::cerr << "Error cannot create the VTK file: " + file + "\n";}
+	/*! \brief Write the staggered grids as XML ImageData
+	 *
+	 * Each staggered position (combination) is written as its own image file_<pos>.vti, with
+	 * the origin shifted by spacing/2 * (1 + cmb). pos is the shift in half-spacing units
+	 * for each direction (for example file_01.vti for cmb = (-1,0)). Every sub-domain is a piece
+	 * of the image and contain only its domain part
+	 *
+	 * \tparam prp property to write [default = -1 (all)]
+	 *
+	 * \param file path where to write (without extension)
+	 * \param prop_names properties name (can also be a vector of size 0)
+	 * \param ft specify if it is a BINARY, APPENDED or ASCII file [default = BINARY]
+	 *
+	 * \return true if the files are succeful written
+	 *
+	 */
+	template<int prp = -1> bool write_xml(std::string file,
+										  const openfpm::vector<std::string> & prop_names,
+										  file_type ft = file_type::BINARY)
+	{
+		openfpm::vector<comb<pair::first::dims>> cmbs;
 
-		ofs << vtk_header << point_prop_header << point_list <<
-				vertex_prop_header << vertex_list << point_data_header << point_data;
+		for (size_t i = 0 ; i < vg.size() ; i++)
+		{
+			for (size_t j = 0 ; j < vg.get(i).g.size() ; j++)
+			{
+				size_t c = 0;
+				for ( ; c < cmbs.size() ; c++)
+				{
+					if (cmbs.get(c) == vg.get(i).g.get(j).cmb)
+					{break;}
+				}
 
-		// Close the file
+				if (c == cmbs.size())
+				{cmbs.add(vg.get(i).g.get(j).cmb);}
+			}
+		}
+
+		bool ret = true;
 
-		ofs.close();
+		for (size_t c = 0 ; c < cmbs.size() ; c++)
+		{
+			std::string pos;
+			for (size_t k = 0 ; k < pair::first::dims ; k++)
+			{pos += std::to_string(1 + cmbs.get(c).c[k]);}
+
+			ret &= write_cmb_image<prp>(file + "_" + pos + ".vti",cmbs.get(c),prop_names,ft);
+		}
 
-		// Completed succefully
-		return true;
+		return ret;
 	}
 };
 
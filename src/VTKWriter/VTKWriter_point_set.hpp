@@ -685,6 +685,8 @@ public:
                                       std::string meta_data = "",
                                       file_type ft = file_type::ASCII)
     {
+        io_prof_scope p_encode("vtk_encode");
+
         // Header for the vtk
         std::string vtk_header;
         // Point list of the VTK
@@ -748,21 +750,8 @@ public:
         std::string closingFile="      </PointData>\n    </Piece>\n  </PolyData>\n</VTKFile>";
 
         // write the file
-        std::ofstream ofs(file);
-
-        // Check if the file is open
-        if (ofs.is_open() == false)
-        {std::cerr << "Error cannot create the VTK file: " + file + "\n";}
-
-        ofs << vtk_header << point_prop_header << point_list <<
-            vertex_prop_header << vertex_list << point_data_header << point_data << closingFile;
-
-        // Close the file
-
-        ofs.close();
-
-        // Completed succefully
-        return true;
+        return io_prof_write_file(file,p_encode,"vtk_flush",{vtk_header,point_prop_header,point_list,vertex_prop_header,
+                                                             vertex_list,point_data_header,point_data,closingFile});
     }
 };
 
@@ -500,6 +500,261 @@ BOOST_AUTO_TEST_CASE( vtk_writer_use_graph)
 	BOOST_REQUIRE_EQUAL(true,test);
 }
 
+BOOST_AUTO_TEST_CASE( vtk_writer_use_graph_xml)
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessUnitID() != 0)
+		return;
+
+	Graph_CSR<vertex2,vertex2> gr;
+
+	// Create a triangle graph
+
+	gr.addVertex(vertex2(0.0,0.0,0.0));
+	gr.addVertex(vertex2(1.0,0.0,0.0));
+	gr.addVertex(vertex2(0.0,1.0,0.0));
+
+	for (size_t i = 0 ; i < gr.getNVertex() ; i++)
+	{
+		gr.vertex(i).template get<vertex2::prp1>() = i;
+		gr.vertex(i).template get<vertex2::prp2>() = 0.5*i;
+	}
+
+	gr.addEdge(0,1,vertex2(1.0,0.0,0.0));
+	gr.addEdge(1,2,vertex2(-1.0,1.0,0.0));
+	gr.addEdge(2,0,vertex2(0.0,-1.0,0.0));
+
+	VTKWriter<Graph_CSR<vertex2,vertex2>,VTK_GRAPH> vtk(gr);
+	bool ret = vtk.write_xml("vtk_graph.vtp",file_type::ASCII);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	std::ifstream ifs("vtk_graph.vtp");
+	std::stringstream ss;
+	ss << ifs.rdbuf();
+	std::string out = ss.str();
+
+	BOOST_REQUIRE(out.find("<Piece NumberOfPoints=\"3\" NumberOfVerts=\"0\" NumberOfLines=\"3\" NumberOfStrips=\"0\" NumberOfPolys=\"0\">") != std::string::npos);
+	BOOST_REQUIRE(out.find("<DataArray type=\"UInt32\" Name=\"prp1\" format=\"ascii\">\n0\n1\n2\n") != std::string::npos);
+	BOOST_REQUIRE(out.find("<DataArray type=\"Float64\" Name=\"prp2\" format=\"ascii\">\n0\n0.5\n1\n") != std::string::npos);
+	BOOST_REQUIRE(out.find("<DataArray type=\"Float32\" Name=\"x\" NumberOfComponents=\"3\" format=\"ascii\">\n1 0 0\n-1 1 0\n0 -1 0\n") != std::string::npos);
+	BOOST_REQUIRE(out.find("<DataArray type=\"Float32\" Name=\"Points\" NumberOfComponents=\"3\" format=\"ascii\">\n0 0 0\n1 0 0\n0 1 0\n") != std::string::npos);
+	BOOST_REQUIRE(out.find("<DataArray type=\"Int32\" Name=\"connectivity\" format=\"ascii\">\n0\n1\n1\n2\n2\n0\n") != std::string::npos);
+	BOOST_REQUIRE(out.find("<DataArray type=\"Int32\" Name=\"offsets\" format=\"ascii\">\n2\n4\n6\n") != std::string::npos);
+
+	// appended raw encoding
+
+	ret = vtk.write_xml("vtk_graph_app.vtp",file_type::APPENDED);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	std::ifstream ifs2("vtk_graph_app.vtp");
+	std::stringstream ss2;
+	ss2 << ifs2.rdbuf();
+	out = ss2.str();
+
+	BOOST_REQUIRE(out.find("<DataArray type=\"Float32\" Name=\"x\" NumberOfComponents=\"3\" format=\"appended\" offset=\"0\"/>") != std::string::npos);
+	BOOST_REQUIRE(out.find("<DataArray type=\"UInt32\" Name=\"prp1\" format=\"appended\" offset=\"44\"/>") != std::string::npos);
+	BOOST_REQUIRE(out.find("<DataArray type=\"Float64\" Name=\"prp2\" format=\"appended\" offset=\"64\"/>") != std::string::npos);
+	BOOST_REQUIRE(out.find("<AppendedData encoding=\"raw\">") != std::string::npos);
+}
+
+/*! \brief Ring distributed across the processors (minimal DistGraph interface)
+ *
+ * Every processor own two vertices, the vertex with global index k has id 100 + k, gid k
+ * and one edge to the vertex k+1 (the last vertex close the ring on the first one), so with
+ * more than one processor every piece has one edge that target the next processor. The
+ * targets of the edges are ids, the ghost requested with reqVertex are rebuilt in sync()
+ *
+ */
+struct vtk_dist_ring
+{
+	typedef vertex2 V_type;
+	typedef vertex2 E_type;
+	typedef Graph_CSR<vertex2,vertex2>::V_container V_container;
+	typedef Graph_CSR<vertex2,vertex2>::E_container E_container;
+
+	//! owned and ghost vertices, the edges are stored as self loops of their source
+	Graph_CSR<vertex2,vertex2> gs;
+
+	//! gid of the vertices
+	openfpm::vector<size_t> v_gid;
+
+	//! source (local index) of the edges
+	openfpm::vector<size_t> e_src;
+
+	//! target (id) of the edges
+	openfpm::vector<size_t> e_trg;
+
+	//! requested ghost vertices (gid)
+	openfpm::vector<size_t> req;
+
+	//! processor id
+	size_t rank;
+
+	//! total number of vertices
+	size_t n_tot;
+
+	//! Iterator over the edges, the target is the id of the vertex
+	struct edge_iterator
+	{
+		const vtk_dist_ring & g;
+		size_t k;
+
+		bool isNext() const {return k < g.e_src.size();}
+		size_t get() const {return k;}
+		size_t source() const {return g.e_src.get(k);}
+		size_t target() const {return g.e_trg.get(k);}
+		edge_iterator & operator++() {k++; return *this;}
+	};
+
+	/*! \brief Add the vertex with gid k
+	 *
+	 * \param k gid
+	 *
+	 */
+	void add_vertex(size_t k)
+	{
+		vertex2 v(k,0.0,0.0);
+		boost::fusion::at_c<vertex2::prp1>(v.data) = k;
+		boost::fusion::at_c<vertex2::prp2>(v.data) = 0.5*k;
+
+		gs.addVertex(v);
+		v_gid.add(k);
+	}
+
+	/*! \brief Build the part of the ring owned by this processor
+	 *
+	 */
+	void build()
+	{
+		gs.clear();
+		v_gid.clear();
+		e_src.clear();
+		e_trg.clear();
+
+		for (size_t i = 0 ; i < 2 ; i++)
+		{add_vertex(2*rank + i);}
+
+		for (size_t i = 0 ; i < 2 ; i++)
+		{
+			gs.addEdge(i,i,vertex2(1.0,0.0,0.0));
+			e_src.add(i);
+			e_trg.add(100 + (2*rank + i + 1) % n_tot);
+		}
+	}
+
+	vtk_dist_ring(size_t rank, size_t n_proc)
+	:rank(rank),n_tot(2*n_proc)
+	{
+		build();
+	}
+
+	size_t getNVertex() const {return gs.getNVertex();}
+	size_t getNEdge() const {return e_src.size();}
+	size_t getVertexId(size_t i) const {return 100 + v_gid.get(i);}
+	size_t getVertexGlobalId(size_t i) const {return v_gid.get(i);}
+	auto vertex(size_t i) const -> decltype(gs.vertex(i)) {return gs.vertex(i);}
+	auto edge(size_t k) const -> decltype(gs.edge(k)) {return gs.edge(k);}
+	auto getVertexIterator() const -> decltype(gs.getVertexIterator()) {return gs.getVertexIterator();}
+	edge_iterator getEdgeIterator() const {return edge_iterator{*this,0};}
+
+	size_t nodeById(size_t id) const
+	{
+		for (size_t i = 0 ; i < v_gid.size() ; i++)
+		{
+			if (100 + v_gid.get(i) == id)
+			{return i;}
+		}
+
+		return (size_t)-1;
+	}
+
+	void reqVertex(size_t gid) {req.add(gid);}
+
+	void sync()
+	{
+		for (size_t i = 0 ; i < req.size() ; i++)
+		{
+			if (nodeById(100 + req.get(i)) == (size_t)-1)
+			{add_vertex(req.get(i));}
+		}
+
+		req.clear();
+	}
+
+	void deleteGhosts()
+	{
+		if (getNVertex() != 2)
+		{
+			build();
+		}
+	}
+};
+
+BOOST_AUTO_TEST_CASE( vtk_writer_use_dist_graph_pvtp )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	size_t rank = v_cl.getProcessUnitID();
+	size_t n_proc = v_cl.getProcessingUnits();
+
+	vtk_dist_ring g(rank,n_proc);
+
+	VTKWriter<vtk_dist_ring,DIST_GRAPH> vtk(g);
+	bool ret = vtk.write_pvtp("vtk_dist_ring",file_type::ASCII);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	// the ghost are removed after the write
+
+	BOOST_REQUIRE_EQUAL(g.getNVertex(),2ul);
+
+	// every processor check its piece, the target of the second edge is on the next processor
+	// and is written as a ghost point
+
+	std::ifstream ifs("vtk_dist_ring_" + std::to_string(rank) + ".vtp");
+	std::stringstream ss;
+	ss << ifs.rdbuf();
+	std::string out = ss.str();
+
+	size_t nxt = (2*rank + 2) % (2*n_proc);
+	bool remote = (n_proc > 1);
+
+	std::string n_pnt = (remote == true)?"3":"2";
+	std::string gidx = std::to_string(2*rank) + "\n" + std::to_string(2*rank+1) + "\n" + ((remote == true)?std::to_string(nxt) + "\n":"");
+	std::string ghost = (remote == true)?"0\n0\n1\n":"0\n0\n";
+	std::string conn = (remote == true)?"0\n1\n1\n2\n":"0\n1\n1\n0\n";
+
+	BOOST_REQUIRE(out.find("<Piece NumberOfPoints=\"" + n_pnt + "\" NumberOfVerts=\"0\" NumberOfLines=\"2\"") != std::string::npos);
+	BOOST_REQUIRE(out.find("Name=\"global_index\" format=\"ascii\">\n" + gidx + "        </DataArray>") != std::string::npos);
+	BOOST_REQUIRE(out.find("Name=\"vtkGhostType\" format=\"ascii\">\n" + ghost + "        </DataArray>") != std::string::npos);
+	BOOST_REQUIRE(out.find("Name=\"connectivity\" format=\"ascii\">\n" + conn + "        </DataArray>") != std::string::npos);
+	BOOST_REQUIRE(out.find("Name=\"offsets\" format=\"ascii\">\n2\n4\n        </DataArray>") != std::string::npos);
+
+	if (rank != 0)
+	{return;}
+
+	std::ifstream ifs2("vtk_dist_ring.pvtp");
+	std::stringstream ss2;
+	ss2 << ifs2.rdbuf();
+	out = ss2.str();
+
+	BOOST_REQUIRE(out.find("<PDataArray type=\"UInt64\" Name=\"global_index\"/>") != std::string::npos);
+	BOOST_REQUIRE(out.find("<PDataArray type=\"UInt8\" Name=\"vtkGhostType\"/>") != std::string::npos);
+
+	size_t n_piece = 0;
+	size_t pos = 0;
+	while ((pos = out.find("<Piece Source=", pos)) != std::string::npos)
+	{
+		n_piece++;
+		pos++;
+	}
+
+	BOOST_REQUIRE_EQUAL(n_piece,n_proc);
+
+	for (size_t i = 0 ; i < n_proc ; i++)
+	{BOOST_REQUIRE(out.find("<Piece Source=\"vtk_dist_ring_" + std::to_string(i) + ".vtp\"/>") != std::string::npos);}
+}
+
 BOOST_AUTO_TEST_CASE( vtk_writer_use_vector_box)
 {
 	Vcluster<> & v_cl = create_vcluster();
@@ -663,6 +918,70 @@ void fill_grid_some_data_scal(grid_cpu<2,Point_test_scal<float>> & g)
 	}
 }
 
+BOOST_AUTO_TEST_CASE( vtk_writer_use_vector_box_vtu)
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	// Create a vector of boxes
+	openfpm::vector<Box<2,float>> vb;
+
+	vb.add(Box<2,float>({0.2,0.2},{1.0,0.5}));
+	vb.add(Box<2,float>({0.0,0.0},{0.2,0.2}));
+	vb.add(Box<2,float>({0.2,0.0},{0.5,0.2}));
+	vb.add(Box<2,float>({0.5,0.0},{1.0,0.2}));
+	vb.add(Box<2,float>({0.0,0.2},{0.2,0.5}));
+	vb.add(Box<2,float>({0.0,0.5},{1.0,1.0}));
+
+	VTKWriter<openfpm::vector<Box<2,float>>,VECTOR_BOX> vtk_box;
+	vtk_box.add(vb);
+
+	// every processor write its boxes
+
+	bool ret = vtk_box.write_pvtu("vtk_box_p");
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	if (v_cl.getProcessUnitID() != 0)
+	{return;}
+
+	std::ifstream ifs("vtk_box_p.pvtu");
+	std::stringstream ss;
+	ss << ifs.rdbuf();
+	std::string out = ss.str();
+
+	BOOST_REQUIRE(out.find("<PDataArray type=\"UInt32\" Name=\"processor_id\"/>") != std::string::npos);
+	BOOST_REQUIRE(out.find("<Piece Source=\"vtk_box_p_" + std::to_string(v_cl.getProcessingUnits()-1) + ".vtu\"/>") != std::string::npos);
+
+	// the 6 boxes share their corners, only 13 points are written
+
+	ret = vtk_box.write_vtu("vtk_box.vtu",3,file_type::ASCII);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	std::ifstream ifs2("vtk_box.vtu");
+	std::stringstream ss2;
+	ss2 << ifs2.rdbuf();
+	out = ss2.str();
+
+	BOOST_REQUIRE(out.find("<Piece NumberOfPoints=\"13\" NumberOfCells=\"6\">") != std::string::npos);
+	BOOST_REQUIRE(out.find("<DataArray type=\"UInt32\" Name=\"box_id\" format=\"ascii\">\n0\n1\n2\n3\n4\n5\n") != std::string::npos);
+	BOOST_REQUIRE(out.find("<DataArray type=\"UInt32\" Name=\"processor_id\" format=\"ascii\">\n3\n3\n") != std::string::npos);
+	BOOST_REQUIRE(out.find("<DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\">\n0\n1\n2\n3\n4\n5\n6\n0\n5\n7\n0\n8\n") != std::string::npos);
+
+	// the AppendedData section follow the closing of the UnstructuredGrid
+
+	ret = vtk_box.write_vtu("vtk_box_app.vtu",3,file_type::APPENDED);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	std::ifstream ifs3("vtk_box_app.vtu");
+	std::stringstream ss3;
+	ss3 << ifs3.rdbuf();
+	out = ss3.str();
+
+	size_t end_ug = out.find("  </UnstructuredGrid>\n");
+	BOOST_REQUIRE(end_ug != std::string::npos);
+	BOOST_REQUIRE(out.find("</UnstructuredGrid>",end_ug + 3) == std::string::npos);
+	BOOST_REQUIRE(out.find("    </Piece>\n  </UnstructuredGrid>\n  <AppendedData encoding=\"raw\">") != std::string::npos);
+}
+
 BOOST_AUTO_TEST_CASE( vtk_writer_use_grids)
 {
 	Vcluster<> & v_cl = create_vcluster();
@@ -966,6 +1285,592 @@ BOOST_AUTO_TEST_CASE( vtk_writer_use_grids)
 }
 
 
+BOOST_AUTO_TEST_CASE( vtk_writer_use_grids_slice )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessUnitID() != 0)
+	{return;}
+
+	typedef grid_cpu<3,aggregate<float,float[3]>> grid_type;
+
+	size_t sz[] = {8,8,8};
+	grid_type g1(sz);
+	g1.setMemory();
+
+	auto it = g1.getIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		g1.template get<0>(key) = key.get(0) + 10*key.get(1) + 100*key.get(2);
+		g1.template get<1>(key)[0] = key.get(0);
+		g1.template get<1>(key)[1] = key.get(1);
+		g1.template get<1>(key)[2] = key.get(2);
+
+		++it;
+	}
+
+	// The second grid is shifted by 8 nodes in x
+	Point<3,float> offset1({0.0,0.0,0.0});
+	Point<3,float> offset2({0.8,0.0,0.0});
+	Point<3,float> spacing({0.1,0.1,0.1});
+	Box<3,size_t> d1({0,0,0},{7,7,7});
+	Box<3,size_t> d2({0,1,0},{6,7,7});
+
+	VTKWriter<boost::mpl::pair<grid_type,float>,VECTOR_GRIDS> vtk_g;
+	vtk_g.add(g1,offset1,spacing,d1);
+	vtk_g.add(g1,offset2,spacing,d2);
+
+	openfpm::vector<std::string> prp_names;
+	prp_names.add("scalar");
+	prp_names.add("vector");
+
+	// z = 0.31 is snapped to the node 3
+	bool ret = vtk_g.write_slice<0>("vtk_grids_slice.vti",prp_names,2,0.31,file_type::ASCII);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	std::ifstream ifs("vtk_grids_slice.vti");
+	std::stringstream ss;
+	ss << ifs.rdbuf();
+	std::string out = ss.str();
+
+	BOOST_REQUIRE(out.find("WholeExtent=\"0 14 0 7 3 3\"") != std::string::npos);
+	BOOST_REQUIRE(out.find("<Piece Extent=\"0 7 0 7 3 3\">") != std::string::npos);
+	BOOST_REQUIRE(out.find("<Piece Extent=\"8 14 1 7 3 3\">") != std::string::npos);
+	BOOST_REQUIRE(out.find("Name=\"vector\"") == std::string::npos);
+
+	// Check the values of the first piece
+
+	size_t pos = out.find("format=\"ascii\">\n");
+	BOOST_REQUIRE(pos != std::string::npos);
+
+	std::stringstream vals(out.substr(pos + 16));
+
+	bool match = true;
+	for (size_t j = 0 ; j < 8 ; j++)
+	{
+		for (size_t i = 0 ; i < 8 ; i++)
+		{
+			float v;
+			vals >> v;
+			match &= (v == i + 10*j + 300);
+		}
+	}
+
+	BOOST_REQUIRE_EQUAL(match,true);
+
+	// A plane outside the grids produce an empty image
+
+	ret = vtk_g.write_slice("vtk_grids_slice_empty.vti",prp_names,0,5.0);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	std::ifstream ifs2("vtk_grids_slice_empty.vti");
+	std::stringstream ss2;
+	ss2 << ifs2.rdbuf();
+	BOOST_REQUIRE(ss2.str().find("<Piece") == std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE( vtk_writer_use_grids_pslice )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	typedef grid_cpu<2,aggregate<double>> grid_type;
+
+	size_t sz[] = {4,4};
+	grid_type g1(sz);
+	g1.setMemory();
+
+	auto it = g1.getIterator();
+
+	while (it.isNext())
+	{
+		g1.template get<0>(it.get()) = v_cl.getProcessUnitID();
+
+		++it;
+	}
+
+	// Each processor has a grid shifted in x by 4 nodes
+
+	Point<2,double> offset({0.4*v_cl.getProcessUnitID(),0.0});
+	Point<2,double> spacing({0.1,0.1});
+	Box<2,size_t> d1({0,0},{3,3});
+
+	VTKWriter<boost::mpl::pair<grid_type,double>,VECTOR_GRIDS> vtk_g;
+	vtk_g.add(g1,offset,spacing,d1);
+
+	openfpm::vector<std::string> prp_names;
+
+	// Only processor 0 intersect the plane x = 0.1
+
+	bool ret = vtk_g.write_pslice("vtk_grids_pslice",prp_names,0,0.1);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	if (v_cl.getProcessUnitID() == 0)
+	{
+		std::ifstream ifs("vtk_grids_pslice.pvti");
+		std::stringstream ss;
+		ss << ifs.rdbuf();
+		std::string out = ss.str();
+
+		BOOST_REQUIRE(out.find("WholeExtent=\"1 1 0 3 0 0\"") != std::string::npos);
+		BOOST_REQUIRE(out.find("<Piece Extent=\"1 1 0 3 0 0\" Source=\"vtk_grids_pslice_0_0.vti\"/>") != std::string::npos);
+		BOOST_REQUIRE(out.find("vtk_grids_pslice_1_0.vti") == std::string::npos);
+		BOOST_REQUIRE(out.find("<PDataArray type=\"Float64\" Name=\"attr0\"/>") != std::string::npos);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( vtk_writer_use_grids_amr )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessUnitID() != 0)
+	{return;}
+
+	typedef grid_cpu<2,aggregate<float>> grid_type;
+
+	size_t sz[] = {9,9};
+	grid_type g1(sz);
+	g1.setMemory();
+
+	auto it = g1.getIterator();
+
+	while (it.isNext())
+	{
+		g1.template get<0>(it.get()) = it.get().get(0);
+
+		++it;
+	}
+
+	// One coarse grid and two fine grids (half spacing)
+
+	Point<2,float> offset1({0.0,0.0});
+	Point<2,float> spacing1({0.2,0.2});
+	Box<2,size_t> d1({0,0},{8,8});
+
+	Point<2,float> offset2({0.4,0.4});
+	Point<2,float> offset3({0.8,0.4});
+	Point<2,float> spacing2({0.1,0.1});
+	Box<2,size_t> d2({0,0},{4,8});
+
+	VTKWriter<boost::mpl::pair<grid_type,float>,VECTOR_GRIDS> vtk_g;
+	vtk_g.add(g1,offset2,spacing2,d2);
+	vtk_g.add(g1,offset1,spacing1,d1);
+	vtk_g.add(g1,offset3,spacing2,d2);
+
+	openfpm::vector<std::string> prp_names;
+	bool ret = vtk_g.write_amr("vtk_grids_amr",prp_names);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	std::ifstream ifs("vtk_grids_amr.vthb");
+	std::stringstream ss;
+	ss << ifs.rdbuf();
+	std::string out = ss.str();
+
+	BOOST_REQUIRE(out.find("<vtkOverlappingAMR origin=\"0 0 0\" grid_description=\"XY\">") != std::string::npos);
+	BOOST_REQUIRE(out.find("<Block level=\"0\" spacing=\"0.2 0.2 1\">") != std::string::npos);
+	BOOST_REQUIRE(out.find("<Block level=\"1\" spacing=\"0.1 0.1 1\">") != std::string::npos);
+	BOOST_REQUIRE(out.find("<DataSet index=\"0\" amr_box=\"0 7 0 7 0 -1\" file=\"vtk_grids_amr_0_0.vti\"/>") != std::string::npos);
+	BOOST_REQUIRE(out.find("<DataSet index=\"0\" amr_box=\"4 7 4 11 0 -1\" file=\"vtk_grids_amr_1_0.vti\"/>") != std::string::npos);
+	BOOST_REQUIRE(out.find("<DataSet index=\"1\" amr_box=\"8 11 4 11 0 -1\" file=\"vtk_grids_amr_1_1.vti\"/>") != std::string::npos);
+
+	std::ifstream ifs2("vtk_grids_amr_1_1.vti");
+	std::stringstream ss2;
+	ss2 << ifs2.rdbuf();
+	BOOST_REQUIRE(ss2.str().find("<Piece Extent=\"8 12 4 12 0 0\">") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE( vtk_writer_use_grids_amr_anisotropic )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessUnitID() != 0)
+	{return;}
+
+	typedef grid_cpu<2,aggregate<float>> grid_type;
+
+	size_t sz[] = {5,5};
+	grid_type g1(sz);
+	g1.setMemory();
+
+	// same spacing on x, refined only on y, and refined on both
+
+	Point<2,float> offset({0.0,0.0});
+	Point<2,float> spacing1({0.2,0.2});
+	Point<2,float> spacing2({0.2,0.1});
+	Point<2,float> spacing3({0.1,0.1});
+	Box<2,size_t> d({0,0},{4,4});
+
+	VTKWriter<boost::mpl::pair<grid_type,float>,VECTOR_GRIDS> vtk_g;
+	vtk_g.add(g1,offset,spacing3,d);
+	vtk_g.add(g1,offset,spacing2,d);
+	vtk_g.add(g1,offset,spacing1,d);
+
+	openfpm::vector<std::string> prp_names;
+	bool ret = vtk_g.write_amr("vtk_grids_amr_an",prp_names);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	std::ifstream ifs("vtk_grids_amr_an.vthb");
+	std::stringstream ss;
+	ss << ifs.rdbuf();
+	std::string out = ss.str();
+
+	BOOST_REQUIRE(out.find("<Block level=\"0\" spacing=\"0.2 0.2 1\">") != std::string::npos);
+	BOOST_REQUIRE(out.find("<Block level=\"1\" spacing=\"0.2 0.1 1\">") != std::string::npos);
+	BOOST_REQUIRE(out.find("<Block level=\"2\" spacing=\"0.1 0.1 1\">") != std::string::npos);
+	BOOST_REQUIRE(out.find("<Block level=\"3\"") == std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE( vtk_writer_use_grids_cell )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	typedef grid_cpu<2,aggregate<float,float[2]>> grid_type;
+
+	size_t sz[] = {6,6};
+	grid_type g1(sz);
+	g1.setMemory();
+
+	auto it = g1.getIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		g1.template get<0>(key) = key.get(0) + 10*key.get(1);
+		g1.template get<1>(key)[0] = 1.0;
+		g1.template get<1>(key)[1] = 2.0;
+
+		++it;
+	}
+
+	// Each processor has a grid shifted in y by 4 cells, the domain is 4x4
+
+	Point<2,float> offset({0.0,0.4f*v_cl.getProcessUnitID()});
+	Point<2,float> spacing({0.1,0.1});
+	Box<2,size_t> d1({1,1},{4,4});
+
+	VTKWriter<boost::mpl::pair<grid_type,float>,VECTOR_GRIDS> vtk_g;
+	vtk_g.add(g1,offset,spacing,d1);
+
+	openfpm::vector<std::string> prp_names;
+	prp_names.add("rho");
+	prp_names.add("vel");
+
+	bool ret = vtk_g.write_pimage("vtk_grids_cell",prp_names,file_type::ASCII,vtk_data_location::CELL_DATA);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	if (v_cl.getProcessUnitID() == 0)
+	{
+		std::ifstream ifs("vtk_grids_cell.pvti");
+		std::stringstream ss;
+		ss << ifs.rdbuf();
+		std::string out = ss.str();
+
+		std::string wext = "1 5 1 " + std::to_string(4*v_cl.getProcessingUnits()+1) + " 0 0";
+
+		BOOST_REQUIRE(out.find("WholeExtent=\"" + wext + "\" GhostLevel=\"0\" Origin=\"-0.05 -0.05 0\"") != std::string::npos);
+		BOOST_REQUIRE(out.find("<PCellData>") != std::string::npos);
+		BOOST_REQUIRE(out.find("<PDataArray type=\"Float32\" Name=\"vel\" NumberOfComponents=\"3\"/>") != std::string::npos);
+		BOOST_REQUIRE(out.find("<Piece Extent=\"1 5 1 5 0 0\" Source=\"vtk_grids_cell_0_0.vti\"/>") != std::string::npos);
+
+		std::ifstream ifs2("vtk_grids_cell_0_0.vti");
+		std::stringstream ss2;
+		ss2 << ifs2.rdbuf();
+		out = ss2.str();
+
+		BOOST_REQUIRE(out.find("<CellData>") != std::string::npos);
+		BOOST_REQUIRE(out.find("<PointData>") == std::string::npos);
+
+		// 4x4 cells, the first value is the one of the node (1,1)
+
+		size_t pos = out.find("format=\"ascii\">\n");
+		BOOST_REQUIRE(pos != std::string::npos);
+
+		std::stringstream vals(out.substr(pos + 16));
+
+		bool match = true;
+		for (size_t j = 1 ; j <= 4 ; j++)
+		{
+			for (size_t i = 1 ; i <= 4 ; i++)
+			{
+				float v;
+				vals >> v;
+				match &= (v == i + 10*j);
+			}
+		}
+
+		BOOST_REQUIRE_EQUAL(match,true);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( vtk_writer_use_grids_pimage_pieces )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	typedef grid_cpu<2,aggregate<float>> grid_type;
+
+	size_t sz[] = {4,4};
+	grid_type g1(sz);
+	g1.setMemory();
+
+	auto it = g1.getIterator();
+
+	while (it.isNext())
+	{
+		g1.template get<0>(it.get()) = v_cl.getProcessUnitID();
+
+		++it;
+	}
+
+	// Each processor has two grids that are not adjacent, the hole between them must not be
+	// covered by any piece
+
+	float y = 0.4f*v_cl.getProcessUnitID();
+
+	Point<2,float> offset1({0.0,y});
+	Point<2,float> offset2({1.0,y});
+	Point<2,float> spacing({0.1,0.1});
+	Box<2,size_t> d1({0,0},{3,3});
+
+	VTKWriter<boost::mpl::pair<grid_type,float>,VECTOR_GRIDS> vtk_g;
+	vtk_g.add(g1,offset1,spacing,d1);
+	vtk_g.add(g1,offset2,spacing,d1);
+
+	openfpm::vector<std::string> prp_names;
+
+	bool ret = vtk_g.write_pimage("vtk_grids_pimage_pieces",prp_names,file_type::ASCII);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	if (v_cl.getProcessUnitID() == 0)
+	{
+		std::ifstream ifs("vtk_grids_pimage_pieces.pvti");
+		std::stringstream ss;
+		ss << ifs.rdbuf();
+		std::string out = ss.str();
+
+		std::string wext = "0 13 0 " + std::to_string(4*v_cl.getProcessingUnits()-1) + " 0 0";
+		BOOST_REQUIRE(out.find("WholeExtent=\"" + wext + "\"") != std::string::npos);
+
+		for (size_t i = 0 ; i < v_cl.getProcessingUnits() ; i++)
+		{
+			std::string ey = std::to_string(4*i) + " " + std::to_string(4*i+3);
+			std::string base = "vtk_grids_pimage_pieces_" + std::to_string(i);
+
+			BOOST_REQUIRE(out.find("<Piece Extent=\"0 3 " + ey + " 0 0\" Source=\"" + base + "_0.vti\"/>") != std::string::npos);
+			BOOST_REQUIRE(out.find("<Piece Extent=\"10 13 " + ey + " 0 0\" Source=\"" + base + "_1.vti\"/>") != std::string::npos);
+		}
+
+		// every piece file contain only its grid
+
+		std::ifstream ifs2("vtk_grids_pimage_pieces_0_1.vti");
+		std::stringstream ss2;
+		ss2 << ifs2.rdbuf();
+		out = ss2.str();
+
+		BOOST_REQUIRE(out.find("<ImageData WholeExtent=\"10 13 0 3 0 0\"") != std::string::npos);
+		BOOST_REQUIRE(out.find("<Piece Extent=\"0 3") == std::string::npos);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( vtk_writer_use_grids_sparse )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessUnitID() != 0)
+	{return;}
+
+	typedef grid_cpu<2,aggregate<float>> grid_type;
+
+	size_t sz[] = {8,8};
+	grid_type g1(sz);
+	g1.setMemory();
+
+	auto it = g1.getIterator();
+
+	while (it.isNext())
+	{
+		g1.template get<0>(it.get()) = it.get().get(0);
+
+		++it;
+	}
+
+	// two grids side by side in x, the nodes with x = 7 of the first are the nodes with x = 0 of the second
+
+	Point<2,float> offset1({0.0,0.0});
+	Point<2,float> offset2({0.7,0.0});
+	Point<2,float> spacing({0.1,0.1});
+	Box<2,size_t> d({0,0},{7,7});
+
+	VTKWriter<boost::mpl::pair<grid_type,float>,VECTOR_GRIDS> vtk_g;
+	vtk_g.add(g1,offset1,spacing,d);
+	vtk_g.add(g1,offset2,spacing,d);
+
+	openfpm::vector<std::string> prp_names;
+
+	// Only the band y = 2 is active, with blocks of 4x4 nodes only the blocks with y in [0,3] are written
+
+	auto band = [](size_t i, const grid_key_dx<2> & key) {return key.get(1) == 2;};
+
+	bool ret = vtk_g.write_sparse("vtk_grids_sparse.vtu",prp_names,4,band,file_type::ASCII);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	std::ifstream ifs("vtk_grids_sparse.vtu");
+	std::stringstream ss;
+	ss << ifs.rdbuf();
+	std::string out = ss.str();
+
+	// 15 x 4 points (one column shared), 14 x 3 pixels
+
+	BOOST_REQUIRE(out.find("<Piece NumberOfPoints=\"60\" NumberOfCells=\"42\">") != std::string::npos);
+	BOOST_REQUIRE(out.find("<DataArray type=\"UInt8\" Name=\"types\" format=\"ascii\">\n8\n") != std::string::npos);
+
+	// Same output with the data in the AppendedData section
+
+	ret = vtk_g.write_sparse("vtk_grids_sparse_app.vtu",prp_names,4,band,file_type::APPENDED);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	std::ifstream ifs_app("vtk_grids_sparse_app.vtu");
+	std::stringstream ss_app;
+	ss_app << ifs_app.rdbuf();
+	out = ss_app.str();
+
+	BOOST_REQUIRE(out.find("<Piece NumberOfPoints=\"60\" NumberOfCells=\"42\">") != std::string::npos);
+	BOOST_REQUIRE(out.find("<DataArray type=\"Float32\" Name=\"attr0\" format=\"appended\" offset=\"0\"/>") != std::string::npos);
+	BOOST_REQUIRE(out.find("<DataArray type=\"Float32\" Name=\"Points\" NumberOfComponents=\"3\" format=\"appended\" offset=\"248\"/>") != std::string::npos);
+	BOOST_REQUIRE(out.find("<DataArray type=\"Int64\" Name=\"connectivity\" format=\"appended\" offset=\"976\"/>") != std::string::npos);
+	BOOST_REQUIRE(out.find("<AppendedData encoding=\"raw\">") != std::string::npos);
+	BOOST_REQUIRE(out.find("format=\"binary\"") == std::string::npos);
+
+	// Nothing active
+
+	auto none = [](size_t i, const grid_key_dx<2> & key) {return false;};
+
+	ret = vtk_g.write_sparse("vtk_grids_sparse_empty.vtu",prp_names,4,none);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	std::ifstream ifs2("vtk_grids_sparse_empty.vtu");
+	std::stringstream ss2;
+	ss2 << ifs2.rdbuf();
+	BOOST_REQUIRE(ss2.str().find("<Piece NumberOfPoints=\"0\" NumberOfCells=\"0\">") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE( vtk_writer_use_grids_st_xml )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessUnitID() != 0)
+	{return;}
+
+	typedef grid_cpu<2,aggregate<float>> grid_type;
+
+	size_t sz[] = {4,4};
+	grid_type g1(sz);
+	g1.setMemory();
+	grid_type g2(sz);
+	g2.setMemory();
+
+	auto it = g1.getIterator();
+
+	while (it.isNext())
+	{
+		g1.template get<0>(it.get()) = 1.0;
+		g2.template get<0>(it.get()) = 2.0;
+
+		++it;
+	}
+
+	// two sub-domains, the second shifted by 4 nodes in x
+
+	Point<2,float> offset1({0.0,0.0});
+	Point<2,float> offset2({0.4,0.0});
+	Point<2,float> spacing({0.1,0.1});
+	Box<2,float> d({0,0},{3,3});
+
+	comb<2> cmb;
+	cmb.zero();
+
+	comb<2> cmb2;
+	cmb2.mone();
+
+	VTKWriter<boost::mpl::pair<grid_type,float>,VECTOR_ST_GRIDS> vtk_g;
+	vtk_g.add(0,g1,offset1,spacing,d,cmb);
+	vtk_g.add(0,g2,offset1,spacing,d,cmb);
+	vtk_g.add(1,g1,offset2,spacing,d,cmb);
+	vtk_g.add(1,g2,offset2,spacing,d,cmb2);
+
+	openfpm::vector<std::string> prp_names;
+	prp_names.add("u");
+
+	bool ret = vtk_g.write_xml("vtk_grids_st_xml",prp_names,file_type::ASCII);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	// cell centred grids (cmb = 0) are shifted by half spacing
+
+	std::ifstream ifs("vtk_grids_st_xml_11.vti");
+	std::stringstream ss;
+	ss << ifs.rdbuf();
+	std::string out = ss.str();
+
+	BOOST_REQUIRE(out.find("WholeExtent=\"0 7 0 3 0 0\" Origin=\"0.05 0.05 0\" Spacing=\"0.1 0.1 1\"") != std::string::npos);
+	BOOST_REQUIRE(out.find("<Piece Extent=\"0 3 0 3 0 0\">") != std::string::npos);
+	BOOST_REQUIRE(out.find("<Piece Extent=\"4 7 0 3 0 0\">") != std::string::npos);
+
+	// the sub-domain 1 has only one grid in cmb = 0, it write u_1 with zeros
+
+	BOOST_REQUIRE(out.find("Name=\"u\"") == std::string::npos);
+
+	size_t n_u0 = 0;
+	size_t n_u1 = 0;
+	for (size_t p = out.find("Name=\"u_0\"") ; p != std::string::npos ; p = out.find("Name=\"u_0\"",p+1))	{n_u0++;}
+	for (size_t p = out.find("Name=\"u_1\"") ; p != std::string::npos ; p = out.find("Name=\"u_1\"",p+1))	{n_u1++;}
+
+	BOOST_REQUIRE_EQUAL(n_u0,2ul);
+	BOOST_REQUIRE_EQUAL(n_u1,2ul);
+
+	size_t last = out.rfind("Name=\"u_1\" format=\"ascii\">\n");
+	BOOST_REQUIRE(last != std::string::npos);
+	BOOST_REQUIRE(out.compare(last + 27,8,"0\n0\n0\n0\n") == 0);
+
+	// the grids with cmb = -1 are not shifted
+
+	std::ifstream ifs2("vtk_grids_st_xml_00.vti");
+	std::stringstream ss2;
+	ss2 << ifs2.rdbuf();
+
+	BOOST_REQUIRE(ss2.str().find("WholeExtent=\"0 3 0 3 0 0\" Origin=\"0.4 0 0\"") != std::string::npos);
+
+	// appended encoding
+
+	ret = vtk_g.write_xml("vtk_grids_st_xml_app",prp_names,file_type::APPENDED);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	std::ifstream ifs3("vtk_grids_st_xml_app_11.vti");
+	std::stringstream ss3;
+	ss3 << ifs3.rdbuf();
+	out = ss3.str();
+
+	BOOST_REQUIRE(out.find("<DataArray type=\"Float32\" Name=\"u_0\" format=\"appended\" offset=\"0\"/>") != std::string::npos);
+	BOOST_REQUIRE(out.find("<DataArray type=\"Float32\" Name=\"u_1\" format=\"appended\" offset=\"72\"/>") != std::string::npos);
+	BOOST_REQUIRE(out.find("<AppendedData encoding=\"raw\">") != std::string::npos);
+
+	// the sub-domains without grids (0 and 1) are skipped, the origin come from the sub-domain 2
+
+	VTKWriter<boost::mpl::pair<grid_type,float>,VECTOR_ST_GRIDS> vtk_s;
+	vtk_s.add(2,g1,offset2,spacing,d,cmb);
+
+	ret = vtk_s.write_xml("vtk_grids_st_xml_sparse",prp_names,file_type::ASCII);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	std::ifstream ifs4("vtk_grids_st_xml_sparse_11.vti");
+	std::stringstream ss4;
+	ss4 << ifs4.rdbuf();
+
+	BOOST_REQUIRE(ss4.str().find("WholeExtent=\"0 3 0 3 0 0\" Origin=\"0.45 0.05 0\" Spacing=\"0.1 0.1 1\"") != std::string::npos);
+	BOOST_REQUIRE(ss4.str().find("<Piece ") != std::string::npos);
+}
+
 BOOST_AUTO_TEST_CASE( vtk_writer_use_point_set )
 {
 	Vcluster<> & v_cl = create_vcluster();
@@ -11,7 +11,13 @@
 #include <boost/math/special_functions/pow.hpp>
 #include "Space/Shape/HyperCube.hpp"
 #include <random>
+#include <unordered_map>
 #include "util/util.hpp"
+#include "VTKWriter_xml_util.hpp"
+
+#ifndef DISABLE_MPI_WRITTERS
+#include "VCluster/VCluster.hpp"
+#endif
 
 template <typename vector>
 class v_box
@@ -342,6 +348,130 @@ class VTKWriter<vector,VECTOR_BOX>
 		return v_out;
 	}
 
+	/*! \brief Write the boxes as an XML UnstructuredGrid piece
+	 *
+	 * The corners are snapped on an integer lattice of step snap and the corners
+	 * shared between boxes are written once
+	 *
+	 * Only the Piece element is written, the APPENDED data are added to appended
+	 *
+	 * \param ofs stream where to write
+	 * \param prc processor id written as cell data
+	 * \param snap lattice step used to merge the corners (0 = automatic)
+	 * \param ft file type
+	 * \param appended buffer of the AppendedData section
+	 *
+	 */
+	void write_vtu_piece(std::ostream & ofs, size_t prc, double snap, file_type ft, std::string & appended)
+	{
+		typedef typename vector::value_type box_type;
+		typedef typename box_type::btype T;
+		typedef std::array<long int,box_type::dims> lattice_point;
+
+		const size_t n_corner = 1 << box_type::dims;
+		const unsigned char cell_type = (box_type::dims == 1)?3:((box_type::dims == 2)?8:11);
+
+		// Automatic snap, a small fraction of the extension of the boxes
+
+		if (snap <= 0.0)
+		{
+			double ext = 0.0;
+
+			for (size_t i = 0 ; i < v.size() ; i++)
+			{
+				for (size_t j = 0 ; j < v.get(i).v.size() ; j++)
+				{
+					box_type box = v.get(i).v.get(j);
+
+					for (size_t k = 0 ; k < box_type::dims ; k++)
+					{
+						ext = std::max(ext,fabs((double)box.getLow(k)));
+						ext = std::max(ext,fabs((double)box.getHigh(k)));
+					}
+				}
+			}
+
+			snap = (ext == 0.0)?1.0:ext * std::numeric_limits<T>::epsilon() * 16;
+		}
+
+		std::unordered_map<lattice_point,size_t,vtk_lattice_hash<box_type::dims>> map;
+
+		vtk_xml_data_array points;
+		vtk_xml_data_array connectivity;
+		vtk_xml_data_array offsets;
+		vtk_xml_data_array types;
+		vtk_xml_data_array box_id;
+		vtk_xml_data_array prc_id;
+
+		points.template init<T>("Points",3,ft);
+		connectivity.template init<long int>("connectivity",1,ft);
+		offsets.template init<long int>("offsets",1,ft);
+		types.template init<unsigned char>("types",1,ft);
+		box_id.template init<unsigned int>("box_id",1,ft);
+		prc_id.template init<unsigned int>("processor_id",1,ft);
+
+		size_t n_pnt = 0;
+		size_t n_cell = 0;
+
+		for (size_t i = 0 ; i < v.size() ; i++)
+		{
+			for (size_t j = 0 ; j < v.get(i).v.size() ; j++)
+			{
+				box_type box = v.get(i).v.get(j);
+
+				// corners ordered with x running fastest (VTK_PIXEL, VTK_VOXEL)
+
+				for (size_t c = 0 ; c < n_corner ; c++)
+				{
+					T x[box_type::dims];
+					lattice_point lp;
+
+					for (size_t k = 0 ; k < box_type::dims ; k++)
+					{
+						x[k] = ((c >> k) & 1)?box.getHigh(k):box.getLow(k);
+						lp[k] = lround(x[k] / snap);
+					}
+
+					auto f = map.find(lp);
+
+					if (f == map.end())
+					{
+						map[lp] = n_pnt;
+						connectivity.add((long int)n_pnt);
+
+						for (size_t k = 0 ; k < 3 ; k++)
+						{points.add((k < box_type::dims)?x[k]:(T)0);}
+
+						n_pnt++;
+					}
+					else
+					{connectivity.add((long int)f->second);}
+				}
+
+				n_cell++;
+				offsets.add((long int)(n_cell*n_corner));
+				types.add(cell_type);
+				box_id.add((unsigned int)j);
+				prc_id.add((unsigned int)prc);
+			}
+		}
+
+		ofs << "    <Piece NumberOfPoints=\"" << n_pnt << "\" NumberOfCells=\"" << n_cell << "\">\n";
+		ofs << "      <CellData>\n";
+		box_id.write(ofs,"        ",appended);
+		prc_id.write(ofs,"        ",appended);
+		ofs << "      </CellData>\n";
+		ofs << "      <Points>\n";
+		points.write(ofs,"        ",appended);
+		ofs << "      </Points>\n";
+		ofs << "      <Cells>\n";
+		connectivity.write(ofs,"        ",appended);
+		offsets.write(ofs,"        ",appended);
+		types.write(ofs,"        ",appended);
+		ofs << "      </Cells>\n";
+		ofs << "    </Piece>\n";
+	}
+
 public:
 
 	/*!
@@ -376,6 +506,8 @@ public:
 
 	template<int prp = -1> bool write(std::string file, std::string graph_name="Graph", file_type ft = file_type::ASCII)
 	{
+		io_prof_scope p_encode("vtk_encode");
+
 		// Header for the vtk
 		std::string vtk_header;
 		// Point list of the VTK
@@ -443,22 +575,107 @@ public:
 		cell_data_list = get_cell_data_list();
 
 		// write the file
+		return io_prof_write_file(file,p_encode,"vtk_flush",{vtk_header,point_prop_header,point_list,cell_prop_header,cell_list,
+		                                                     cell_types_header,cell_types_list,cell_data_header,cell_data_list});
+	}
+
+	/*! \brief Write the boxes as a binary XML UnstructuredGrid (.vtu)
+	 *
+	 * Corners shared between boxes are written once (they are merged on an integer
+	 * lattice of step snap), the id of the box in its vector and the processor id are
+	 * written as UInt32 cell data
+	 *
+	 * \param file path where to write (.vtu)
+	 * \param prc processor id written as cell data [default = 0]
+	 * \param ft specify if it is a BINARY, APPENDED or ASCII file [default = BINARY]
+	 * \param snap lattice step used to merge the corners [default = 0 (automatic)]
+	 *
+	 * \return true if the file has been written
+	 *
+	 */
+	bool write_vtu(std::string file, size_t prc = 0, file_type ft = file_type::BINARY, double snap = 0.0)
+	{
+		io_prof_scope p_encode("vtk_encode");
+
 		std::ofstream ofs(file);
 
 		// Check if the file is open
 		if (ofs.is_open() == false)
-		{std::cerr << "Error cannot create the VTK file: " + file + "\n";}
+		{
+			std::cerr << "Error cannot create the VTK file: " + file + "\n";
+			return false;
+		}
+
+		std::string appended;
+
+		ofs << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\">\n";
+		ofs << "  <UnstructuredGrid>\n";
+		write_vtu_piece(ofs,prc,snap,ft,appended);
+		ofs << "  </UnstructuredGrid>\n";
+		vtk_xml_write_appended(ofs,appended);
+		ofs << "</VTKFile>\n";
+
+		return io_prof_close(ofs,p_encode,"vtk_flush");
+	}
+
+#ifndef DISABLE_MPI_WRITTERS
+
+	/*! \brief Write the boxes of all processors without gathering them
+	 *
+	 * Must be called by all processors. Every processor write its boxes in file_<rank>.vtu
+	 * (see write_vtu) and processor 0 write file.pvtu that collect all the pieces
+	 *
+	 * \param file path where to write (without extension)
+	 * \param ft specify if it is a BINARY, APPENDED or ASCII file [default = BINARY]
+	 * \param snap lattice step used to merge the corners [default = 0 (automatic)]
+	 *
+	 * \return true if the files has been written
+	 *
+	 */
+	bool write_pvtu(std::string file, file_type ft = file_type::BINARY, double snap = 0.0)
+	{
+		typedef typename vector::value_type::btype T;
+
+		Vcluster<> & v_cl = create_vcluster();
+
+		bool ret = write_vtu(file + "_" + std::to_string(v_cl.getProcessUnitID()) + ".vtu",v_cl.getProcessUnitID(),ft,snap);
+
+		if (v_cl.getProcessUnitID() != 0)
+		{return ret;}
+
+		std::ofstream ofs(file + ".pvtu");
+
+		// Check if the file is open
+		if (ofs.is_open() == false)
+		{
+			std::cerr << "Error cannot create the VTK file: " + file + ".pvtu\n";
+			return false;
+		}
+
+		std::string base = vtk_xml_basename(file);
 
-		ofs << vtk_header << point_prop_header << point_list <<
-				cell_prop_header << cell_list << cell_types_header << cell_types_list << cell_data_header << cell_data_list;
+		ofs << "<VTKFile type=\"PUnstructuredGrid\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\">\n";
+		ofs << "  <PUnstructuredGrid GhostLevel=\"0\">\n";
+		ofs << "    <PCellData>\n";
+		ofs << "      <PDataArray type=\"UInt32\" Name=\"box_id\"/>\n";
+		ofs << "      <PDataArray type=\"UInt32\" Name=\"processor_id\"/>\n";
+		ofs << "    </PCellData>\n";
+		ofs << "    <PPoints>\n";
+		ofs << "      <PDataArray type=\"" << getTypeNew<T>() << "\" NumberOfComponents=\"3\"/>\n";
+		ofs << "    </PPoints>\n";
 
-		// Close the file
+		for (size_t i = 0 ; i < v_cl.getProcessingUnits() ; i++)
+		{ofs << "    <Piece Source=\"" << base << "_" << i << ".vtu\"/>\n";}
+
+		ofs << "  </PUnstructuredGrid>\n";
+		ofs << "</VTKFile>\n";
 
 		ofs.close();
 
-		// Completed succefully
-		return true;
+		return ret;
 	}
+
+#endif
 };
 
 
@@ -0,0 +1,790 @@
+/*
+ * VTKWriter_xml_util.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef OPENFPM_IO_SRC_VTKWRITER_VTKWRITER_XML_UTIL_HPP_
+#define OPENFPM_IO_SRC_VTKWRITER_VTKWRITER_XML_UTIL_HPP_
+
+#include <algorithm>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <array>
+#include <iomanip>
+#include <string>
+#include <type_traits>
+#include "util/util.hpp"
+#include "is_vtk_writable.hpp"
+#include "VTKWriter_grids_util.hpp"
+
+/*! \brief Print a value in an ASCII XML DataArray
+ *
+ * Floating point are printed with full precision, char types are printed as numbers
+ *
+ * \param out string where to append
+ * \param v value to write
+ *
+ */
+template<typename T> inline void vtk_xml_ascii_out(std::string & out, const T & v)
+{
+	char tmp[32];
+
+	if (std::is_same<T,float>::value)
+	{snprintf(tmp,sizeof(tmp),"%.7g",(double)v);}
+	else if (std::is_same<T,double>::value)
+	{snprintf(tmp,sizeof(tmp),"%.16g",(double)v);}
+	else if (std::is_signed<T>::value)
+	{snprintf(tmp,sizeof(tmp),"%lld",(long long int)v);}
+	else
+	{snprintf(tmp,sizeof(tmp),"%llu",(unsigned long long int)v);}
+
+	out += tmp;
+}
+
+/*! \brief It store one DataArray of a VTK XML file
+ *
+ * The data are accumulated component by component, in binary (raw little endian bytes) or
+ * in ASCII. On write the binary data are encoded in base64 with an UInt64 size header
+ * (header_type="UInt64"), in case of APPENDED the raw data are moved into the
+ * AppendedData section of the file
+ *
+ */
+class vtk_xml_data_array
+{
+	//! VTK type of the array (Float32, Int64 ...)
+	std::string type;
+
+	//! Name of the array
+	std::string name;
+
+	//! Number of components
+	size_t n_comp;
+
+	//! file type
+	file_type ft;
+
+	//! raw data (binary) or the text (ASCII)
+	std::string data;
+
+	//! number of values added (used to format the ASCII output)
+	size_t n_val;
+
+public:
+
+	//! constructor
+	vtk_xml_data_array()
+	:n_comp(1),ft(file_type::BINARY),n_val(0)
+	{}
+
+	/*! \brief Initialize the data array
+	 *
+	 * \tparam T type of the components
+	 *
+	 * \param name name of the array
+	 * \param n_comp number of components
+	 * \param ft file type
+	 *
+	 */
+	template<typename T> void init(const std::string & name, size_t n_comp, file_type ft)
+	{
+		this->type = getTypeNew<T>();
+		this->name = name;
+		this->n_comp = n_comp;
+		this->ft = ft;
+		data.clear();
+		n_val = 0;
+	}
+
+	/*! \brief Add one component
+	 *
+	 * \param v value to add
+	 *
+	 */
+	template<typename T> void add(const T & v)
+	{
+		if (ft == file_type::ASCII)
+		{
+			vtk_xml_ascii_out(data,v);
+
+			n_val++;
+			if (n_val % n_comp == 0)	{data += "\n";}
+			else {data += " ";}
+		}
+		else
+		{data.append((const char *)&v,sizeof(T));}
+	}
+
+	/*! \brief Add a contiguous block of components
+	 *
+	 * In binary it is a single copy of the block
+	 *
+	 * \param v pointer to the first component
+	 * \param n number of components
+	 *
+	 */
+	template<typename T> void add_block(const T * v, size_t n)
+	{
+		if (ft == file_type::ASCII)
+		{
+			for (size_t i = 0 ; i < n ; i++)
+			{add(v[i]);}
+		}
+		else
+		{data.append((const char *)v,n*sizeof(T));}
+	}
+
+	/*! \brief Reserve space for n components of type T
+	 *
+	 * \param n number of components
+	 *
+	 */
+	template<typename T> void reserve(size_t n)
+	{
+		if (ft != file_type::ASCII)
+		{data.reserve(n*sizeof(T));}
+	}
+
+	/*! \brief Set all the components added so far to zero
+	 *
+	 */
+	void zero()
+	{
+		if (ft == file_type::ASCII)
+		{
+			size_t n = n_val;
+
+			data.clear();
+			n_val = 0;
+
+			for (size_t i = 0 ; i < n ; i++)
+			{add((int)0);}
+		}
+		else
+		{std::fill(data.begin(),data.end(),0);}
+	}
+
+	/*! \brief Check if the array has been initialized
+	 *
+	 * \return true if init has been called
+	 *
+	 */
+	bool valid() const
+	{
+		return type.size() != 0;
+	}
+
+	/*! \brief Number of components
+	 *
+	 * \return the number of components
+	 *
+	 */
+	size_t components() const
+	{
+		return n_comp;
+	}
+
+	/*! \brief Get the raw data (binary) or the text (ASCII)
+	 *
+	 * \return the raw data
+	 *
+	 */
+	const std::string & raw() const
+	{
+		return data;
+	}
+
+	/*! \brief Write the header of the DataArray (without format)
+	 *
+	 * \param out stream where to write
+	 * \param indent indentation
+	 *
+	 */
+	void write_header(std::ostream & out, const std::string & indent) const
+	{
+		out << indent << "<DataArray type=\"" << type << "\" Name=\"" << name << "\"";
+
+		if (n_comp != 1)
+		{out << " NumberOfComponents=\"" << n_comp << "\"";}
+	}
+
+	/*! \brief Write the DataArray
+	 *
+	 * \param out stream where to write
+	 * \param indent indentation
+	 *
+	 */
+	void write(std::ostream & out, const std::string & indent) const
+	{
+		write_header(out,indent);
+
+		if (ft == file_type::ASCII)
+		{
+			out << " format=\"ascii\">\n";
+			out << data;
+		}
+		else
+		{
+			out << " format=\"binary\">\n";
+
+			// The size header and the data are encoded as a single base64 stream directly
+			// from the data, in blocks multiple of 3 bytes (no padding in the middle)
+
+			size_t sz = data.size();
+			size_t tot = sizeof(size_t) + sz;
+
+			const size_t blk = 3*4096;
+			unsigned char in[blk];
+			unsigned char enc[blk/3*4];
+
+			for (size_t pos = 0 ; pos < tot ; pos += blk)
+			{
+				size_t n = std::min(blk,tot - pos);
+				size_t h = 0;
+
+				if (pos < sizeof(size_t))
+				{
+					h = std::min(sizeof(size_t) - pos,n);
+					memcpy(in,(const char *)&sz + pos,h);
+				}
+
+				memcpy(in + h,data.c_str() + pos + h - sizeof(size_t),n - h);
+
+				size_t n_enc = EncodeToBase64(in,n,enc,0);
+				out.write((const char *)enc,n_enc);
+			}
+
+			out << "\n";
+		}
+
+		out << indent << "</DataArray>\n";
+	}
+
+	/*! \brief Write the DataArray (APPENDED data go into the appended buffer)
+	 *
+	 * \param out stream where to write
+	 * \param indent indentation
+	 * \param appended buffer of the AppendedData section
+	 *
+	 */
+	void write(std::ostream & out, const std::string & indent, std::string & appended) const
+	{
+		if (ft != file_type::APPENDED)
+		{
+			write(out,indent);
+			return;
+		}
+
+		write_header(out,indent);
+		out << " format=\"appended\" offset=\"" << appended.size() << "\"/>\n";
+
+		size_t sz = data.size();
+		appended.append((const char *)&sz,sizeof(size_t));
+		appended += data;
+	}
+
+	/*! \brief Write the PDataArray entry for the parallel file
+	 *
+	 * \param out stream where to write
+	 * \param indent indentation
+	 *
+	 */
+	void write_p(std::ostream & out, const std::string & indent) const
+	{
+		out << indent << "<PDataArray type=\"" << type << "\" Name=\"" << name << "\"";
+
+		if (n_comp != 1)
+		{out << " NumberOfComponents=\"" << n_comp << "\"";}
+
+		out << "/>\n";
+	}
+};
+
+/*! \brief Convert a property into the components of an XML DataArray
+ *
+ * Scalar writable type
+ *
+ * \tparam T type of the property
+ * \tparam is_w true if the base type is VTK writable
+ * \tparam is_custom true if the type define get_vtk()
+ *
+ */
+template<typename T,
+         bool is_w = is_vtk_writable<typename std::remove_all_extents<T>::type>::value,
+         bool is_custom = is_custom_vtk_writable<T>::value>
+struct vtk_xml_prop
+{
+	//! type of the components
+	typedef typename is_vtk_writable<T>::base base;
+
+	//! the property can be written
+	static const bool writable = true;
+
+	//! number of components
+	static const size_t n_comp = 1;
+
+	/*! \brief Add the property value to the array
+	 *
+	 * \param arr array
+	 * \param v property value
+	 *
+	 */
+	template<typename V> static void add(vtk_xml_data_array & arr, const V & v)
+	{
+		arr.add((base)v);
+	}
+};
+
+//! Vector property T[N1] (2D vectors are padded to 3 components)
+template<typename T, unsigned int N1>
+struct vtk_xml_prop<T[N1],true,false>
+{
+	//! type of the components
+	typedef typename is_vtk_writable<T>::base base;
+
+	//! the property can be written
+	static const bool writable = true;
+
+	//! number of components
+	static const size_t n_comp = (N1 == 2)?3:N1;
+
+	/*! \brief Add the property value to the array
+	 *
+	 * \param arr array
+	 * \param v property value
+	 *
+	 */
+	template<typename V> static void add(vtk_xml_data_array & arr, const V & v)
+	{
+		for (size_t i = 0 ; i < N1 ; i++)
+		{arr.add((base)v[i]);}
+
+		if (N1 == 2)
+		{arr.add((base)0);}
+	}
+};
+
+//! Tensor property T[N1][N2] (written as N1*N2 components)
+template<typename T, unsigned int N1, unsigned int N2>
+struct vtk_xml_prop<T[N1][N2],true,false>
+{
+	//! type of the components
+	typedef typename is_vtk_writable<T>::base base;
+
+	//! the property can be written
+	static const bool writable = true;
+
+	//! number of components
+	static const size_t n_comp = N1*N2;
+
+	/*! \brief Add the property value to the array
+	 *
+	 * \param arr array
+	 * \param v property value
+	 *
+	 */
+	template<typename V> static void add(vtk_xml_data_array & arr, const V & v)
+	{
+		for (size_t i = 0 ; i < N1 ; i++)
+		{
+			for (size_t j = 0 ; j < N2 ; j++)
+			{arr.add((base)v[i][j]);}
+		}
+	}
+};
+
+//! Object that define get_vtk() (like Point)
+template<typename T>
+struct vtk_xml_prop<T,true,true>
+{
+	//! type of the components
+	typedef typename std::remove_const<typename std::remove_reference<decltype(std::declval<T>().get_vtk(0))>::type>::type ctype;
+
+	//! type of the components
+	typedef typename is_vtk_writable<ctype>::base base;
+
+	//! the property can be written
+	static const bool writable = true;
+
+	//! number of components
+	static const size_t n_comp = (vtk_dims<T>::value == 2)?3:vtk_dims<T>::value;
+
+	/*! \brief Add the property value to the array
+	 *
+	 * \param arr array
+	 * \param v property value
+	 *
+	 */
+	template<typename V> static void add(vtk_xml_data_array & arr, const V & v)
+	{
+		for (size_t i = 0 ; i < vtk_dims<T>::value ; i++)
+		{arr.add((base)v.get_vtk(i));}
+
+		if (vtk_dims<T>::value == 2)
+		{arr.add((base)0);}
+	}
+};
+
+//! Property that cannot be written
+template<typename T, bool is_custom>
+struct vtk_xml_prop<T,false,is_custom>
+{
+	//! type of the components
+	typedef float base;
+
+	//! the property cannot be written
+	static const bool writable = false;
+
+	//! number of components
+	static const size_t n_comp = 0;
+
+	/*! \brief Do nothing
+	 *
+	 * \param arr array
+	 * \param v property value
+	 *
+	 */
+	template<typename V> static void add(vtk_xml_data_array & arr, const V & v)
+	{}
+};
+
+/*! \brief this class is a functor for "for_each" algorithm
+ *
+ * For each property of the grid it initialize a data array (non writable properties are skipped)
+ *
+ * \tparam ele_g element that store the grid and its attributes
+ *
+ */
+template<typename ele_g>
+struct vtk_xml_grid_init_arr
+{
+	//! arrays one for each property
+	openfpm::vector<vtk_xml_data_array> & arrs;
+
+	//! properties names
+	const openfpm::vector<std::string> & prop_names;
+
+	//! post-fix to add to the names
+	const std::string & postfix;
+
+	//! file type
+	file_type ft;
+
+	/*! \brief constructor
+	 *
+	 * \param arrs data arrays
+	 * \param prop_names properties names
+	 * \param postfix post-fix to add to the names
+	 * \param ft file type
+	 *
+	 */
+	vtk_xml_grid_init_arr(openfpm::vector<vtk_xml_data_array> & arrs,
+						  const openfpm::vector<std::string> & prop_names,
+						  const std::string & postfix,
+						  file_type ft)
+	:arrs(arrs),prop_names(prop_names),postfix(postfix),ft(ft)
+	{}
+
+	//! It initialize the data array for the property T
+	template<typename T> void operator()(T& t) const
+	{
+		typedef typename ele_g::value_type::value_type aggr;
+		typedef typename boost::mpl::at<typename aggr::type,boost::mpl::int_<T::value>>::type ptype;
+
+		if (vtk_xml_prop<ptype>::writable == true)
+		{
+			std::string name = getAttrName<ele_g,has_attributes<aggr>::value>::get(T::value,prop_names,postfix);
+
+			arrs.get(T::value).template init<typename vtk_xml_prop<ptype>::base>(name,vtk_xml_prop<ptype>::n_comp,ft);
+		}
+	}
+};
+
+/*! \brief this class is a functor for "for_each" algorithm
+ *
+ * For each property it add the value of one grid point in the data arrays
+ *
+ * \tparam Grid type of grid
+ * \tparam key_type type of the grid key
+ *
+ */
+template<typename Grid, typename key_type>
+struct vtk_xml_grid_add_point
+{
+	//! arrays one for each property
+	openfpm::vector<vtk_xml_data_array> & arrs;
+
+	//! grid
+	const Grid & g;
+
+	//! point
+	const key_type & key;
+
+	/*! \brief constructor
+	 *
+	 * \param arrs data arrays
+	 * \param g grid
+	 * \param key point
+	 *
+	 */
+	vtk_xml_grid_add_point(openfpm::vector<vtk_xml_data_array> & arrs, const Grid & g, const key_type & key)
+	:arrs(arrs),g(g),key(key)
+	{}
+
+	//! It add the value of the property T
+	template<typename T> void operator()(T& t) const
+	{
+		typedef typename boost::mpl::at<typename Grid::value_type::type,boost::mpl::int_<T::value>>::type ptype;
+
+		vtk_xml_prop<ptype>::add(arrs.get(T::value),g.template get<T::value>(key));
+	}
+};
+
+/*! \brief Initialize one data array for each property to write
+ *
+ * \tparam prp property to write (-1 all)
+ * \tparam ele_g element that store the grid and its attributes
+ *
+ * \param arrs data arrays
+ * \param prop_names properties names
+ * \param postfix post-fix to add to the names
+ * \param ft file type
+ *
+ */
+template<int prp, typename ele_g>
+void vtk_xml_init_arrays(openfpm::vector<vtk_xml_data_array> & arrs,
+						 const openfpm::vector<std::string> & prop_names,
+						 const std::string & postfix,
+						 file_type ft)
+{
+	typedef typename ele_g::value_type::value_type aggr;
+
+	arrs.clear();
+	arrs.resize(aggr::max_prop);
+
+	vtk_xml_grid_init_arr<ele_g> ia(arrs,prop_names,postfix,ft);
+
+	if (prp == -1)
+	{boost::mpl::for_each< boost::mpl::range_c<int,0, aggr::max_prop> >(ia);}
+	else
+	{boost::mpl::for_each< boost::mpl::range_c<int,(prp < 0)?0:prp, (prp < 0)?0:prp+1> >(ia);}
+}
+
+/*! \brief Fill the data arrays with the properties of a region of a grid
+ *
+ * \tparam prp property to write (-1 all)
+ * \tparam ele_g element that store the grid and its attributes
+ *
+ * \param arrs data arrays
+ * \param g grid
+ * \param start first point of the region
+ * \param stop last point of the region
+ * \param prop_names properties names
+ * \param postfix post-fix to add to the names
+ * \param ft file type
+ *
+ */
+template<int prp, typename ele_g, typename Grid, typename key_type>
+void vtk_xml_grid_fill(openfpm::vector<vtk_xml_data_array> & arrs,
+					   const Grid & g,
+					   const key_type & start,
+					   const key_type & stop,
+					   const openfpm::vector<std::string> & prop_names,
+					   const std::string & postfix,
+					   file_type ft)
+{
+	vtk_xml_init_arrays<prp,ele_g>(arrs,prop_names,postfix,ft);
+
+	auto it = g.getSubIterator(start,stop);
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vtk_xml_grid_add_point<Grid,decltype(key)> ap(arrs,g,key);
+
+		if (prp == -1)
+		{boost::mpl::for_each< boost::mpl::range_c<int,0, Grid::value_type::max_prop> >(ap);}
+		else
+		{boost::mpl::for_each< boost::mpl::range_c<int,(prp < 0)?0:prp, (prp < 0)?0:prp+1> >(ap);}
+
+		++it;
+	}
+}
+
+/*! \brief Write all the initialized data arrays
+ *
+ * \param out stream where to write
+ * \param arrs data arrays
+ * \param indent indentation
+ * \param appended buffer of the AppendedData section
+ *
+ */
+inline void vtk_xml_write_arrays(std::ostream & out,
+								 const openfpm::vector<vtk_xml_data_array> & arrs,
+								 const std::string & indent,
+								 std::string & appended)
+{
+	for (size_t j = 0 ; j < arrs.size() ; j++)
+	{
+		if (arrs.get(j).valid() == true)
+		{arrs.get(j).write(out,indent,appended);}
+	}
+}
+
+/*! \brief Write the PDataArray entries of all the initialized data arrays
+ *
+ * \param out stream where to write
+ * \param arrs data arrays
+ * \param indent indentation
+ *
+ */
+inline void vtk_xml_write_parrays(std::ostream & out,
+								  const openfpm::vector<vtk_xml_data_array> & arrs,
+								  const std::string & indent)
+{
+	for (size_t j = 0 ; j < arrs.size() ; j++)
+	{
+		if (arrs.get(j).valid() == true)
+		{arrs.get(j).write_p(out,indent);}
+	}
+}
+
+/*! \brief Write the AppendedData section (if there are appended data)
+ *
+ * \param out stream where to write
+ * \param appended appended data
+ *
+ */
+inline void vtk_xml_write_appended(std::ostream & out, const std::string & appended)
+{
+	if (appended.size() == 0)
+	{return;}
+
+	out << "  <AppendedData encoding=\"raw\">\n   _";
+	out.write(appended.c_str(),appended.size());
+	out << "\n  </AppendedData>\n";
+}
+
+/*! \brief Convert an extent into the VTK format "x0 x1 y0 y1 z0 z1"
+ *
+ * \param ext extent
+ *
+ * \return the extent string
+ *
+ */
+inline std::string vtk_extent_string(const Box<3,long int> & ext)
+{
+	return std::to_string(ext.getLow(0)) + " " + std::to_string(ext.getHigh(0)) + " " +
+		   std::to_string(ext.getLow(1)) + " " + std::to_string(ext.getHigh(1)) + " " +
+		   std::to_string(ext.getLow(2)) + " " + std::to_string(ext.getHigh(2));
+}
+
+/*! \brief Bounding extent of a set of extents
+ *
+ * \param ext extents
+ *
+ * \return the bounding extent (0 -1 0 -1 0 -1 if there are no extents)
+ *
+ */
+inline Box<3,long int> vtk_whole_extent(const openfpm::vector<Box<3,long int>> & ext)
+{
+	Box<3,long int> wh;
+
+	for (size_t k = 0 ; k < 3 ; k++)
+	{
+		wh.setLow(k,0);
+		wh.setHigh(k,-1);
+	}
+
+	for (size_t i = 0 ; i < ext.size() ; i++)
+	{
+		for (size_t k = 0 ; k < 3 ; k++)
+		{
+			if (i == 0)
+			{
+				wh.setLow(k,ext.get(i).getLow(k));
+				wh.setHigh(k,ext.get(i).getHigh(k));
+			}
+			else
+			{
+				wh.setLow(k,std::min(wh.getLow(k),ext.get(i).getLow(k)));
+				wh.setHigh(k,std::max(wh.getHigh(k),ext.get(i).getHigh(k)));
+			}
+		}
+	}
+
+	return wh;
+}
+
+/*! \brief Write origin and spacing of an image as 3D attributes
+ *
+ * \param out stream where to write
+ * \param origin origin of the image
+ * \param spacing spacing of the image
+ *
+ */
+template<unsigned int dim, typename St>
+void vtk_image_geometry(std::ostream & out, const Point<dim,St> & origin, const Point<dim,St> & spacing)
+{
+	if (std::is_same<St,float>::value == true)
+	{out << std::setprecision(7);}
+	else
+	{out << std::setprecision(16);}
+
+	out << " Origin=\"";
+	for (size_t k = 0 ; k < 3 ; k++)
+	{out << ((k < dim)?origin.get(k):0) << ((k != 2)?" ":"");}
+
+	out << "\" Spacing=\"";
+	for (size_t k = 0 ; k < 3 ; k++)
+	{out << ((k < dim)?spacing.get(k):1) << ((k != 2)?" ":"");}
+
+	out << "\"";
+}
+
+/*! \brief Hash of a point on an integer lattice
+ *
+ * \tparam dim dimensionality
+ *
+ */
+template<unsigned int dim>
+struct vtk_lattice_hash
+{
+	/*! \brief Hash of the point
+	 *
+	 * \param p point
+	 *
+	 * \return the hash
+	 *
+	 */
+	size_t operator()(const std::array<long int,dim> & p) const
+	{
+		size_t h = 0;
+
+		for (size_t k = 0 ; k < dim ; k++)
+		{h = h * 0x9E3779B97F4A7C15ul + std::hash<long int>()(p[k]);}
+
+		return h;
+	}
+};
+
+/*! \brief Return the file name without the directory
+ *
+ * \param file file path
+ *
+ * \return the base name
+ *
+ */
+inline std::string vtk_xml_basename(const std::string & file)
+{
+	size_t pos = file.find_last_of('/');
+
+	if (pos == std::string::npos)
+	{return file;}
+
+	return file.substr(pos+1);
+}
+
+#endif /* OPENFPM_IO_SRC_VTKWRITER_VTKWRITER_XML_UTIL_HPP_ */
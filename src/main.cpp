@@ -30,6 +30,7 @@ int main(int argc, char* argv[])
 
 #include "CSVWriter/CSVWriter_unit_tests.hpp"
 #include "GraphMLWriter/GraphMLWriter_unit_tests.hpp"
+#include "GraphMLReader/GraphMLReader_unit_tests.hpp"
 #include "VTKWriter/VTKWriter_unit_tests.hpp"
 #include "Plot/Plot_unit_tests.hpp"
 #include "RawReader/RawReader_unit_tests.hpp"
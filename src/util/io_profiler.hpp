@@ -0,0 +1,632 @@
+/*
+ * io_profiler.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef OPENFPM_IO_SRC_UTIL_IO_PROFILER_HPP_
+#define OPENFPM_IO_SRC_UTIL_IO_PROFILER_HPP_
+
+#include "Vector/map_vector.hpp"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+
+#ifndef DISABLE_MPI_WRITTERS
+#include "VCluster/VCluster.hpp"
+#endif
+
+/*! \brief Time spent by this processor in a phase of the I/O
+ *
+ */
+struct io_event
+{
+	//! phase (hdf5_pack, hdf5_write, vtk_encode ...)
+	std::string phase;
+
+	//! start in seconds from the creation of the profiler
+	double start;
+
+	//! duration in seconds
+	double time;
+
+	//! bytes processed
+	size_t bytes;
+};
+
+/*! \brief Total time and bytes of a phase on this processor
+ *
+ */
+struct io_phase
+{
+	//! phase
+	std::string phase;
+
+	//! number of events
+	size_t count = 0;
+
+	//! time in seconds
+	double time = 0.0;
+
+	//! bytes processed
+	size_t bytes = 0;
+};
+
+/*! \brief Time and bytes of a phase across the processors
+ *
+ */
+struct io_phase_summary
+{
+	//! phase
+	std::string phase;
+
+	//! minimum, maximum and average time across the processors
+	double time_min;
+	double time_max;
+	double time_avg;
+
+	//! minimum, maximum and average bytes across the processors
+	double bytes_min;
+	double bytes_max;
+	double bytes_avg;
+};
+
+/*! \brief Profiler of the I/O, it record the time and the bytes of every phase of the writers and readers
+ *
+ * It is disabled by default, the writers record their phases only when it is enabled.
+ * The recording does not need MPI, the summary across the processors and the files
+ * are not available when DISABLE_MPI_WRITTERS is defined
+ *
+ * \code
+ *
+ * get_io_profiler().enable(true);
+ *
+ * HDF5_writer<VECTOR_DIST> h5;
+ * h5.save("checkpoint.h5",v_pos,v_prp);
+ *
+ * openfpm::vector<io_phase_summary> summary;
+ * get_io_profiler().getSummary(summary);
+ *
+ * get_io_profiler().writeChromeTrace("io_trace");
+ *
+ * \endcode
+ *
+ */
+class io_profiler
+{
+	//! true when the phases are recorded
+	bool enabled = false;
+
+	//! origin of the times
+	std::chrono::steady_clock::time_point t0;
+
+	//! recorded events
+	openfpm::vector<io_event> events;
+
+	/*! \brief Escape a string for JSON
+	 *
+	 * \param s string
+	 *
+	 * \return the escaped string
+	 *
+	 */
+	static std::string json_string(const std::string & s)
+	{
+		std::string out = "\"";
+
+		for (size_t i = 0 ; i < s.size() ; i++)
+		{
+			if (s[i] == '"' || s[i] == '\\')
+			{out += '\\';}
+
+			out += s[i];
+		}
+
+		return out + "\"";
+	}
+
+public:
+
+	//! Constructor
+	io_profiler()
+	:t0(std::chrono::steady_clock::now())
+	{}
+
+	/*! \brief Enable or disable the recording
+	 *
+	 * \param enabled true to record the phases
+	 *
+	 */
+	void enable(bool enabled)
+	{
+		this->enabled = enabled;
+	}
+
+	/*! \brief Return true if the phases are recorded
+	 *
+	 * \return true if enabled
+	 *
+	 */
+	bool isEnabled() const
+	{
+		return enabled;
+	}
+
+	//! Remove the recorded events
+	void clear()
+	{
+		events.clear();
+	}
+
+	/*! \brief Seconds from the creation of the profiler
+	 *
+	 * \return the time
+	 *
+	 */
+	double now() const
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	}
+
+	/*! \brief Record an event
+	 *
+	 * \param phase phase
+	 * \param start start of the event (now())
+	 * \param time duration in seconds
+	 * \param bytes bytes processed
+	 *
+	 */
+	void add(const std::string & phase, double start, double time, size_t bytes)
+	{
+		events.add();
+		events.last().phase = phase;
+		events.last().start = start;
+		events.last().time = time;
+		events.last().bytes = bytes;
+	}
+
+	/*! \brief Return the recorded events
+	 *
+	 * \return the events
+	 *
+	 */
+	const openfpm::vector<io_event> & getEvents() const
+	{
+		return events;
+	}
+
+	/*! \brief Total time and bytes of every phase on this processor
+	 *
+	 * \param phases phases in order of first appearance
+	 *
+	 */
+	void getPhases(openfpm::vector<io_phase> & phases) const
+	{
+		phases.clear();
+
+		for (size_t i = 0 ; i < events.size() ; i++)
+		{
+			size_t k = 0;
+			for ( ; k < phases.size() && phases.get(k).phase != events.get(i).phase ; k++) {}
+
+			if (k == phases.size())
+			{
+				phases.add();
+				phases.last().phase = events.get(i).phase;
+			}
+
+			phases.get(k).count++;
+			phases.get(k).time += events.get(i).time;
+			phases.get(k).bytes += events.get(i).bytes;
+		}
+	}
+
+#ifndef DISABLE_MPI_WRITTERS
+
+private:
+
+	/*! \brief File of this processor
+	 *
+	 * \param prefix prefix of the files
+	 * \param ext extension
+	 *
+	 * \return prefix_RANK.ext
+	 *
+	 */
+	static std::string rank_file(const std::string & prefix, const std::string & ext)
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+		return prefix + "_" + std::to_string(v_cl.getProcessUnitID()) + ext;
+	}
+
+	/*! \brief Fill the summary with the phases in a list of names separated by '\0'
+	 *
+	 * \param list names
+	 * \param summary phases without repetitions (the times are not set)
+	 *
+	 */
+	static void add_phases(const openfpm::vector<char> & list, openfpm::vector<io_phase_summary> & summary)
+	{
+		summary.clear();
+
+		std::string phase;
+
+		for (size_t i = 0 ; i < list.size() ; i++)
+		{
+			if (list.get(i) != '\0')
+			{
+				phase += list.get(i);
+				continue;
+			}
+
+			size_t k = 0;
+			for ( ; k < summary.size() && summary.get(k).phase != phase ; k++) {}
+
+			if (k == summary.size())
+			{
+				summary.add();
+				summary.last().phase = phase;
+			}
+
+			phase.clear();
+		}
+	}
+
+public:
+
+	/*! \brief Minimum, maximum and average time and bytes of every phase across the processors (collective)
+	 *
+	 * A processor that never entered a phase contribute zero time and bytes
+	 *
+	 * \param summary one entry for every phase recorded by at least one processor
+	 *
+	 */
+	void getSummary(openfpm::vector<io_phase_summary> & summary) const
+	{
+		Vcluster<> & v_cl = create_vcluster();
+		size_t n_proc = v_cl.getProcessingUnits();
+
+		openfpm::vector<io_phase> phases;
+		getPhases(phases);
+
+		// names of the phases of this processor separated by '\0'
+
+		openfpm::vector<char> names;
+
+		for (size_t i = 0 ; i < phases.size() ; i++)
+		{
+			for (size_t j = 0 ; j < phases.get(i).phase.size() ; j++)
+			{names.add(phases.get(i).phase[j]);}
+
+			names.add('\0');
+		}
+
+		// processor 0 merge the names of all the processors and send back the list
+
+		openfpm::vector<char> all;
+		v_cl.SGather(names,all,0);
+
+		openfpm::vector<char> list;
+
+		if (v_cl.getProcessUnitID() == 0)
+		{
+			add_phases(all,summary);
+
+			for (size_t k = 0 ; k < summary.size() ; k++)
+			{
+				for (size_t j = 0 ; j < summary.get(k).phase.size() ; j++)
+				{list.add(summary.get(k).phase[j]);}
+
+				list.add('\0');
+			}
+		}
+
+		size_t n_char = list.size();
+		v_cl.max(n_char);
+		v_cl.execute();
+
+		if (n_char != 0)
+		{
+			list.resize(n_char);
+			v_cl.Bcast(list,0);
+			v_cl.execute();
+		}
+
+		add_phases(list,summary);
+
+		// time and bytes of this processor for every phase
+
+		size_t n = summary.size();
+
+		openfpm::vector<double> val_min;
+		openfpm::vector<double> val_max;
+		openfpm::vector<double> val_sum;
+		val_min.resize(2*n);
+		val_max.resize(2*n);
+		val_sum.resize(2*n);
+
+		for (size_t k = 0 ; k < n ; k++)
+		{
+			val_min.get(2*k) = 0.0;
+			val_min.get(2*k+1) = 0.0;
+
+			for (size_t i = 0 ; i < phases.size() ; i++)
+			{
+				if (phases.get(i).phase == summary.get(k).phase)
+				{
+					val_min.get(2*k) = phases.get(i).time;
+					val_min.get(2*k+1) = phases.get(i).bytes;
+				}
+			}
+
+			val_max.get(2*k) = val_min.get(2*k);
+			val_max.get(2*k+1) = val_min.get(2*k+1);
+			val_sum.get(2*k) = val_min.get(2*k);
+			val_sum.get(2*k+1) = val_min.get(2*k+1);
+		}
+
+		for (size_t i = 0 ; i < 2*n ; i++)
+		{
+			v_cl.min(val_min.get(i));
+			v_cl.max(val_max.get(i));
+			v_cl.sum(val_sum.get(i));
+		}
+		v_cl.execute();
+
+		for (size_t k = 0 ; k < n ; k++)
+		{
+			summary.get(k).time_min = val_min.get(2*k);
+			summary.get(k).time_max = val_max.get(2*k);
+			summary.get(k).time_avg = val_sum.get(2*k) / n_proc;
+			summary.get(k).bytes_min = val_min.get(2*k+1);
+			summary.get(k).bytes_max = val_max.get(2*k+1);
+			summary.get(k).bytes_avg = val_sum.get(2*k+1) / n_proc;
+		}
+	}
+
+	/*! \brief Write the phases and the events of this processor in JSON (prefix_RANK.json)
+	 *
+	 * \param prefix prefix of the files
+	 *
+	 * \return true if the file has been written
+	 *
+	 */
+	bool writeJSON(const std::string & prefix) const
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+		std::ofstream ofs(rank_file(prefix,".json"));
+
+		if (ofs.is_open() == false)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error: cannot create the file " << rank_file(prefix,".json") << std::endl;
+			return false;
+		}
+
+		openfpm::vector<io_phase> phases;
+		getPhases(phases);
+
+		ofs << "{\n  \"rank\": " << v_cl.getProcessUnitID() << ",\n  \"phases\": [";
+
+		for (size_t i = 0 ; i < phases.size() ; i++)
+		{
+			ofs << ((i == 0)?"\n":",\n") << "    {\"phase\": " << json_string(phases.get(i).phase)
+			    << ", \"count\": " << phases.get(i).count
+			    << ", \"time\": " << std::to_string(phases.get(i).time)
+			    << ", \"bytes\": " << phases.get(i).bytes << "}";
+		}
+
+		ofs << "\n  ],\n  \"events\": [";
+
+		for (size_t i = 0 ; i < events.size() ; i++)
+		{
+			ofs << ((i == 0)?"\n":",\n") << "    {\"phase\": " << json_string(events.get(i).phase)
+			    << ", \"start\": " << std::to_string(events.get(i).start)
+			    << ", \"time\": " << std::to_string(events.get(i).time)
+			    << ", \"bytes\": " << events.get(i).bytes << "}";
+		}
+
+		ofs << "\n  ]\n}\n";
+
+		return true;
+	}
+
+	/*! \brief Write the events of this processor in the Chrome trace format (prefix_RANK.trace.json)
+	 *
+	 * Every processor is a process (pid) of the trace, the traces of the processors can be
+	 * loaded together in chrome://tracing or Perfetto
+	 *
+	 * \param prefix prefix of the files
+	 *
+	 * \return true if the file has been written
+	 *
+	 */
+	bool writeChromeTrace(const std::string & prefix) const
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+		std::ofstream ofs(rank_file(prefix,".trace.json"));
+
+		if (ofs.is_open() == false)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error: cannot create the file " << rank_file(prefix,".trace.json") << std::endl;
+			return false;
+		}
+
+		ofs << "{\"traceEvents\": [";
+
+		for (size_t i = 0 ; i < events.size() ; i++)
+		{
+			ofs << ((i == 0)?"\n":",\n") << "  {\"name\": " << json_string(events.get(i).phase)
+			    << ", \"cat\": \"io\", \"ph\": \"X\""
+			    << ", \"ts\": " << std::to_string(events.get(i).start * 1e6)
+			    << ", \"dur\": " << std::to_string(events.get(i).time * 1e6)
+			    << ", \"pid\": " << v_cl.getProcessUnitID() << ", \"tid\": 0"
+			    << ", \"args\": {\"bytes\": " << events.get(i).bytes << "}}";
+		}
+
+		ofs << "\n]}\n";
+
+		return true;
+	}
+
+#endif
+};
+
+/*! \brief Return the I/O profiler of this processor
+ *
+ * \return the profiler
+ *
+ */
+inline io_profiler & get_io_profiler()
+{
+	static io_profiler prof;
+
+	return prof;
+}
+
+/*! \brief Record a phase from the construction to stop() (or the destruction)
+ *
+ * When the profiler is disabled it does nothing
+ *
+ */
+class io_prof_scope
+{
+	//! phase
+	const char * phase;
+
+	//! start of the phase
+	double start = 0.0;
+
+	//! true until the phase is recorded
+	bool running;
+
+public:
+
+	/*! \brief Start the phase
+	 *
+	 * \param phase phase
+	 *
+	 */
+	io_prof_scope(const char * phase)
+	:phase(phase),running(get_io_profiler().isEnabled())
+	{
+		if (running == true)
+		{start = get_io_profiler().now();}
+	}
+
+	/*! \brief Stop the phase and record it
+	 *
+	 * \param bytes bytes processed in the phase
+	 *
+	 */
+	void stop(size_t bytes = 0)
+	{
+		if (running == false)
+		{return;}
+
+		io_profiler & prof = get_io_profiler();
+		prof.add(phase,start,prof.now() - start,bytes);
+
+		running = false;
+	}
+
+	//! Destructor, it record the phase if not stopped
+	~io_prof_scope()
+	{
+		stop();
+	}
+};
+
+/*! \brief Close a file written directly in the stream, recording the encoding and the flush
+ *
+ * The bytes of both phases are the size of the file (0 if the stream failed)
+ *
+ * \param ofs file
+ * \param p_encode encoding phase, started before writing the file
+ * \param flush phase of the close
+ *
+ * \return true if the file has been written without errors
+ *
+ */
+inline bool io_prof_close(std::ofstream & ofs, io_prof_scope & p_encode, const char * flush)
+{
+	// tellp return -1 if the stream failed
+
+	std::streamoff pos = (ofs.fail() == true)?-1:(std::streamoff)ofs.tellp();
+	size_t bytes = (pos < 0)?0:pos;
+
+	p_encode.stop(bytes);
+
+	io_prof_scope p_flush(flush);
+
+	ofs.close();
+
+	p_flush.stop(bytes);
+
+	return ofs.fail() == false;
+}
+
+/*! \brief Write some strings in a file, recording the encoding and the flush
+ *
+ * \code
+ *
+ * io_prof_scope p_encode("vtk_encode");
+ *
+ * std::string header = ...;
+ * std::string data = ...;
+ *
+ * return io_prof_write_file(file,p_encode,"vtk_flush",{header,data});
+ *
+ * \endcode
+ *
+ * \param file file to create
+ * \param p_encode encoding phase, started before producing the strings
+ * \param flush phase of the write
+ * \param parts strings to write in order
+ *
+ * \return true if the file has been written
+ *
+ */
+inline bool io_prof_write_file(const std::string & file, io_prof_scope & p_encode, const char * flush,
+		                       std::initializer_list<std::reference_wrapper<const std::string>> parts)
+{
+	size_t bytes = 0;
+
+	for (const std::string & s : parts)
+	{bytes += s.size();}
+
+	p_encode.stop(bytes);
+
+	io_prof_scope p_flush(flush);
+
+	std::ofstream ofs(file);
+
+	if (ofs.is_open() == false)
+	{
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error: cannot create the file " << file << std::endl;
+		return false;
+	}
+
+	for (const std::string & s : parts)
+	{ofs << s;}
+
+	ofs.close();
+
+	p_flush.stop(bytes);
+
+	if (ofs.fail() == true)
+	{
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error: cannot write the file " << file << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+#endif /* OPENFPM_IO_SRC_UTIL_IO_PROFILER_HPP_ */